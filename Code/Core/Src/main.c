@@ -52,6 +52,7 @@
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 /* USER CODE BEGIN PFP */
+void stack_paint(void); //defined in app_hal_stack_monitor.cpp
 
 /* USER CODE END PFP */
 
@@ -67,6 +68,7 @@ void SystemClock_Config(void);
 int main(void)
 {
   /* USER CODE BEGIN 1 */
+  stack_paint();
 
   /* USER CODE END 1 */
 
@@ -46,6 +46,8 @@
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN PFP */
+void timestamp_keepalive(void); //defined in app_hal_timestamp.cpp
+void deferred_work_handler(void); //defined in app_hal_deferred.cpp
 
 /* USER CODE END PFP */
 
@@ -170,6 +172,7 @@ void DebugMon_Handler(void)
 void PendSV_Handler(void)
 {
   /* USER CODE BEGIN PendSV_IRQn 0 */
+  deferred_work_handler();
 
   /* USER CODE END PendSV_IRQn 0 */
   /* USER CODE BEGIN PendSV_IRQn 1 */
@@ -187,6 +190,7 @@ void SysTick_Handler(void)
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
+  timestamp_keepalive();
 
   /* USER CODE END SysTick_IRQn 1 */
 }
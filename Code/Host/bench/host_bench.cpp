@@ -0,0 +1,198 @@
+/*
+ * host_bench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  The firmware's benchmark table (`Benchmark::get_benchmarks()`) timed on the host, against the simulated chip
+ *  Same shape as the on-target run--untimed setup, then one timed operation, with the cost of timing nothing taken out--
+ *  except the clock is the host's, so the numbers are ns of host time, sim overhead included (every PRIMASK change and
+ *  LDREX goes through the sim). They're for catching regressions in the host build against bench/baseline.json,
+ *  not for reading off target costs--that's what the DWT numbers from `Benchmark::run_all()` are for
+ *  Operations without a setup are timed in batches, since a single one is about as long as reading the clock
+ *
+ *  A few more run only here, since they need more memory (or more freedom with the app's state) than the target has:
+ *   - Soft_Timer expiry: `tick()` expiring a single one-shot
+ *   - Soft_Timer `tick()` with 10, 1k and 10k periodic timers armed, periods spread over 0.1-10s of 1kHz ticks;
+ *     it's timed in batches of ticks like anything else without a setup, so the cascades and expiries get averaged in
+ *   - Soft_Timer arm/cancel with those 10k timers in the wheel, to compare against the firmware's empty-wheel numbers
+ *
+ *  Output is one JSON object, same layout as the firmware's but in ns:
+ *  {"clock":"host","benchmarks":[{"name":"dio_set","iterations":..,"ns_min":..,"ns_mean":..}, ...]}
+ *
+ *  usage: host_bench [out.json] [iterations]
+ *  `cmake --build <dir> --target bench` runs it and compares against the baseline (tools/bench_compare.py),
+ *  `--target bench_baseline` overwrites the baseline with a fresh run
+ */
+
+#include "sim.h"
+#include "benchmark.h"
+#include "app_hal_dio.h"
+#include "app_hal_timing.h"
+#include "app_hal_timestamp.h"
+#include "app_hal_deferred.h"
+#include "app_hal_pwm.h"
+#include "soft_timer.h"
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HOST_BENCH_ITERATIONS 1024
+#define HOST_BENCH_BATCH 64
+#define HOST_BENCH_PWM_FREQ 1000.0f
+#define HOST_BENCH_MAX_TIMERS 10000
+#define HOST_BENCH_MIN_PERIOD 100 //wheel ticks
+#define HOST_BENCH_PERIOD_SPREAD 9901 //prime, so the periods don't line up with the wheel's slots
+#define HOST_BENCH_ARM_DELAY 1000
+
+typedef std::chrono::steady_clock bench_clock_t;
+
+typedef struct {
+	double ns_min;
+	double ns_mean;
+} host_result_t;
+
+//host-only benchmarks: `prepare()` runs once before the benchmark and `finish()` once after, both untimed
+typedef struct {
+	benchmark_t bench;
+	callback_function_t prepare;
+	callback_function_t finish;
+} host_benchmark_t;
+
+static void bench_empty() {}
+static Timer bench_timer(CHANNEL_0); //so the timer dispatch benchmark runs a callback, like it does on the target
+
+//================================ SOFT TIMER WHEEL ===============================
+static Soft_Timer *wheel_timers[HOST_BENCH_MAX_TIMERS];
+static Soft_Timer bench_soft_timer(bench_empty);
+
+static void load_wheel(const uint32_t count) {
+	for(uint32_t i = 0; i < count; i++) {
+		if(wheel_timers[i] == NULL) wheel_timers[i] = new Soft_Timer(bench_empty);
+		wheel_timers[i]->arm_periodic(HOST_BENCH_MIN_PERIOD + (i * 7919) % HOST_BENCH_PERIOD_SPREAD);
+	}
+}
+static void load_wheel_10() { load_wheel(10); }
+static void load_wheel_1k() { load_wheel(1000); }
+static void load_wheel_10k() { load_wheel(10000); }
+static void empty_wheel() {
+	for(Soft_Timer *timer : wheel_timers)
+		if(timer != NULL) timer->cancel();
+	bench_soft_timer.cancel();
+}
+
+static void bench_tick() { Soft_Timer::tick(); }
+static void bench_expire_next() { bench_soft_timer.arm_oneshot(1); }
+static void bench_soft_timer_arm() { bench_soft_timer.arm_oneshot(HOST_BENCH_ARM_DELAY); }
+static void bench_soft_timer_cancel() { bench_soft_timer.cancel(); }
+
+static const host_benchmark_t host_benchmarks[] = {
+		{{"soft_timer_expire", bench_tick, bench_expire_next}, NULL, empty_wheel},
+		{{"soft_timer_tick_10", bench_tick, NULL}, load_wheel_10, empty_wheel},
+		{{"soft_timer_tick_1k", bench_tick, NULL}, load_wheel_1k, empty_wheel},
+		{{"soft_timer_tick_10k", bench_tick, NULL}, load_wheel_10k, empty_wheel},
+		{{"soft_timer_arm_10k", bench_soft_timer_arm, bench_soft_timer_cancel}, load_wheel_10k, empty_wheel},
+		{{"soft_timer_cancel_10k", bench_soft_timer_cancel, bench_soft_timer_arm}, load_wheel_10k, empty_wheel}
+};
+#define NUM_HOST_BENCHMARKS (sizeof(host_benchmarks) / sizeof(host_benchmarks[0]))
+
+//=============================== BENCHMARK RUNNER ================================
+
+//the sim doesn't model EGR (see sim.h), so raise the flags the setup asked for the way the hardware would
+static void generate_events() {
+	TIM_TypeDef *timers[] = {TIM2, TIM3, TIM5, TIM9, TIM11, TIM13, TIM14};
+	for(TIM_TypeDef *tim : timers) {
+		tim->SR |= tim->EGR & (TIM_EGR_UG | TIM_EGR_CC1G | TIM_EGR_CC2G | TIM_EGR_CC3G | TIM_EGR_CC4G);
+		tim->EGR = 0;
+	}
+	Sim::sync();
+}
+
+static double elapsed_ns(const bench_clock_t::time_point start, const bench_clock_t::time_point end) {
+	return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+static host_result_t run(const callback_function_t op, const callback_function_t setup, const uint32_t iterations) {
+	host_result_t result = {1e30, 0};
+	for(uint32_t i = 0; i < iterations; i++) {
+		double ns;
+		if(setup != NULL) {
+			setup();
+			generate_events();
+			bench_clock_t::time_point start = bench_clock_t::now();
+			op();
+			ns = elapsed_ns(start, bench_clock_t::now());
+		}
+		else {
+			bench_clock_t::time_point start = bench_clock_t::now();
+			for(uint32_t j = 0; j < HOST_BENCH_BATCH; j++) op();
+			ns = elapsed_ns(start, bench_clock_t::now()) / HOST_BENCH_BATCH;
+		}
+		if(ns < result.ns_min) result.ns_min = ns;
+		result.ns_mean += ns / iterations;
+	}
+	return result;
+}
+
+static void init_chip() {
+	Sim::reset();
+	DIO::init();
+	Timestamp::init();
+	Deferred_Work::init();
+	Hard_PWM::configure(HOST_BENCH_PWM_FREQ, Priorities::LOW);
+	bench_timer.init();
+	bench_timer.set_callback_func(bench_empty);
+}
+
+int main(int argc, char **argv) {
+	const char *out_path = (argc > 1) ? argv[1] : NULL;
+	uint32_t iterations = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : HOST_BENCH_ITERATIONS;
+	if(iterations == 0) iterations = 1;
+
+	init_chip();
+	__disable_irq(); //same as on the target, nothing else runs in the middle of an operation
+
+	//the cost of timing nothing, one of each way of timing
+	host_result_t overhead_single = run(bench_empty, bench_empty, iterations);
+	host_result_t overhead_batch = run(bench_empty, NULL, iterations);
+
+	//the firmware's table, then the host-only one
+	std::vector<host_benchmark_t> all;
+	uint32_t count;
+	const benchmark_t *benchmarks = Benchmark::get_benchmarks(&count);
+	for(uint32_t i = 0; i < count; i++) all.push_back({benchmarks[i], NULL, NULL});
+	for(uint32_t i = 0; i < NUM_HOST_BENCHMARKS; i++) all.push_back(host_benchmarks[i]);
+
+	std::string json = "{\"clock\":\"host\",\"benchmarks\":[";
+	for(uint32_t i = 0; i < all.size(); i++) {
+		const benchmark_t &bench = all[i].bench;
+		if(all[i].prepare != NULL) all[i].prepare();
+		host_result_t result = run(bench.op, bench.setup, iterations);
+		Benchmark::drop_hard_pwm_edges();
+		if(all[i].finish != NULL) all[i].finish();
+
+		const host_result_t &overhead = bench.setup ? overhead_single : overhead_batch;
+		double min = (result.ns_min > overhead.ns_min) ? result.ns_min - overhead.ns_min : 0;
+		double mean = (result.ns_mean > overhead.ns_mean) ? result.ns_mean - overhead.ns_mean : 0;
+
+		char line[192];
+		snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"iterations\":%lu,\"ns_min\":%.3f,\"ns_mean\":%.3f}",
+				(i == 0) ? "" : ",", bench.name, (unsigned long)iterations, min, mean);
+		json += line;
+	}
+	json += "]}\n";
+
+	__enable_irq();
+	fputs(json.c_str(), stdout);
+	if(out_path != NULL) {
+		FILE *out = fopen(out_path, "w");
+		if(out == NULL) {
+			perror(out_path);
+			return 1;
+		}
+		fputs(json.c_str(), out);
+		fclose(out);
+	}
+	return 0;
+}
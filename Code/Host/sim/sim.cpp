@@ -0,0 +1,746 @@
+/*
+ * sim.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "sim.h"
+#include <sys/mman.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//========================= SIMULATED MEMORY MAP ============================
+#define SIM_SRAM_BASE		0x20000000UL
+#define SIM_SRAM_SIZE		0x20000UL //128kB, same as the F446
+#define SIM_PERIPH_BASE		PERIPH_BASE
+#define SIM_PERIPH_SIZE		0x80000UL //APB1, APB2 and AHB1 (GPIO, RCC)
+#define SIM_CORE_BASE		0xE0000000UL
+#define SIM_CORE_SIZE		0x100000UL //DWT, SCS (NVIC, SCB, SysTick), CoreDebug
+
+#define SIM_RESET_MSP		(SIM_SRAM_BASE + SIM_SRAM_SIZE)
+#define SIM_NUM_IRQS		((uint32_t)FMPI2C1_ER_IRQn + 1)
+#define SIM_NUM_IRQ_WORDS	((SIM_NUM_IRQS + 31) / 32)
+#define SIM_NUM_PORTS		8
+#define SIM_PORT_SPACING	0x400
+#define SIM_CYCLES_PER_TICK	(SIM_CPU_F_CLK / 1000) //SysTick at 1kHz
+#define SIM_WFI_TIMEOUT		SIM_CPU_F_CLK //nothing wakes us for a whole second, give up
+#define SIM_NO_EVENT		0xFFFFFFFFFFFFFFFFULL
+
+#define EXC_PENDSV			14
+#define EXC_SYSTICK			15
+#define EXC_IRQ_OFFSET		16
+#define EXC_THREAD_PRIORITY	0x100 //lower than anything the NVIC can be set to
+#define TIM_IRQ_FLAGS		(TIM_SR_UIF | TIM_SR_CC1IF | TIM_SR_CC2IF | TIM_SR_CC3IF | TIM_SR_CC4IF)
+
+//the timers the app uses, and the IRQs they pend
+typedef struct {
+	uintptr_t base;
+	IRQn_Type irq;
+} sim_timer_map_t;
+
+static const sim_timer_map_t timer_map[] = {
+		{TIM2_BASE, TIM2_IRQn},
+		{TIM3_BASE, TIM3_IRQn},
+		{TIM5_BASE, TIM5_IRQn},
+		{TIM9_BASE, TIM1_BRK_TIM9_IRQn},
+		{TIM11_BASE, TIM1_TRG_COM_TIM11_IRQn},
+		{TIM13_BASE, TIM8_UP_TIM13_IRQn},
+		{TIM14_BASE, TIM8_TRG_COM_TIM14_IRQn}
+};
+#define SIM_NUM_TIMERS (sizeof(timer_map) / sizeof(timer_map[0]))
+
+//the real handlers, wherever the test links them in
+extern "C" {
+	void TIM2_IRQHandler(void) __attribute__((weak));
+	void TIM3_IRQHandler(void) __attribute__((weak));
+	void TIM1_BRK_TIM9_IRQHandler(void) __attribute__((weak));
+	void TIM1_TRG_COM_TIM11_IRQHandler(void) __attribute__((weak));
+	void TIM8_TRG_COM_TIM14_IRQHandler(void) __attribute__((weak));
+	void TIM8_UP_TIM13_IRQHandler(void) __attribute__((weak));
+	void EXTI0_IRQHandler(void) __attribute__((weak));
+	void EXTI1_IRQHandler(void) __attribute__((weak));
+	void EXTI2_IRQHandler(void) __attribute__((weak));
+	void EXTI3_IRQHandler(void) __attribute__((weak));
+	void EXTI4_IRQHandler(void) __attribute__((weak));
+	void EXTI9_5_IRQHandler(void) __attribute__((weak));
+	void EXTI15_10_IRQHandler(void) __attribute__((weak));
+	void deferred_work_handler(void) __attribute__((weak));
+	void timestamp_keepalive(void) __attribute__((weak));
+}
+
+//=========================== SIMULATOR STATE ==========================
+//core
+static uint64_t now = 0; //cycles since reset
+static uint64_t next_systick = SIM_CYCLES_PER_TICK;
+static uint32_t tick = 0; //HAL_GetTick()
+static uint32_t primask = 0;
+static uint32_t msp = SIM_RESET_MSP;
+static volatile void *monitor_addr = NULL; //exclusive monitor, NULL when open
+static callback_function_t ldrex_isr = NULL;
+static uint32_t ldrex_skip = 0;
+
+//NVIC
+static uint32_t irq_enabled[SIM_NUM_IRQ_WORDS]; //same layout as ISER/ISPR
+static uint32_t irq_pending[SIM_NUM_IRQ_WORDS];
+static bool pendsv_pending = false;
+static bool systick_pending = false;
+static uint32_t active_exc[EXC_THREAD_PRIORITY]; //exception numbers of the nested handlers, innermost last
+static uint32_t active_prio[EXC_THREAD_PRIORITY];
+static uint32_t depth = 0;
+static uint32_t max_depth = 0;
+static uint64_t exceptions_taken = 0;
+
+//peripherals
+static uint32_t prescaler_count[SIM_NUM_TIMERS];
+static uint32_t ccr_shadow[SIM_NUM_TIMERS][4];
+static uint32_t exti_latched = 0;
+static uint32_t exti_published = 0; //what we last put in EXTI->PR
+static uint32_t input_level[SIM_NUM_PORTS];
+static uint32_t input_driven[SIM_NUM_PORTS];
+static uint32_t last_odr[SIM_NUM_PORTS];
+static std::vector<sim_edge_t> edges;
+static std::string uart;
+static uint32_t uart_count = 0;
+
+static void dispatch();
+
+static void reset_chip();
+
+//============================== MEMORY MAP ==============================
+static void map_region(uintptr_t base, size_t size) {
+	void *mem = mmap((void*)base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+	if(mem != (void*)base) {
+		fprintf(stderr, "sim: couldn't map 0x%08lx (link the host build with -no-pie)\n", (unsigned long)base);
+		abort();
+	}
+}
+
+//before any of the app's static constructors get a chance to touch a register
+__attribute__((constructor(101))) static void map_memory() {
+	map_region(SIM_SRAM_BASE, SIM_SRAM_SIZE);
+	map_region(SIM_PERIPH_BASE, SIM_PERIPH_SIZE);
+	map_region(SIM_CORE_BASE, SIM_CORE_SIZE);
+	reset_chip();
+}
+
+//============================== HELPERS ==============================
+static inline TIM_TypeDef *timer_regs(uint32_t i) {
+	return (TIM_TypeDef*)timer_map[i].base;
+}
+
+static inline GPIO_TypeDef *port_regs(uint32_t port) {
+	return (GPIO_TypeDef*)(GPIOA_BASE + port * SIM_PORT_SPACING);
+}
+
+static inline uint32_t port_index(gpio_port_t port) {
+	return (uint32_t)port / SIM_PORT_SPACING;
+}
+
+static uint32_t exception_priority(uint32_t exc) {
+	if(exc == EXC_PENDSV) return SCB->SHP[10] >> (8 - __NVIC_PRIO_BITS);
+	if(exc == EXC_SYSTICK) return SCB->SHP[11] >> (8 - __NVIC_PRIO_BITS);
+	return NVIC->IP[exc - EXC_IRQ_OFFSET] >> (8 - __NVIC_PRIO_BITS);
+}
+
+static IRQn_Type exti_irq(uint32_t line) {
+	switch(line) {
+		case 0: return EXTI0_IRQn;
+		case 1: return EXTI1_IRQn;
+		case 2: return EXTI2_IRQn;
+		case 3: return EXTI3_IRQn;
+		case 4: return EXTI4_IRQn;
+		default: break;
+	}
+	return (line <= 9) ? EXTI9_5_IRQn : EXTI15_10_IRQn;
+}
+
+//which EXTI lines a handler acknowledges
+static uint32_t exti_lines_of(IRQn_Type irq) {
+	switch(irq) {
+		case EXTI0_IRQn: return 1UL << 0;
+		case EXTI1_IRQn: return 1UL << 1;
+		case EXTI2_IRQn: return 1UL << 2;
+		case EXTI3_IRQn: return 1UL << 3;
+		case EXTI4_IRQn: return 1UL << 4;
+		case EXTI9_5_IRQn: return 0x03E0UL;
+		case EXTI15_10_IRQn: return 0xFC00UL;
+		default: return 0;
+	}
+}
+
+static callback_function_t irq_handler(IRQn_Type irq) {
+	switch(irq) {
+		case TIM2_IRQn: return TIM2_IRQHandler;
+		case TIM3_IRQn: return TIM3_IRQHandler;
+		case TIM1_BRK_TIM9_IRQn: return TIM1_BRK_TIM9_IRQHandler;
+		case TIM1_TRG_COM_TIM11_IRQn: return TIM1_TRG_COM_TIM11_IRQHandler;
+		case TIM8_TRG_COM_TIM14_IRQn: return TIM8_TRG_COM_TIM14_IRQHandler;
+		case TIM8_UP_TIM13_IRQn: return TIM8_UP_TIM13_IRQHandler;
+		case EXTI0_IRQn: return EXTI0_IRQHandler;
+		case EXTI1_IRQn: return EXTI1_IRQHandler;
+		case EXTI2_IRQn: return EXTI2_IRQHandler;
+		case EXTI3_IRQn: return EXTI3_IRQHandler;
+		case EXTI4_IRQn: return EXTI4_IRQHandler;
+		case EXTI9_5_IRQn: return EXTI9_5_IRQHandler;
+		case EXTI15_10_IRQn: return EXTI15_10_IRQHandler;
+		default: return NULL;
+	}
+}
+
+static inline void set_bit_array(volatile uint32_t *regs, uint32_t irq, bool value) {
+	if(value) regs[irq >> 5] |= 1UL << (irq & 0x1F);
+	else regs[irq >> 5] &= ~(1UL << (irq & 0x1F));
+}
+
+static inline bool get_bit_array(const uint32_t *regs, uint32_t irq) {
+	return (regs[irq >> 5] >> (irq & 0x1F)) & 1;
+}
+
+//gather every other bit (the low bit of each 2-bit MODER/PUPDR field) into a 16-bit pin mask
+static inline uint32_t compress_fields(uint32_t x) {
+	x &= 0x55555555UL;
+	x = (x | (x >> 1)) & 0x33333333UL;
+	x = (x | (x >> 2)) & 0x0F0F0F0FUL;
+	x = (x | (x >> 4)) & 0x00FF00FFUL;
+	return (x | (x >> 8)) & 0x0000FFFFUL;
+}
+
+//============================== GPIO ==============================
+//latch whatever got written to BSRR into ODR, then work out what every pin reads back as
+static void sync_gpio() {
+	for(uint32_t p = 0; p < SIM_NUM_PORTS; p++) {
+		GPIO_TypeDef *port = port_regs(p);
+
+		uint32_t bsrr = port->BSRR;
+		if(bsrr) {
+			port->BSRR = 0;
+			port->ODR = (port->ODR & ~(bsrr >> 16)) | (bsrr & 0xFFFF); //set wins if both halves are written
+		}
+
+		uint32_t moder = port->MODER, pupdr = port->PUPDR;
+		uint32_t mode_lo = compress_fields(moder), mode_hi = compress_fields(moder >> 1);
+		uint32_t output_mask = mode_lo & ~mode_hi; //01
+		uint32_t input_mask = ~mode_lo & ~mode_hi & 0xFFFF; //00
+		uint32_t pull_up = compress_fields(pupdr) & ~compress_fields(pupdr >> 1); //01
+
+		//log level changes on output pins
+		uint32_t odr = port->ODR & 0xFFFF;
+		uint32_t changed = (odr ^ last_odr[p]) & output_mask;
+		last_odr[p] = odr;
+		for(uint32_t pin = 0; changed; pin++, changed >>= 1) {
+			if(!(changed & 1)) continue;
+			sim_edge_t edge = {now, (gpio_port_t)(p * SIM_PORT_SPACING), pin, ((odr >> pin) & 1) != 0};
+			edges.push_back(edge);
+		}
+
+		//undriven inputs float to their pull
+		uint32_t inputs = (input_level[p] & input_driven[p]) | (pull_up & ~input_driven[p]);
+		port->IDR = (odr & output_mask) | (inputs & input_mask);
+	}
+}
+
+//============================== TIMERS ==============================
+static inline uint32_t effective_ccr(uint32_t i, uint32_t chan) {
+	TIM_TypeDef *tim = timer_regs(i);
+	volatile uint32_t *ccmr = (chan < 2) ? &tim->CCMR1 : &tim->CCMR2;
+	bool preload = (*ccmr >> ((chan % 2) * 8)) & TIM_CCMR1_OC1PE;
+	return preload ? ccr_shadow[i][chan] : (&tim->CCR1)[chan];
+}
+
+//counter steps until the next rollover or compare match
+static uint64_t steps_to_event(uint32_t i) {
+	TIM_TypeDef *tim = timer_regs(i);
+	uint32_t cnt = tim->CNT, arr = tim->ARR;
+	uint64_t next = (cnt <= arr) ? (uint64_t)arr - cnt + 1 : 0x100000000ULL - cnt; //past ARR we run up to the counter limit
+	for(uint32_t chan = 0; chan < 4; chan++) {
+		uint32_t ccr = effective_ccr(i, chan);
+		if(ccr > cnt && ccr <= arr && (ccr - cnt) < next) next = ccr - cnt;
+	}
+	return next;
+}
+
+static void tick_timer(uint32_t i, uint64_t timer_clocks) {
+	TIM_TypeDef *tim = timer_regs(i);
+	if(!(tim->CR1 & TIM_CR1_CEN)) return;
+
+	uint64_t divider = (uint64_t)tim->PSC + 1;
+	uint64_t total = prescaler_count[i] + timer_clocks;
+	uint64_t steps = total / divider;
+	prescaler_count[i] = (uint32_t)(total % divider);
+
+	while(steps) {
+		uint64_t next = steps_to_event(i);
+		uint32_t cnt = tim->CNT;
+		if(steps < next) {
+			tim->CNT = (uint32_t)(cnt + steps);
+			return;
+		}
+		steps -= next;
+
+		if(cnt + next > tim->ARR) {
+			//rollover--update event, reload the compare shadows
+			tim->CNT = 0;
+			tim->SR |= TIM_SR_UIF;
+			for(uint32_t chan = 0; chan < 4; chan++)
+				ccr_shadow[i][chan] = (&tim->CCR1)[chan];
+		}
+		else tim->CNT = (uint32_t)(cnt + next);
+
+		for(uint32_t chan = 0; chan < 4; chan++)
+			if(effective_ccr(i, chan) == tim->CNT) tim->SR |= (TIM_SR_CC1IF << chan);
+	}
+}
+
+//timer clocks run at half the core clock
+static uint64_t cycles_for_timer_clocks(uint64_t clocks) {
+	return 2 * (now / 2 + clocks) - now;
+}
+
+static uint64_t cycles_to_next_event() {
+	uint64_t next = next_systick - now;
+	for(uint32_t i = 0; i < SIM_NUM_TIMERS; i++) {
+		TIM_TypeDef *tim = timer_regs(i);
+		if(!(tim->CR1 & TIM_CR1_CEN) || !(tim->DIER & TIM_IRQ_FLAGS)) continue; //nothing to interrupt us with
+		uint64_t divider = (uint64_t)tim->PSC + 1;
+		uint64_t clocks = (steps_to_event(i) - 1) * divider + (divider - prescaler_count[i]);
+		uint64_t cycles = cycles_for_timer_clocks(clocks);
+		if(cycles < next) next = cycles;
+	}
+	return next;
+}
+
+static void advance_raw(uint64_t cycles) {
+	uint64_t timer_clocks = (now + cycles) / 2 - now / 2;
+	now += cycles;
+
+	if((CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk) && (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+		DWT->CYCCNT += (uint32_t)cycles;
+
+	for(uint32_t i = 0; i < SIM_NUM_TIMERS; i++)
+		tick_timer(i, timer_clocks);
+
+	while(now >= next_systick) {
+		systick_pending = true;
+		next_systick += SIM_CYCLES_PER_TICK;
+	}
+}
+
+//============================== NVIC ==============================
+//level-triggered sources pend their IRQ for as long as they're asserted
+static void update_sources() {
+	for(uint32_t i = 0; i < SIM_NUM_TIMERS; i++) {
+		TIM_TypeDef *tim = timer_regs(i);
+		if(tim->SR & tim->DIER & TIM_IRQ_FLAGS) set_bit_array(irq_pending, timer_map[i].irq, true);
+	}
+
+	//EXTI->PR is write-one-to-clear, which memory can't do; we own the real latch and just show it to the app
+	//if the app wrote something other than what we showed it, that's lines being cleared
+	//(a write of exactly what's pending can't be told apart from no write--handlers get covered by the ack on exit)
+	if(EXTI->PR != exti_published) exti_latched &= ~EXTI->PR;
+	EXTI->PR = exti_latched;
+	exti_published = exti_latched;
+	uint32_t lines = exti_latched & EXTI->IMR;
+	for(uint32_t line = 0; lines; line++, lines >>= 1)
+		if(lines & 1) set_bit_array(irq_pending, exti_irq(line), true);
+
+	//PendSV gets set by a write to ICSR
+	if(SCB->ICSR & SCB_ICSR_PENDSVSET_Msk) {
+		SCB->ICSR &= ~SCB_ICSR_PENDSVSET_Msk;
+		pendsv_pending = true;
+	}
+
+	for(uint32_t word = 0; word < SIM_NUM_IRQ_WORDS; word++)
+		NVIC->ISPR[word] = irq_pending[word];
+}
+
+static bool any_pending() {
+	if(pendsv_pending || systick_pending) return true;
+	for(uint32_t word = 0; word < SIM_NUM_IRQ_WORDS; word++)
+		if(irq_enabled[word] & irq_pending[word]) return true;
+	return false;
+}
+
+static void run_exception(uint32_t exc) {
+	uint32_t prio = exception_priority(exc);
+	if(exc == EXC_PENDSV) {
+		pendsv_pending = false;
+		SCB->SHCSR |= SCB_SHCSR_PENDSVACT_Msk;
+	}
+	else if(exc == EXC_SYSTICK) {
+		systick_pending = false;
+		SCB->SHCSR |= SCB_SHCSR_SYSTICKACT_Msk;
+	}
+	else {
+		set_bit_array(irq_pending, exc - EXC_IRQ_OFFSET, false);
+		set_bit_array(NVIC->ISPR, exc - EXC_IRQ_OFFSET, false);
+		set_bit_array(NVIC->IABR, exc - EXC_IRQ_OFFSET, true);
+	}
+
+	active_exc[depth] = exc;
+	active_prio[depth] = prio;
+	depth++;
+	if(depth > max_depth) max_depth = depth;
+	exceptions_taken++;
+	monitor_addr = NULL; //exception entry clears the exclusive monitor
+
+	if(exc == EXC_PENDSV) {
+		if(deferred_work_handler) deferred_work_handler();
+	}
+	else if(exc == EXC_SYSTICK) {
+		tick++;
+		if(timestamp_keepalive) timestamp_keepalive();
+	}
+	else {
+		//the EXTI handlers ack every unmasked line they service as the first thing they do
+		//PR keeps showing those lines until the next sync so the handler still sees them, but edges from here on latch again
+		exti_latched &= ~(exti_lines_of((IRQn_Type)(exc - EXC_IRQ_OFFSET)) & EXTI->IMR);
+		callback_function_t handler = irq_handler((IRQn_Type)(exc - EXC_IRQ_OFFSET));
+		if(handler) handler();
+	}
+
+	sync_gpio();
+	depth--;
+	monitor_addr = NULL; //and so does exception return
+	if(exc == EXC_PENDSV) SCB->SHCSR &= ~SCB_SHCSR_PENDSVACT_Msk;
+	else if(exc == EXC_SYSTICK) SCB->SHCSR &= ~SCB_SHCSR_SYSTICKACT_Msk;
+	else set_bit_array(NVIC->IABR, exc - EXC_IRQ_OFFSET, false);
+}
+
+//take every pending exception that's allowed to preempt whatever is running now
+static void dispatch() {
+	while(true) {
+		sync_gpio();
+		update_sources();
+		if(primask) return;
+
+		//lower priority number wins, then lower exception number
+		uint32_t running = depth ? active_prio[depth - 1] : EXC_THREAD_PRIORITY;
+		uint32_t best_exc = 0, best_prio = running;
+		if(pendsv_pending && exception_priority(EXC_PENDSV) < best_prio) {
+			best_exc = EXC_PENDSV;
+			best_prio = exception_priority(EXC_PENDSV);
+		}
+		if(systick_pending && exception_priority(EXC_SYSTICK) < best_prio) {
+			best_exc = EXC_SYSTICK;
+			best_prio = exception_priority(EXC_SYSTICK);
+		}
+		for(uint32_t word = 0; word < SIM_NUM_IRQ_WORDS; word++) {
+			uint32_t ready = irq_enabled[word] & irq_pending[word];
+			while(ready) {
+				uint32_t irq = word * 32 + __builtin_ctz(ready);
+				ready &= ready - 1;
+				uint32_t prio = exception_priority(irq + EXC_IRQ_OFFSET);
+				if(prio < best_prio) {
+					best_exc = irq + EXC_IRQ_OFFSET;
+					best_prio = prio;
+				}
+			}
+		}
+		if(best_exc == 0) return;
+		run_exception(best_exc);
+	}
+}
+
+//============================== CORE INTRINSICS ==============================
+extern "C" {
+
+uint32_t sim_get_primask(void) {
+	return primask;
+}
+
+void sim_set_primask(uint32_t value) {
+	primask = value & 1;
+	dispatch(); //unmasking takes anything that came pending in the meantime
+}
+
+uint32_t sim_ldrex(volatile void *addr, uint32_t size) {
+	uint32_t value;
+	if(size == 1) value = *(volatile uint8_t*)addr;
+	else if(size == 2) value = *(volatile uint16_t*)addr;
+	else value = *(volatile uint32_t*)addr;
+	monitor_addr = addr;
+
+	//an interrupt landing between the LDREX and the STREX
+	if(ldrex_isr != NULL) {
+		if(ldrex_skip) ldrex_skip--;
+		else {
+			callback_function_t isr = ldrex_isr;
+			ldrex_isr = NULL;
+			monitor_addr = NULL;
+			depth++;
+			if(depth > max_depth) max_depth = depth;
+			isr();
+			sync_gpio();
+			depth--;
+			monitor_addr = NULL;
+		}
+	}
+	return value;
+}
+
+uint32_t sim_strex(uint32_t value, volatile void *addr, uint32_t size) {
+	bool exclusive = (monitor_addr == addr);
+	monitor_addr = NULL;
+	if(!exclusive) return 1;
+	if(size == 1) *(volatile uint8_t*)addr = (uint8_t)value;
+	else if(size == 2) *(volatile uint16_t*)addr = (uint16_t)value;
+	else *(volatile uint32_t*)addr = value;
+	return 0;
+}
+
+void sim_clrex(void) {
+	monitor_addr = NULL;
+}
+
+uint32_t sim_get_ipsr(void) {
+	return depth ? active_exc[depth - 1] : 0;
+}
+
+uint32_t sim_get_msp(void) {
+	return msp;
+}
+
+//sleep until something is pending, even with PRIMASK set (that's what WFI does)
+void sim_wfi(void) {
+	dispatch();
+	uint64_t taken = exceptions_taken;
+	uint64_t deadline = now + SIM_WFI_TIMEOUT;
+	while(now < deadline) {
+		update_sources();
+		if(any_pending() || exceptions_taken != taken) return;
+		advance_raw(cycles_to_next_event());
+		dispatch();
+	}
+}
+
+//============================== NVIC FUNCTIONS ==============================
+void sim_nvic_set_priority_grouping(uint32_t group) {
+	SCB->AIRCR = (SCB->AIRCR & ~SCB_AIRCR_PRIGROUP_Msk) | ((group & 7) << SCB_AIRCR_PRIGROUP_Pos);
+}
+
+uint32_t sim_nvic_get_priority_grouping(void) {
+	return (SCB->AIRCR & SCB_AIRCR_PRIGROUP_Msk) >> SCB_AIRCR_PRIGROUP_Pos;
+}
+
+void sim_nvic_enable_irq(IRQn_Type irq) {
+	if(irq < 0) return;
+	set_bit_array(irq_enabled, irq, true);
+	set_bit_array(NVIC->ISER, irq, true);
+	dispatch();
+}
+
+uint32_t sim_nvic_get_enable_irq(IRQn_Type irq) {
+	return (irq >= 0) && get_bit_array(irq_enabled, irq);
+}
+
+void sim_nvic_disable_irq(IRQn_Type irq) {
+	if(irq < 0) return;
+	set_bit_array(irq_enabled, irq, false);
+	set_bit_array(NVIC->ISER, irq, false);
+}
+
+uint32_t sim_nvic_get_pending_irq(IRQn_Type irq) {
+	return (irq >= 0) && get_bit_array(irq_pending, irq);
+}
+
+void sim_nvic_set_pending_irq(IRQn_Type irq) {
+	if(irq < 0) return;
+	set_bit_array(irq_pending, irq, true);
+	dispatch();
+}
+
+void sim_nvic_clear_pending_irq(IRQn_Type irq) {
+	if(irq < 0) return;
+	set_bit_array(irq_pending, irq, false);
+	set_bit_array(NVIC->ISPR, irq, false);
+}
+
+uint32_t sim_nvic_get_active(IRQn_Type irq) {
+	if(irq < 0) return 0;
+	return (NVIC->IABR[irq >> 5] >> (irq & 0x1F)) & 1;
+}
+
+void sim_nvic_set_priority(IRQn_Type irq, uint32_t priority) {
+	uint8_t encoded = (uint8_t)((priority << (8U - __NVIC_PRIO_BITS)) & 0xFF);
+	if(irq < 0) SCB->SHP[(((uint32_t)irq) & 0xF) - 4] = encoded;
+	else NVIC->IP[irq] = encoded;
+}
+
+uint32_t sim_nvic_get_priority(IRQn_Type irq) {
+	if(irq < 0) return SCB->SHP[(((uint32_t)irq) & 0xF) - 4] >> (8U - __NVIC_PRIO_BITS);
+	return NVIC->IP[irq] >> (8U - __NVIC_PRIO_BITS);
+}
+
+void sim_nvic_system_reset(void) {
+	fprintf(stderr, "sim: NVIC_SystemReset()\n");
+	abort();
+}
+
+uint32_t sim_get_tick(void) {
+	return tick;
+}
+
+} //extern "C"
+
+//============================== TEST INTERFACE ==============================
+//everything but the edge log and UART capture, which don't exist yet when this first runs
+static void reset_chip() {
+	memset((void*)SIM_SRAM_BASE, 0, SIM_SRAM_SIZE);
+	memset((void*)SIM_PERIPH_BASE, 0, SIM_PERIPH_SIZE);
+	memset((void*)SIM_CORE_BASE, 0, SIM_CORE_SIZE);
+
+	//reset values that matter: the counters run all the way up
+	for(uint32_t i = 0; i < SIM_NUM_TIMERS; i++) {
+		bool wide = (timer_map[i].base == TIM2_BASE) || (timer_map[i].base == TIM5_BASE);
+		timer_regs(i)->ARR = wide ? 0xFFFFFFFFUL : 0xFFFFUL;
+		prescaler_count[i] = 0;
+		for(uint32_t chan = 0; chan < 4; chan++) ccr_shadow[i][chan] = 0;
+	}
+
+	now = 0;
+	next_systick = SIM_CYCLES_PER_TICK;
+	tick = 0;
+	primask = 0;
+	msp = SIM_RESET_MSP;
+	monitor_addr = NULL;
+	ldrex_isr = NULL;
+	ldrex_skip = 0;
+
+	for(uint32_t word = 0; word < SIM_NUM_IRQ_WORDS; word++) {
+		irq_enabled[word] = 0;
+		irq_pending[word] = 0;
+	}
+	pendsv_pending = false;
+	systick_pending = false;
+	depth = 0;
+	max_depth = 0;
+	exceptions_taken = 0;
+	sim_nvic_set_priority_grouping(NVIC_PRIORITYGROUP_4 >> SCB_AIRCR_PRIGROUP_Pos); //what HAL_Init() does
+	sim_nvic_set_priority(SysTick_IRQn, TICK_INT_PRIORITY);
+
+	exti_latched = 0;
+	exti_published = 0;
+	for(uint32_t p = 0; p < SIM_NUM_PORTS; p++) {
+		input_level[p] = 0;
+		input_driven[p] = 0;
+		last_odr[p] = 0;
+	}
+	uart_count = 0;
+}
+
+void Sim::reset() {
+	reset_chip();
+	edges.clear();
+	uart.clear();
+}
+
+void Sim::advance_cycles(const uint64_t cycles) {
+	uint64_t target = now + cycles;
+	dispatch(); //whatever the code wrote up to now happened at the current time
+	while(now < target) {
+		uint64_t step = cycles_to_next_event();
+		if(step > target - now) step = target - now;
+		advance_raw(step);
+		dispatch();
+	}
+}
+
+void Sim::advance_us(const uint64_t us) {
+	Sim::advance_cycles(us * (SIM_CPU_F_CLK / 1000000));
+}
+
+uint64_t Sim::get_cycles() {
+	return now;
+}
+
+void Sim::sync() {
+	dispatch();
+}
+
+void Sim::set_input(const dio_pin_t &pin, const bool level) {
+	uint32_t p = port_index(pin.port);
+	uint32_t bit = 1UL << pin.pin;
+	sync_gpio();
+	bool old_level = (port_regs(p)->IDR & bit) != 0;
+	input_driven[p] |= bit;
+	if(level) input_level[p] |= bit;
+	else input_level[p] &= ~bit;
+	sync_gpio();
+	bool new_level = (port_regs(p)->IDR & bit) != 0;
+
+	//edge detection runs off the pin, whether or not the line is listening
+	uint32_t line = pin.pin;
+	uint32_t routed = (SYSCFG->EXTICR[line / 4] >> ((line % 4) * 4)) & 0xF;
+	if(old_level != new_level && routed == p) {
+		bool rising = new_level && (EXTI->RTSR & bit);
+		bool falling = !new_level && (EXTI->FTSR & bit);
+		if((rising || falling) && (EXTI->IMR & bit)) exti_latched |= bit;
+	}
+	dispatch();
+}
+
+bool Sim::get_output(const dio_pin_t &pin) {
+	sync_gpio();
+	return (port_regs(port_index(pin.port))->ODR >> pin.pin) & 1;
+}
+
+uint32_t Sim::get_mode(const dio_pin_t &pin) {
+	return (port_regs(port_index(pin.port))->MODER >> (pin.pin * 2)) & 3;
+}
+
+uint32_t Sim::get_af(const dio_pin_t &pin) {
+	return (port_regs(port_index(pin.port))->AFR[pin.pin / 8] >> ((pin.pin % 8) * 4)) & 0xF;
+}
+
+const std::vector<sim_edge_t> &Sim::get_edges() {
+	sync_gpio();
+	return edges;
+}
+
+void Sim::clear_edges() {
+	sync_gpio();
+	edges.clear();
+}
+
+bool Sim::is_enabled(const IRQn_Type irq) {
+	return sim_nvic_get_enable_irq(irq) != 0;
+}
+
+bool Sim::is_pending(const IRQn_Type irq) {
+	update_sources();
+	if(irq == PendSV_IRQn) return pendsv_pending;
+	if(irq == SysTick_IRQn) return systick_pending;
+	return sim_nvic_get_pending_irq(irq) != 0;
+}
+
+uint32_t Sim::get_priority(const IRQn_Type irq) {
+	return sim_nvic_get_priority(irq);
+}
+
+uint32_t Sim::get_max_depth() {
+	return max_depth;
+}
+
+void Sim::preempt_next_ldrex(callback_function_t isr, const uint32_t skip) {
+	ldrex_isr = isr;
+	ldrex_skip = skip;
+}
+
+void Sim::set_msp(const uint32_t value) {
+	msp = value;
+}
+
+std::string &Sim::uart_output() {
+	return uart;
+}
+
+uint32_t Sim::uart_calls() {
+	return uart_count;
+}
+
+//called from the HAL stubs
+void sim_uart_write(const uint8_t *data, uint16_t size) {
+	uart.append((const char*)data, size);
+	uart_count++;
+}
@@ -0,0 +1,86 @@
+/*
+ * sim.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Simulated STM32F446 for running the app's own sources on the host
+ *  Host memory gets mapped at the real peripheral (0x40000000), core peripheral (0xE0000000) and SRAM (0x20000000) addresses
+ *  before anything else runs, so every register access in the app reads and writes ordinary memory. On top of that:
+ *   - a virtual clock (180MHz core, 90MHz timers) that `advance_cycles()` moves forward:
+ *     enabled timers count, set UIF on rollover and CCxIF on compare matches, DWT->CYCCNT and SysTick/HAL_GetTick follow along
+ *   - an NVIC: priorities, enables, pending, nested preemption, PRIMASK; timer and EXTI flags are level sources that
+ *     pend their IRQ for as long as they're set and enabled. PendSV runs `deferred_work_handler()`, SysTick runs `timestamp_keepalive()`
+ *   - GPIO: BSRR writes get latched into ODR at every sync point (interrupt entry/exit, PRIMASK changes, clock steps),
+ *     IDR follows ODR on output pins and whatever the test drives on input pins, EXTI edges fire off the driven inputs
+ *   - a log of every output edge with its cycle time, and a capture of everything sent over the UART
+ *
+ *  Code runs in zero time--only `advance_cycles()` (or a WFI) moves the clock
+ *  NOT modelled: PSC/ARR preload (writes take effect straight away), EGR, timer output pins, DMA
+ *  Only one BSRR write per port is seen between sync points, so sync between writes if a test needs both
+ */
+
+#ifndef HOST_SIM_SIM_H_
+#define HOST_SIM_SIM_H_
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include <string>
+#include <vector>
+#include "app_pin_mapping.h"
+#include "app_hal_int_utils.h"
+
+#define SIM_CPU_F_CLK 180000000ULL
+#define SIM_TIM_F_CLK 90000000ULL
+
+//one level change on an output pin
+typedef struct {
+	uint64_t cycle;
+	gpio_port_t port;
+	uint32_t pin;
+	bool level;
+} sim_edge_t;
+
+class Sim {
+public:
+	//zero every register, the clock, the NVIC and all pin state--call at the start of every test
+	static void reset();
+
+	//run the virtual clock forward, taking any interrupts that come due along the way
+	static void advance_cycles(const uint64_t cycles);
+	static void advance_us(const uint64_t us);
+	static uint64_t get_cycles();
+
+	//latch GPIO writes, re-check interrupt sources and take anything that's pending
+	static void sync();
+
+	//drive an input pin from outside the chip; fires its EXTI line if it's routed and the edge matches
+	static void set_input(const dio_pin_t &pin, const bool level);
+	static bool get_output(const dio_pin_t &pin);
+	static uint32_t get_mode(const dio_pin_t &pin); //MODER bits: 0 input, 1 output, 2 alternate function, 3 analog
+	static uint32_t get_af(const dio_pin_t &pin);
+
+	//output edges since the last reset/clear, oldest first
+	static const std::vector<sim_edge_t> &get_edges();
+	static void clear_edges();
+
+	//NVIC state as the simulated core sees it
+	static bool is_enabled(const IRQn_Type irq);
+	static bool is_pending(const IRQn_Type irq);
+	static uint32_t get_priority(const IRQn_Type irq);
+	static uint32_t get_max_depth(); //deepest the simulated handlers have ever nested
+
+	//run `isr` as an interrupt right after the next (`skip` + 1)th LDREX, i.e. inside somebody's LDREX/STREX window
+	static void preempt_next_ldrex(callback_function_t isr, const uint32_t skip = 0);
+
+	static void set_msp(const uint32_t msp);
+
+	static std::string &uart_output(); //everything `HAL_UART_Transmit()` sent
+	static uint32_t uart_calls();
+
+private:
+	//shouldn't be able to instantiate this class
+	Sim(){};
+};
+
+#endif /* HOST_SIM_SIM_H_ */
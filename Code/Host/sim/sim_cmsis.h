@@ -0,0 +1,139 @@
+/*
+ * sim_cmsis.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Stand-in for cmsis_gcc.h when building the app for the host, force-included ahead of every source file
+ *  Defines the `__CMSIS_GCC_H` guard so the real one (ARM inline assembly) never gets pulled in, then provides:
+ *   - the compiler macros the CMSIS/HAL headers expect
+ *   - the core intrinsics the app uses, backed by the simulated core in sim.cpp:
+ *     PRIMASK masks the simulated NVIC, LDREX/STREX run through an exclusive monitor that every exception entry clears,
+ *     IPSR reports whichever handler the simulated NVIC is running, WFI lets the virtual clock run to the next interrupt
+ *  Everything else (registers, NVIC, SCB, DWT) is left to the real device headers--sim.cpp maps host memory
+ *  at the real peripheral addresses, so all the register pointers in there just work
+ */
+
+#ifndef HOST_SIM_SIM_CMSIS_H_
+#define HOST_SIM_SIM_CMSIS_H_
+
+#define __CMSIS_GCC_H
+
+#include <stdint.h>
+
+#ifndef __has_builtin
+#define __has_builtin(x) (0)
+#endif
+
+#define __ASM					__asm
+#define __INLINE				inline
+#define __STATIC_INLINE			static inline
+#define __STATIC_FORCEINLINE	__attribute__((always_inline)) static inline
+#define __NO_RETURN				__attribute__((__noreturn__))
+#define __USED					__attribute__((used))
+#define __WEAK					__attribute__((weak))
+#define __PACKED				__attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT			struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION			union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)			__attribute__((aligned(x)))
+#define __RESTRICT				__restrict
+#define __COMPILER_BARRIER()	__asm volatile("" ::: "memory")
+
+#define __UNALIGNED_UINT16_WRITE(addr, val)	(void)(*(uint16_t*)(void*)(addr) = (val))
+#define __UNALIGNED_UINT16_READ(addr)		(*(const uint16_t*)(const void*)(addr))
+#define __UNALIGNED_UINT32_WRITE(addr, val)	(void)(*(uint32_t*)(void*)(addr) = (val))
+#define __UNALIGNED_UINT32_READ(addr)		(*(const uint32_t*)(const void*)(addr))
+
+//the NVIC_xxx functions go through the simulated NVIC rather than poking set/clear registers as plain memory
+#define CMSIS_NVIC_VIRTUAL
+#define CMSIS_NVIC_VIRTUAL_HEADER_FILE "sim_nvic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//implemented in sim.cpp
+uint32_t sim_get_primask(void);
+void sim_set_primask(uint32_t primask);
+uint32_t sim_ldrex(volatile void *addr, uint32_t size);
+uint32_t sim_strex(uint32_t value, volatile void *addr, uint32_t size);
+void sim_clrex(void);
+uint32_t sim_get_ipsr(void);
+uint32_t sim_get_msp(void);
+void sim_wfi(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+//============================== CORE REGISTER ACCESS ==============================
+__STATIC_FORCEINLINE void __enable_irq(void) { sim_set_primask(0); }
+__STATIC_FORCEINLINE void __disable_irq(void) { sim_set_primask(1); }
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void) { return sim_get_primask(); }
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t priMask) { sim_set_primask(priMask); }
+__STATIC_FORCEINLINE uint32_t __get_IPSR(void) { return sim_get_ipsr(); }
+__STATIC_FORCEINLINE uint32_t __get_MSP(void) { return sim_get_msp(); }
+__STATIC_FORCEINLINE uint32_t __get_CONTROL(void) { return 0; }
+__STATIC_FORCEINLINE uint32_t __get_BASEPRI(void) { return 0; }
+__STATIC_FORCEINLINE void __set_BASEPRI(uint32_t basePri) { (void)basePri; }
+__STATIC_FORCEINLINE uint32_t __get_FPSCR(void) { return 0; }
+__STATIC_FORCEINLINE void __set_FPSCR(uint32_t fpscr) { (void)fpscr; }
+
+//============================== INSTRUCTIONS ==============================
+#define __NOP()		__COMPILER_BARRIER()
+#define __WFI()		sim_wfi()
+#define __WFE()		sim_wfi()
+#define __SEV()		__COMPILER_BARRIER()
+#define __BKPT(value)	__builtin_trap()
+
+__STATIC_FORCEINLINE void __ISB(void) { __sync_synchronize(); }
+__STATIC_FORCEINLINE void __DSB(void) { __sync_synchronize(); }
+__STATIC_FORCEINLINE void __DMB(void) { __sync_synchronize(); }
+
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t value) { return __builtin_bswap32(value); }
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t value) { return ((value & 0xFF00FF00UL) >> 8) | ((value & 0x00FF00FFUL) << 8); }
+__STATIC_FORCEINLINE int16_t __REVSH(int16_t value) { return (int16_t)__builtin_bswap16((uint16_t)value); }
+__STATIC_FORCEINLINE uint32_t __ROR(uint32_t op1, uint32_t op2) {
+	op2 %= 32U;
+	return op2 ? (op1 >> op2) | (op1 << (32U - op2)) : op1;
+}
+
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value) {
+	uint32_t result = 0;
+	for(uint32_t i = 0; i < 32; i++) {
+		result = (result << 1) | (value & 1);
+		value >>= 1;
+	}
+	return result;
+}
+
+//the CLZ instruction is defined for 0, the builtin isn't
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t value) { return value ? (uint8_t)__builtin_clz(value) : 32; }
+
+__STATIC_FORCEINLINE uint8_t __LDREXB(volatile uint8_t *addr) { return (uint8_t)sim_ldrex(addr, 1); }
+__STATIC_FORCEINLINE uint16_t __LDREXH(volatile uint16_t *addr) { return (uint16_t)sim_ldrex(addr, 2); }
+__STATIC_FORCEINLINE uint32_t __LDREXW(volatile uint32_t *addr) { return sim_ldrex(addr, 4); }
+__STATIC_FORCEINLINE uint32_t __STREXB(uint8_t value, volatile uint8_t *addr) { return sim_strex(value, addr, 1); }
+__STATIC_FORCEINLINE uint32_t __STREXH(uint16_t value, volatile uint16_t *addr) { return sim_strex(value, addr, 2); }
+__STATIC_FORCEINLINE uint32_t __STREXW(uint32_t value, volatile uint32_t *addr) { return sim_strex(value, addr, 4); }
+__STATIC_FORCEINLINE void __CLREX(void) { sim_clrex(); }
+
+__STATIC_FORCEINLINE int32_t __SSAT(int32_t val, uint32_t sat) {
+	if((sat >= 1U) && (sat <= 32U)) {
+		const int32_t max = (int32_t)((1U << (sat - 1U)) - 1U);
+		const int32_t min = -1 - max;
+		if(val > max) return max;
+		if(val < min) return min;
+	}
+	return val;
+}
+
+__STATIC_FORCEINLINE uint32_t __USAT(int32_t val, uint32_t sat) {
+	if(sat <= 31U) {
+		const uint32_t max = ((1U << sat) - 1U);
+		if(val > (int32_t)max) return max;
+		if(val < 0) return 0U;
+	}
+	return (uint32_t)val;
+}
+
+#endif /* HOST_SIM_SIM_CMSIS_H_ */
@@ -0,0 +1,154 @@
+/*
+ * sim_hal.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  The slice of the HAL and the CubeMX init code the app calls into, for the host build
+ *  The MX_xxx_Init() functions leave the registers the way tim.c/gpio.c/usart.c would--keep them in step if the .ioc changes
+ */
+
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+extern "C" {
+	#include "main.h"
+	#include "tim.h"
+	#include "usart.h"
+	#include "gpio.h"
+}
+
+void sim_uart_write(const uint8_t *data, uint16_t size); //sim.cpp
+extern "C" uint32_t sim_get_tick(void);
+
+extern "C" {
+
+TIM_HandleTypeDef htim2;
+TIM_HandleTypeDef htim3;
+TIM_HandleTypeDef htim6;
+TIM_HandleTypeDef htim9;
+TIM_HandleTypeDef htim11;
+TIM_HandleTypeDef htim13;
+TIM_HandleTypeDef htim14;
+UART_HandleTypeDef huart2;
+
+//============================== HAL ==============================
+uint32_t HAL_GetTick(void) {
+	return sim_get_tick();
+}
+
+void HAL_Delay(uint32_t Delay) {
+	Sim::advance_cycles((uint64_t)Delay * (SIM_CPU_F_CLK / 1000));
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority) {
+	(void)SubPriority; //priority group 4, no sub-priorities
+	NVIC_SetPriority(IRQn, PreemptPriority);
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+	NVIC_EnableIRQ(IRQn);
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {
+	NVIC_DisableIRQ(IRQn);
+}
+
+void HAL_NVIC_SetPendingIRQ(IRQn_Type IRQn) {
+	NVIC_SetPendingIRQ(IRQn);
+}
+
+uint32_t HAL_NVIC_GetPendingIRQ(IRQn_Type IRQn) {
+	return NVIC_GetPendingIRQ(IRQn);
+}
+
+void HAL_NVIC_ClearPendingIRQ(IRQn_Type IRQn) {
+	NVIC_ClearPendingIRQ(IRQn);
+}
+
+//blocking transmit--takes as long on the virtual clock as it would on the wire (115200 8N1)
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+	(void)huart;
+	(void)Timeout;
+	sim_uart_write(pData, Size);
+	Sim::advance_cycles((uint64_t)Size * 10 * SIM_CPU_F_CLK / 115200);
+	return HAL_OK;
+}
+
+void Error_Handler(void) {
+	fprintf(stderr, "sim: Error_Handler()\n");
+	abort();
+}
+
+//============================== CUBEMX INIT ==============================
+static void sim_timer_init(TIM_HandleTypeDef *htim, TIM_TypeDef *instance, uint32_t psc, uint32_t arr, uint32_t ccmr1) {
+	htim->Instance = instance;
+	htim->Init.Prescaler = psc;
+	htim->Init.Period = arr;
+	htim->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+	htim->State = HAL_TIM_STATE_READY;
+	instance->PSC = psc;
+	instance->ARR = arr;
+	instance->CR1 = TIM_CR1_ARPE;
+	instance->CCMR1 = ccmr1;
+}
+
+//output compare "timing" mode on all four channels, with preload
+#define SIM_OC_TIMING_PRELOAD_12	(TIM_CCMR1_OC1PE | TIM_CCMR1_OC2PE)
+#define SIM_OC_TIMING_PRELOAD_34	(TIM_CCMR2_OC3PE | TIM_CCMR2_OC4PE)
+
+void MX_TIM2_Init(void) {
+	sim_timer_init(&htim2, TIM2, 899, 99, SIM_OC_TIMING_PRELOAD_12);
+	TIM2->CCMR2 = SIM_OC_TIMING_PRELOAD_34;
+}
+
+void MX_TIM3_Init(void) {
+	sim_timer_init(&htim3, TIM3, 899, 99, SIM_OC_TIMING_PRELOAD_12);
+	TIM3->CCMR2 = SIM_OC_TIMING_PRELOAD_34;
+}
+
+void MX_TIM6_Init(void) {
+	sim_timer_init(&htim6, TIM6, 0, 899, 0);
+}
+
+void MX_TIM9_Init(void) {
+	sim_timer_init(&htim9, TIM9, 3599, 24999, TIM_CCMR1_OC1PE);
+}
+
+void MX_TIM11_Init(void) {
+	sim_timer_init(&htim11, TIM11, 89, 65535, 0);
+}
+
+void MX_TIM13_Init(void) {
+	sim_timer_init(&htim13, TIM13, 8999, 9999, 0);
+}
+
+void MX_TIM14_Init(void) {
+	sim_timer_init(&htim14, TIM14, 8999, 9999, TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1PE); //PWM mode 1
+}
+
+void MX_USART2_UART_Init(void) {
+	huart2.Instance = USART2;
+	huart2.Init.BaudRate = 115200;
+	huart2.gState = HAL_UART_STATE_READY;
+}
+
+void MX_DMA_Init(void) {}
+
+static void sim_gpio_config(GPIO_TypeDef *port, uint32_t pins, uint32_t mode, uint32_t pull) {
+	for(uint32_t pin = 0; pin < 16; pin++) {
+		if(!(pins & (1UL << pin))) continue;
+		port->MODER = (port->MODER & ~(3UL << (pin * 2))) | (mode << (pin * 2));
+		port->PUPDR = (port->PUPDR & ~(3UL << (pin * 2))) | (pull << (pin * 2));
+	}
+}
+
+void MX_GPIO_Init(void) {
+	sim_gpio_config(BUTTON_GPIO_Port, BUTTON_Pin, 0, 1); //input, pull-up
+	sim_gpio_config(GPIOA, LED_Pin | DIR_Pin | LED_RED_Pin, 1, 0);
+	sim_gpio_config(STEP_GPIO_Port, STEP_Pin, 1, 0);
+	sim_gpio_config(GPIOB, LED_YELLOW_Pin | LED_GREEN_Pin | DISABLE_Pin, 1, 0);
+	Sim::sync();
+}
+
+} //extern "C"
@@ -0,0 +1,49 @@
+/*
+ * sim_nvic.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  CMSIS_NVIC_VIRTUAL header for the host build
+ *  The NVIC set/clear registers (ISER/ICER, ISPR/ICPR) are write-one-to-act, which plain memory can't do,
+ *  so the NVIC_xxx functions get pointed at the simulated NVIC in sim.cpp instead
+ *  NVIC->IP, NVIC->IABR and SCB->SHP are still kept up to date in the mapped memory, so reading them directly works
+ */
+
+#ifndef HOST_SIM_SIM_NVIC_H_
+#define HOST_SIM_SIM_NVIC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void sim_nvic_set_priority_grouping(uint32_t group);
+uint32_t sim_nvic_get_priority_grouping(void);
+void sim_nvic_enable_irq(IRQn_Type irq);
+uint32_t sim_nvic_get_enable_irq(IRQn_Type irq);
+void sim_nvic_disable_irq(IRQn_Type irq);
+uint32_t sim_nvic_get_pending_irq(IRQn_Type irq);
+void sim_nvic_set_pending_irq(IRQn_Type irq);
+void sim_nvic_clear_pending_irq(IRQn_Type irq);
+uint32_t sim_nvic_get_active(IRQn_Type irq);
+void sim_nvic_set_priority(IRQn_Type irq, uint32_t priority);
+uint32_t sim_nvic_get_priority(IRQn_Type irq);
+void sim_nvic_system_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define NVIC_SetPriorityGrouping	sim_nvic_set_priority_grouping
+#define NVIC_GetPriorityGrouping	sim_nvic_get_priority_grouping
+#define NVIC_EnableIRQ				sim_nvic_enable_irq
+#define NVIC_GetEnableIRQ			sim_nvic_get_enable_irq
+#define NVIC_DisableIRQ				sim_nvic_disable_irq
+#define NVIC_GetPendingIRQ			sim_nvic_get_pending_irq
+#define NVIC_SetPendingIRQ			sim_nvic_set_pending_irq
+#define NVIC_ClearPendingIRQ		sim_nvic_clear_pending_irq
+#define NVIC_GetActive				sim_nvic_get_active
+#define NVIC_SetPriority			sim_nvic_set_priority
+#define NVIC_GetPriority			sim_nvic_get_priority
+#define NVIC_SystemReset			sim_nvic_system_reset
+
+#endif /* HOST_SIM_SIM_NVIC_H_ */
@@ -0,0 +1,76 @@
+/*
+ * host_test.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Bare-bones test runner for the host build--every test_xxx.cpp is its own executable (and its own ctest entry)
+ *  TEST(name) { ... } registers a test; the simulated chip gets `Sim::reset()` before each one
+ *  CHECK(cond) and CHECK_EQ(a, b) report the failure and carry on; the executable fails if any check did
+ */
+
+#ifndef HOST_TESTS_HOST_TEST_H_
+#define HOST_TESTS_HOST_TEST_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "sim.h"
+
+typedef void (*host_test_func_t)(void);
+
+class Host_Test {
+public:
+	static void add(const char *name, host_test_func_t func) {
+		if(num_tests < MAX_TESTS) tests[num_tests++] = {name, func};
+	}
+
+	static void fail(const char *file, int line, const char *expr) {
+		printf("  FAILED %s:%d: %s\n", file, line, expr);
+		failures++;
+	}
+
+	static int run_all() {
+		uint32_t failed_tests = 0;
+		for(uint32_t i = 0; i < num_tests; i++) {
+			uint32_t failures_before = failures;
+			Sim::reset();
+			tests[i].func();
+			bool passed = (failures == failures_before);
+			if(!passed) failed_tests++;
+			printf("[%s] %s\n", passed ? " OK " : "FAIL", tests[i].name);
+		}
+		printf("%lu/%lu tests passed\n", (unsigned long)(num_tests - failed_tests), (unsigned long)num_tests);
+		return failed_tests ? 1 : 0;
+	}
+
+private:
+	static const uint32_t MAX_TESTS = 64;
+	struct entry_t {
+		const char *name;
+		host_test_func_t func;
+	};
+	static inline entry_t tests[MAX_TESTS];
+	static inline uint32_t num_tests = 0;
+	static inline uint32_t failures = 0;
+	Host_Test(){};
+};
+
+#define TEST(name)													\
+	static void name(void);											\
+	__attribute__((constructor(200))) static void name##_register(void) { Host_Test::add(#name, name); }	\
+	static void name(void)
+
+#define CHECK(cond) do { if(!(cond)) Host_Test::fail(__FILE__, __LINE__, #cond); } while(0)
+
+#define CHECK_EQ(a, b) do {											\
+	long long _a = (long long)(a), _b = (long long)(b);				\
+	if(_a != _b) {													\
+		char _msg[160];												\
+		snprintf(_msg, sizeof(_msg), "%s == %s (%lld vs %lld)", #a, #b, _a, _b);	\
+		Host_Test::fail(__FILE__, __LINE__, _msg);					\
+	}																\
+} while(0)
+
+//every test file ends with this
+#define HOST_TEST_MAIN() int main() { return Host_Test::run_all(); }
+
+#endif /* HOST_TESTS_HOST_TEST_H_ */
@@ -0,0 +1,81 @@
+/*
+ * test_cpu_load.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  CPU load: blocked time (i.e. a polled telemetry transmit) drops out of the load and the task's time,
+ *  including a block that spans several samples
+ *  CPU_Load keeps its windows across tests, so everything runs as one sequence
+ */
+
+#include "host_test.h"
+#include "cpu_load.h"
+#include "app_hal_timestamp.h"
+
+#define SAMPLE_US (CPU_LOAD_SAMPLE_MS * 1000)
+#define TICKS_PER_US 90
+#define TASK_PRIORITY 3
+#define TASK_US 1000ULL //how long the task ran on top of its blocking
+
+//one sample period, `idle_us` of it asleep and the rest busy, then the sample
+static void busy_sample(const uint32_t idle_us) {
+	Sim::advance_us(SAMPLE_US - idle_us);
+	CPU_Load::add_idle(idle_us * TICKS_PER_US);
+	Sim::advance_us(idle_us);
+	CPU_Load::sample();
+}
+
+TEST(blocked_time_is_neither_busy_nor_idle) {
+	Timestamp::init();
+	CPU_Load::sample(); //first one just sets the reference point
+
+	//half busy, half asleep
+	busy_sample(SAMPLE_US / 2);
+	CHECK_EQ(CPU_Load::get_load_10ms(), 5000);
+
+	//a quarter busy, a quarter asleep, half blocked: the load is over the half we weren't blocked
+	Sim::advance_us(SAMPLE_US / 4);
+	CPU_Load::add_idle(SAMPLE_US / 4 * TICKS_PER_US);
+	Sim::advance_us(SAMPLE_US / 4);
+	CPU_Load::begin_blocking();
+	Sim::advance_us(SAMPLE_US / 2);
+	CPU_Load::end_blocking();
+	CPU_Load::sample();
+	CHECK_EQ(CPU_Load::get_load_10ms(), 5000);
+
+	//the block's own time comes out of the task that did the blocking too
+	CPU_Load::add_task(TASK_PRIORITY, (SAMPLE_US / 2 + TASK_US) * TICKS_PER_US);
+
+	//a block that runs across two sample boundaries: each sample only loses its own piece of it
+	Sim::advance_us(SAMPLE_US / 2); //busy
+	CPU_Load::begin_blocking();
+	Sim::advance_us(SAMPLE_US / 2);
+	CPU_Load::sample();
+	CHECK_EQ(CPU_Load::get_load_10ms(), 10000); //only the busy half counted
+	Sim::advance_us(SAMPLE_US);
+	CPU_Load::sample();
+	CHECK_EQ(CPU_Load::get_load_10ms(), 0); //nothing but blocked time, so nothing to measure
+	Sim::advance_us(SAMPLE_US / 4);
+	CPU_Load::end_blocking();
+	CPU_Load::add_task(TASK_PRIORITY, (SAMPLE_US * 7 / 4 + TASK_US) * TICKS_PER_US);
+
+	//the rest of that sample is a quarter busy, half asleep
+	Sim::advance_us(SAMPLE_US / 4);
+	CPU_Load::add_idle(SAMPLE_US / 2 * TICKS_PER_US);
+	Sim::advance_us(SAMPLE_US / 2);
+	CPU_Load::sample();
+	CHECK_EQ(CPU_Load::get_load_10ms(), 3333);
+
+	//fill out the second at half busy; the per-task figures only show up once it's done
+	for(uint32_t i = 0; i < CPU_LOAD_1S_SLOTS - 6; i++) busy_sample(SAMPLE_US / 2);
+	CHECK_EQ(CPU_Load::get_task_load(TASK_PRIORITY), 0);
+	busy_sample(SAMPLE_US / 2);
+
+	//blocked: half of one sample, half of the next, all of the one after and a quarter of the last
+	uint64_t measured_us = CPU_LOAD_1S_SLOTS * SAMPLE_US - (SAMPLE_US / 2 + SAMPLE_US / 2 + SAMPLE_US + SAMPLE_US / 4);
+	uint64_t busy_us = SAMPLE_US / 2 + SAMPLE_US / 4 + SAMPLE_US / 2 + SAMPLE_US / 4 + (CPU_LOAD_1S_SLOTS - 5) * SAMPLE_US / 2;
+	CHECK_EQ(CPU_Load::get_load_1s(), (uint32_t)(busy_us * 10000 / measured_us));
+	CHECK_EQ(CPU_Load::get_task_load(TASK_PRIORITY), (uint32_t)(2 * TASK_US * 10000 / measured_us)); //just the time it actually ran
+}
+
+HOST_TEST_MAIN()
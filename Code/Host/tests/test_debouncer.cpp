@@ -0,0 +1,219 @@
+/*
+ * test_debouncer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Single-pin debouncer driven by hand at its 1kHz sample rate
+ *  Ends with the same seeded noisy trace through both modes: the integrator has to give fewer false edges
+ *  than the counter without taking much longer to follow the real ones
+ */
+
+#include "host_test.h"
+#include "debouncer.h"
+#include <random>
+#include <stdio.h>
+
+#define BOUNCE_MS 5
+
+static const dio_pin_t test_pin = {PORT_C, 0};
+
+static void sample(Debouncer &db, uint32_t n) {
+	for(uint32_t i = 0; i < n; i++) db.sample_and_update();
+}
+
+TEST(counter_mode_edges) {
+	DIO pin(test_pin);
+	Debouncer db(pin, BOUNCE_MS, false);
+	Sim::set_input(test_pin, true);
+	sample(db, BOUNCE_MS);
+	CHECK_EQ(db.read_db(), 0);
+	sample(db, 1);
+	CHECK_EQ(db.read_db(), 1);
+
+	uint32_t flags = db.get_flags_db(true);
+	CHECK(flags & DEBOUNCE_FLAG_RISING);
+	CHECK(flags & DEBOUNCE_FLAG_CHANGE);
+	CHECK(flags & DEBOUNCE_FLAG_STATE);
+	CHECK(!(flags & DEBOUNCE_FLAG_FALLING));
+	CHECK_EQ(db.get_flags_db(), DEBOUNCE_FLAG_STATE); //edges cleared, state kept
+}
+
+//the sampling ISR records an edge right between a getter's LDREX and STREX
+static Debouncer *isr_db = NULL;
+static void sampling_isr() {
+	sample(*isr_db, BOUNCE_MS + 1);
+}
+
+TEST(edge_landing_mid_clear_is_never_lost) {
+	DIO pin(test_pin);
+	Debouncer db(pin, BOUNCE_MS, false);
+	isr_db = &db;
+
+	//rising edge already flagged, falling edge about to land
+	Sim::set_input(test_pin, true);
+	sample(db, BOUNCE_MS + 1);
+	Sim::set_input(test_pin, false);
+
+	Sim::preempt_next_ldrex(sampling_isr);
+	CHECK_EQ(db.get_rising_edge_db(), 1);
+	CHECK_EQ(db.get_falling_edge_db(), 1);
+	CHECK_EQ(db.get_change_db(), 1);
+	CHECK_EQ(db.read_db(), 0);
+}
+
+TEST(snapshot_clear_keeps_edges_that_land_mid_clear) {
+	DIO pin(test_pin);
+	Debouncer db(pin, BOUNCE_MS, false);
+	isr_db = &db;
+	Sim::set_input(test_pin, true);
+
+	Sim::preempt_next_ldrex(sampling_isr);
+	uint32_t first = db.get_flags_db(true);
+	uint32_t second = db.get_flags_db(true);
+	CHECK((first | second) & DEBOUNCE_FLAG_RISING);
+	CHECK(!((first & second) & DEBOUNCE_FLAG_RISING)); //reported exactly once
+	CHECK(second & DEBOUNCE_FLAG_STATE);
+}
+
+//integrator runs 0..10, goes HIGH at 7 and LOW at 3
+TEST(integrator_rides_out_isolated_spikes) {
+	DIO pin(test_pin);
+	Debouncer db(pin, 10, false);
+	db.set_integrator_mode(7, 3);
+
+	//one HIGH sample in every three never gets the count anywhere
+	for(uint32_t i = 0; i < 60; i++) {
+		Sim::set_input(test_pin, (i % 3) == 0);
+		sample(db, 1);
+	}
+	CHECK_EQ(db.read_db(), 0);
+	CHECK_EQ(db.get_change_db(), 0);
+
+	//steady HIGH crosses the upper threshold on the 7th sample
+	Sim::set_input(test_pin, true);
+	sample(db, 6);
+	CHECK_EQ(db.read_db(), 0);
+	sample(db, 1);
+	CHECK_EQ(db.read_db(), 1);
+	CHECK_EQ(db.get_rising_edge_db(), 1);
+
+	//saturate at the top, then a noisy LOW stretch has to walk all the way down to 3
+	sample(db, 10);
+	Sim::set_input(test_pin, false);
+	sample(db, 6);
+	CHECK_EQ(db.read_db(), 1); //10 -> 4
+	Sim::set_input(test_pin, true);
+	sample(db, 1); //5
+	Sim::set_input(test_pin, false);
+	sample(db, 1);
+	CHECK_EQ(db.read_db(), 1); //4
+	sample(db, 1);
+	CHECK_EQ(db.read_db(), 0); //3
+	CHECK_EQ(db.get_falling_edge_db(), 1);
+	CHECK_EQ(db.get_rising_edge_db(), 0);
+}
+
+TEST(integrator_rejects_bad_thresholds_and_switches_cleanly) {
+	DIO pin(test_pin);
+	Debouncer db(pin, 10, false);
+	Sim::set_input(test_pin, true);
+	sample(db, 11);
+	CHECK_EQ(db.read_db(), 1);
+	db.get_flags_db(true);
+
+	//no hysteresis, or past the top of the integrator: stays in counter mode
+	db.set_integrator_mode(5, 5);
+	db.set_integrator_mode(11, 3);
+	Sim::set_input(test_pin, false);
+	sample(db, 11);
+	CHECK_EQ(db.read_db(), 0);
+	db.get_flags_db(true);
+
+	//switching modes starts the integrator on the current state's rail, so there's no fake edge
+	db.set_integrator_mode(7, 3);
+	sample(db, 20);
+	CHECK_EQ(db.get_change_db(), 0);
+	Sim::set_input(test_pin, true);
+	sample(db, 7);
+	CHECK_EQ(db.read_db(), 1);
+
+	//and back again
+	db.set_counter_mode();
+	Sim::set_input(test_pin, false);
+	sample(db, 11);
+	CHECK_EQ(db.read_db(), 0);
+}
+
+//noisy trace: the input holds each level for a while, bounces when it changes, and picks up single-sample spikes in between
+#define TRACE_SEEDS 8
+#define TRACE_TRANSITIONS 20
+#define TRACE_HOLD_MS 100
+#define TRACE_BOUNCE_MS 3
+#define TRACE_SPIKE_PERCENT 10
+#define TRACE_DB_MS 10 //bounce time for both modes, and the integrator's range
+#define TRACE_HIGH 7
+#define TRACE_LOW 3
+#define TRACE_EXTRA_LATENCY_MS 2 //how much slower than the counter the integrator may be, on average
+
+typedef struct {
+	uint32_t false_edges; //every edge past the one each real transition should give
+	uint32_t latency_ms; //summed over the transitions, up to the first edge onto the new level
+	bool settled; //on the right level at the end of every hold
+} trace_result_t;
+
+static trace_result_t run_trace(const uint32_t seed, const bool integrating) {
+	DIO pin(test_pin);
+	Debouncer db(pin, TRACE_DB_MS, false);
+	Sim::set_input(test_pin, false);
+	sample(db, TRACE_DB_MS + 1);
+	db.get_flags_db(true);
+	if(integrating) db.set_integrator_mode(TRACE_HIGH, TRACE_LOW);
+
+	std::mt19937 rng(seed);
+	trace_result_t result = {0, 0, true};
+	uint32_t edges = 0;
+	bool level = false;
+	for(uint32_t t = 0; t < TRACE_TRANSITIONS; t++) {
+		level = !level;
+		uint32_t first_edge = 0;
+		for(uint32_t ms = 0; ms < TRACE_HOLD_MS; ms++) {
+			bool input = level;
+			if(ms < TRACE_BOUNCE_MS) input = rng() & 1;
+			else if(rng() % 100 < TRACE_SPIKE_PERCENT) input = !level;
+			Sim::set_input(test_pin, input);
+			sample(db, 1);
+			if(db.get_change_db()) {
+				edges++;
+				if((db.read_db() == level) && (first_edge == 0)) first_edge = ms + 1;
+			}
+		}
+		result.settled &= (db.read_db() == level);
+		result.latency_ms += first_edge;
+	}
+	result.false_edges = edges - TRACE_TRANSITIONS;
+	return result;
+}
+
+TEST(integrator_beats_counter_on_a_noisy_trace) {
+	trace_result_t counter = {0, 0, true}, integrator = {0, 0, true};
+	for(uint32_t seed = 1; seed <= TRACE_SEEDS; seed++) {
+		trace_result_t c = run_trace(seed, false);
+		trace_result_t i = run_trace(seed, true);
+		counter.false_edges += c.false_edges;
+		counter.latency_ms += c.latency_ms;
+		counter.settled &= c.settled;
+		integrator.false_edges += i.false_edges;
+		integrator.latency_ms += i.latency_ms;
+		integrator.settled &= i.settled;
+	}
+	printf("noisy trace: counter %u false edges, %u ms latency; integrator %u false edges, %u ms latency\n",
+			(unsigned)counter.false_edges, (unsigned)counter.latency_ms, (unsigned)integrator.false_edges,
+			(unsigned)integrator.latency_ms);
+
+	CHECK(integrator.settled); //the counter can get caught out by a spike right at the end of a hold, so no such luck there
+	CHECK(counter.false_edges > 0); //or the trace isn't noisy enough to tell them apart
+	CHECK(integrator.false_edges < counter.false_edges);
+	CHECK(integrator.latency_ms <= counter.latency_ms + TRACE_EXTRA_LATENCY_MS * TRACE_SEEDS * TRACE_TRANSITIONS);
+}
+
+HOST_TEST_MAIN()
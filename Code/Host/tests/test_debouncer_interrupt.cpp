@@ -0,0 +1,141 @@
+/*
+ * test_debouncer_interrupt.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Debouncer interrupt mode: the sampling timer only runs while an edge is being debounced
+ *  Sampling timer ISRs are counted with the ISR profiler, and edges are timed off the event queue's timestamps
+ */
+
+// HOST_TEST_DEFINES: ISR_PROFILING=1
+
+#include "host_test.h"
+#include "debouncer.h"
+#include "input_events.h"
+#include "app_hal_isr_profiler.h"
+#include "app_hal_timestamp.h"
+
+#define BOUNCE_MS 10
+#define BOUNCES 10
+#define BOUNCE_US 300
+#define IDLE_US 1000000
+#define BOUNCE_PHASE_US 250 //bounce starts this long after a sampling timer tick, so no edge lands right on one
+#define SAMPLE_US 1000 //1kHz sampling timer, ticking on every whole ms since it started
+#define CYCLES_PER_US (SIM_CPU_F_CLK / 1000000)
+
+//the edge that arms the line samples straight away (the timer's compare flag has been sitting there set the whole time),
+//and that sample starts the count; the counter debouncer then flips on the BOUNCE_MS-th tick after it
+#define FIRST_TICK_US (SAMPLE_US - BOUNCE_PHASE_US)
+#define EDGE_US (FIRST_TICK_US + (BOUNCE_MS - 1) * SAMPLE_US) //from the edge that armed the line
+#define DEBOUNCE_SAMPLES (BOUNCE_MS + 1) //the one at the arming edge, then BOUNCE_MS ticks
+
+static Input_Event_Queue queue;
+
+static bool sampling() {
+	return Sim::is_enabled(TIM1_BRK_TIM9_IRQn);
+}
+
+//user button is active low with a pull-up
+static void press(bool pressed) {
+	Sim::set_input(PinMap::user_button, !pressed);
+}
+
+//sampling timer ISRs since the last call
+static uint32_t samples_taken() {
+	uint32_t count = ISR_Profiler::get_stats(PROFILE_TIMER_CHAN_0).count;
+	ISR_Profiler::clear();
+	return count;
+}
+
+TEST(sleeps_until_an_edge_then_debounces_it) {
+	DIO::init();
+	Timestamp::init();
+	ISR_Profiler::init();
+	static DIO button(PinMap::user_button);
+	static Debouncer db(button, BOUNCE_MS, true);
+	db.set_event_queue(&queue, 0);
+	Timer sample_timer(CHANNEL_0);
+	sample_timer.init();
+	sample_timer.set_freq(Timer::FREQ_1kHz);
+	sample_timer.set_int_priority(MED);
+	Debouncer::configure_interrupt_sampling(sample_timer);
+	db.enable_interrupt_mode(HIGH);
+
+	//takes a look straight away, sees nothing to do, and goes back to sleep
+	Sim::advance_us(2000);
+	CHECK(!sampling());
+	CHECK_EQ(db.read_db(), 0);
+	CHECK_EQ(samples_taken(), 1);
+
+	//nothing happens for a long time, and the sampling timer stays off--not a single sample
+	Sim::advance_us(IDLE_US + BOUNCE_PHASE_US);
+	CHECK(!sampling());
+	CHECK_EQ(samples_taken(), 0);
+
+	//bounce for a few ms, then settle pressed--the first bounce edge arms the line
+	uint64_t bounce_cycle = Sim::get_cycles();
+	for(uint32_t i = 0; i < BOUNCES; i++) {
+		press(i % 2 == 0);
+		Sim::advance_us(BOUNCE_US);
+	}
+	press(true);
+	uint64_t settle_cycle = Sim::get_cycles();
+	CHECK(sampling());
+	CHECK_EQ(db.read_db(), 0);
+	Sim::advance_us((BOUNCE_MS + 2) * 1000);
+	CHECK_EQ(db.read_db(), 1);
+	CHECK_EQ(db.get_rising_edge_db(), 1);
+	CHECK_EQ(db.get_falling_edge_db(), 0);
+	CHECK(!sampling());
+
+	//exactly when the edge was accepted (timestamps tick at half the core clock), and what it cost
+	input_event_t event;
+	CHECK(queue.pop(event));
+	CHECK_EQ(event.timestamp * 2 - settle_cycle, (EDGE_US - BOUNCES * BOUNCE_US) * CYCLES_PER_US);
+	CHECK_EQ(event.timestamp * 2 - bounce_cycle, EDGE_US * CYCLES_PER_US);
+	CHECK_EQ(samples_taken(), DEBOUNCE_SAMPLES);
+
+	//and a clean release, still off the tick grid
+	uint64_t release_cycle = Sim::get_cycles();
+	press(false);
+	Sim::advance_us((BOUNCE_MS + 5) * 1000);
+	CHECK_EQ(db.read_db(), 0);
+	CHECK_EQ(db.get_falling_edge_db(), 1);
+	CHECK(!sampling());
+	CHECK(queue.pop(event));
+	CHECK_EQ(event.edge, INPUT_EDGE_FALLING);
+	CHECK_EQ(event.timestamp * 2 - release_cycle, EDGE_US * CYCLES_PER_US);
+	CHECK_EQ(samples_taken(), DEBOUNCE_SAMPLES);
+
+	//back to idle
+	Sim::advance_us(IDLE_US);
+	CHECK_EQ(samples_taken(), 0);
+
+	db.disable_interrupt_mode();
+	sample_timer.disable_tim();
+}
+
+TEST(short_glitch_doesnt_make_an_edge) {
+	DIO::init();
+	static DIO button(PinMap::user_button);
+	static Debouncer db(button, BOUNCE_MS, true);
+	Timer sample_timer(CHANNEL_0);
+	sample_timer.init();
+	sample_timer.set_freq(Timer::FREQ_1kHz);
+	Debouncer::configure_interrupt_sampling(sample_timer);
+	db.enable_interrupt_mode(HIGH);
+	Sim::advance_us(2000);
+
+	press(true);
+	Sim::advance_us(1500);
+	press(false);
+	Sim::advance_us((BOUNCE_MS + 5) * 1000);
+	CHECK_EQ(db.read_db(), 0);
+	CHECK_EQ(db.get_change_db(), 0);
+	CHECK(!sampling());
+
+	db.disable_interrupt_mode();
+	sample_timer.disable_tim();
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,200 @@
+/*
+ * test_gpio_capture.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  GPIO capture: the waveform metrics and skew over pins driven at known times, ordering of edges logged after the fact,
+ *  stopping when the buffer fills, the VCD dump, and Hard_PWM's edges making it in from PendSV
+ *  Timestamps tick at 90MHz, so every time used here comes out to a whole number of ns
+ */
+
+// HOST_TEST_DEFINES: GPIO_CAPTURE=1
+
+#include "host_test.h"
+#include "app_hal_gpio_capture.h"
+#include "app_hal_pwm.h"
+#include "app_hal_deferred.h"
+#include <string>
+extern "C" {
+	#include "usart.h"
+}
+
+#define HIGH_US 300
+#define LOW_US 700
+#define PERIODS 5
+
+//board outputs, see MX_GPIO_Init()
+static const dio_pin_t pin_a9 = {PORT_A, 9};
+static const dio_pin_t pin_b6 = {PORT_B, 6};
+
+static void square_wave(const DIO &pin, const uint32_t periods) {
+	for(uint32_t i = 0; i < periods; i++) {
+		pin.set();
+		Sim::advance_us(HIGH_US);
+		pin.clear();
+		Sim::advance_us(LOW_US);
+	}
+}
+
+TEST(metrics_of_a_square_wave) {
+	DIO::init();
+	Timestamp::init();
+	DIO a9(pin_a9);
+
+	GPIO_Capture::start();
+	a9.clear(); //the first write just sets the level
+	Sim::advance_us(LOW_US);
+	square_wave(a9, PERIODS);
+	GPIO_Capture::stop();
+
+	gpio_capture_metrics_t metrics = GPIO_Capture::analyze(pin_a9);
+	CHECK_EQ(metrics.edges, 2 * PERIODS);
+	CHECK_EQ(metrics.periods, PERIODS - 1);
+	CHECK_EQ((uint32_t)(metrics.frequency_hz + 0.5f), 1000);
+	CHECK_EQ((uint32_t)(metrics.duty * 1000 + 0.5f), HIGH_US * 1000 / (HIGH_US + LOW_US));
+	CHECK_EQ(metrics.period_min_ns, (HIGH_US + LOW_US) * 1000);
+	CHECK_EQ(metrics.jitter_ns, 0);
+	CHECK_EQ(metrics.min_pulse_ns, HIGH_US * 1000);
+}
+
+TEST(repeated_writes_arent_edges) {
+	DIO::init();
+	Timestamp::init();
+	DIO a9(pin_a9);
+
+	GPIO_Capture::start();
+	a9.clear(); //first write only tells us the level
+	Sim::advance_us(10);
+	a9.set();
+	Sim::advance_us(10);
+	a9.set();
+	a9.set();
+	Sim::advance_us(10);
+	a9.clear();
+	GPIO_Capture::stop();
+
+	CHECK_EQ(GPIO_Capture::get_count(), 5);
+	gpio_capture_metrics_t metrics = GPIO_Capture::analyze(pin_a9);
+	CHECK_EQ(metrics.edges, 2);
+	CHECK_EQ(metrics.periods, 0);
+	CHECK_EQ(metrics.min_pulse_ns, 20000);
+}
+
+TEST(skew_between_two_pins) {
+	DIO::init();
+	Timestamp::init();
+	DIO a9(pin_a9), b6(pin_b6);
+	a9.clear();
+	b6.clear();
+
+	GPIO_Capture::start();
+	for(uint32_t i = 0; i < PERIODS; i++) {
+		a9.set();
+		Sim::advance_us(50 + i); //a microsecond of wander each time
+		b6.set();
+		Sim::advance_us(100);
+		a9.clear();
+		b6.clear();
+		Sim::advance_us(100);
+	}
+	GPIO_Capture::stop();
+
+	gpio_capture_skew_t skew = GPIO_Capture::skew(pin_a9, pin_b6);
+	CHECK_EQ(skew.pairs, PERIODS);
+	CHECK_EQ(skew.min_ns, 50000);
+	CHECK_EQ(skew.max_ns, 54000);
+	CHECK_EQ(skew.mean_ns, 52000);
+
+	//the other way round it's up to the next period's rising edge
+	gpio_capture_skew_t back = GPIO_Capture::skew(pin_b6, pin_a9);
+	CHECK_EQ(back.pairs, PERIODS - 1);
+	CHECK_EQ(back.min_ns, 200000);
+	CHECK_EQ(back.max_ns, 200000);
+}
+
+TEST(late_records_get_sorted_in) {
+	DIO::init();
+	Timestamp::init();
+	DIO a9(pin_a9);
+
+	GPIO_Capture::start();
+	a9.clear();
+	Sim::advance_us(LOW_US);
+	uint32_t rise = Timestamp::now_ticks32(); //what Hard_PWM's ISR does: timestamp now, log it later
+	Sim::advance_us(HIGH_US);
+	a9.clear(); //lands in the buffer before the edge it comes after
+	GPIO_Capture::record_at(pin_a9, true, rise);
+	GPIO_Capture::stop();
+
+	//in write order that'd be low, low, high: a single edge and no pulse
+	CHECK_EQ(GPIO_Capture::get_count(), 3);
+	gpio_capture_metrics_t metrics = GPIO_Capture::analyze(pin_a9);
+	CHECK_EQ(metrics.edges, 2);
+	CHECK_EQ(metrics.min_pulse_ns, HIGH_US * 1000);
+}
+
+TEST(stops_once_the_buffer_fills) {
+	DIO::init();
+	Timestamp::init();
+	DIO a9(pin_a9);
+
+	GPIO_Capture::start();
+	for(uint32_t i = 0; i < GPIO_CAPTURE_DEPTH + 10; i++) {
+		if(i & 1) a9.set();
+		else a9.clear();
+	}
+	CHECK(!GPIO_Capture::is_running());
+	CHECK_EQ(GPIO_Capture::get_count(), GPIO_CAPTURE_DEPTH);
+	GPIO_Capture::stop();
+}
+
+TEST(vcd_dump) {
+	DIO::init();
+	Timestamp::init();
+	DIO a9(pin_a9), b6(pin_b6);
+
+	GPIO_Capture::start();
+	a9.clear();
+	b6.set();
+	Sim::advance_us(1);
+	a9.set();
+	a9.set(); //no change, no line
+	Sim::advance_us(1);
+	a9.clear();
+	b6.clear();
+	GPIO_Capture::stop();
+
+	Sim::uart_output().clear();
+	GPIO_Capture::dump_vcd(&huart2);
+	CHECK(Sim::uart_output() ==
+			"$timescale 1ns $end\n$scope module gpio $end\n"
+			"$var wire 1 ! PA9 $end\n$var wire 1 \" PB6 $end\n"
+			"$upscope $end\n$enddefinitions $end\n"
+			"#0\n0!\n1\"\n"
+			"#1000\n1!\n"
+			"#2000\n0!\n0\"\n");
+}
+
+TEST(hard_pwm_edges_come_in_from_pendsv) {
+	DIO::init();
+	Timestamp::init();
+	Deferred_Work::init();
+	DIO a9(pin_a9);
+	Hard_PWM pwm(a9, false);
+	Hard_PWM::configure(1000.0f, MED);
+	pwm.set(0.25f);
+	Sim::advance_us(1500); //let it settle into its period
+
+	//the timer isn't lined up with anything here, so give it an extra period to be sure of `PERIODS` rising edges
+	GPIO_Capture::start();
+	Sim::advance_us((PERIODS + 1) * 1000);
+	GPIO_Capture::stop();
+
+	gpio_capture_metrics_t metrics = GPIO_Capture::analyze(pin_a9);
+	CHECK(metrics.periods >= PERIODS - 1);
+	CHECK_EQ((uint32_t)(metrics.frequency_hz + 0.5f), 1000);
+	CHECK_EQ((uint32_t)(metrics.duty * 100 + 0.5f), 25);
+	CHECK_EQ(metrics.jitter_ns, 0);
+}
+
+HOST_TEST_MAIN()
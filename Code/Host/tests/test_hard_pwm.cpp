@@ -0,0 +1,161 @@
+/*
+ * test_hard_pwm.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Hard_PWM: construction before the timers exist, which pins the timers get to drive directly (and when that's decided),
+ *  and the interrupt rates each group reports to the priority registry
+ *  ISR channels are mapped in construction order, and every test's channels go out of scope (and get unmapped) at the end
+ *  Only the first test runs unconfigured--`configure()` sticks for the rest of the run
+ */
+
+#include "host_test.h"
+#include "app_hal_pwm.h"
+extern "C" {
+	#include "tim.h"
+}
+
+#define PWM_FREQ 1000.0f
+
+//none of these have a TIM2/TIM3 alternate function, so they all run off the ISR
+static const dio_pin_t pin_a8 = {PORT_A, 8};
+static const dio_pin_t pin_a9 = {PORT_A, 9};
+static const dio_pin_t pin_b6 = {PORT_B, 6};
+static const dio_pin_t pin_b7 = {PORT_B, 7};
+static const dio_pin_t pin_c0 = {PORT_C, 0};
+
+//timer outputs
+static const dio_pin_t pin_a0 = {PORT_A, 0}; //TIM2_CH1
+static const dio_pin_t pin_a5 = {PORT_A, 5}; //TIM2_CH1 as well
+static const dio_pin_t pin_b10 = {PORT_B, 10}; //TIM2_CH3
+static const dio_pin_t pin_c7 = {PORT_C, 7}; //TIM3_CH2
+
+#define AF_TIM2 1
+#define AF_TIM3 2
+#define PIN_MODE_AF 2
+
+TEST(constructing_before_configure_leaves_the_timer_and_pins_alone) {
+	//what static init looks like: the CubeMX init functions haven't filled the handles in yet
+	htim2.Instance = NULL;
+	htim3.Instance = NULL;
+	DIO a8(pin_a8), a0(pin_a0), a5(pin_a5), c7(pin_c7);
+	Hard_PWM pwm_a8(a8, false); //channel 0 for now
+	Hard_PWM pwm_a0(a0, true); //channel 1 for now, TIM2_CH1 is channel 0
+	Hard_PWM pwm_a5(a5, false); //also wants channel 0
+	Hard_PWM pwm_c7(c7, false); //wants channel 5
+	CHECK_EQ(TIM2->DIER, 0);
+	CHECK(!pwm_a0.is_hardware_output());
+	CHECK(!pwm_c7.is_hardware_output());
+	CHECK(Sim::get_mode(pin_a0) != PIN_MODE_AF);
+	CHECK(Sim::get_mode(pin_c7) != PIN_MODE_AF);
+
+	//configure hands the timer outputs their channels, and picks up the rest on the ISR
+	Hard_PWM::configure(PWM_FREQ, MED);
+	CHECK(pwm_a0.is_hardware_output());
+	CHECK(pwm_c7.is_hardware_output());
+	CHECK(!pwm_a8.is_hardware_output()); //swapped out of channel 0 onto channel 1
+	CHECK(!pwm_a5.is_hardware_output()); //first one there got the timer channel
+	CHECK_EQ(Sim::get_mode(pin_a0), PIN_MODE_AF);
+	CHECK_EQ(Sim::get_af(pin_a0), AF_TIM2);
+	CHECK_EQ(Sim::get_mode(pin_c7), PIN_MODE_AF);
+	CHECK_EQ(Sim::get_af(pin_c7), AF_TIM3);
+	CHECK(Sim::get_mode(pin_a5) != PIN_MODE_AF);
+
+	//TIM2_CH1 and TIM3_CH2 drive their pins (inverted on the first), channels 1 and 2 go through the ISR
+	CHECK_EQ(TIM2->CCER, TIM_CCER_CC1E | TIM_CCER_CC1P);
+	CHECK_EQ(TIM3->CCER, TIM_CCER_CC2E);
+	CHECK_EQ(TIM2->DIER, TIM_DIER_UIE | TIM_DIER_CC2IE | TIM_DIER_CC3IE);
+	CHECK_EQ(TIM3->DIER, 0); //nothing in group B interrupts
+	CHECK_EQ(Hard_PWM::get_irq_rate(0, PWM_FREQ), 3 * PWM_FREQ);
+	CHECK_EQ(Hard_PWM::get_irq_rate(1, PWM_FREQ), 0);
+
+	//the swapped instance still drives its own pin
+	pwm_a8.force_asserted();
+	Sim::sync();
+	CHECK(Sim::get_output(pin_a8));
+}
+
+TEST(timer_output_lookup) {
+	CHECK_EQ(Hard_PWM::timer_channel_of(pin_a0), 0);
+	CHECK_EQ(Hard_PWM::timer_channel_of(pin_a5), 0);
+	CHECK_EQ(Hard_PWM::timer_channel_of(pin_b10), 2);
+	CHECK_EQ(Hard_PWM::timer_channel_of(pin_c7), 5);
+	CHECK_EQ(Hard_PWM::timer_channel_of((dio_pin_t){PORT_B, 1}), 7); //TIM3_CH4
+	CHECK_EQ(Hard_PWM::timer_channel_of(pin_a8), CHANNEL_NOT_MAPPED);
+	CHECK_EQ(Hard_PWM::timer_channel_of((dio_pin_t){PORT_C, 5}), CHANNEL_NOT_MAPPED);
+}
+
+TEST(constructing_after_configure_claims_the_timer_output_right_away) {
+	DIO a8(pin_a8), b10(pin_b10);
+	Hard_PWM pwm_a8(a8, false);
+	Hard_PWM::configure(PWM_FREQ, MED);
+
+	Hard_PWM pwm_b10(b10, false);
+	CHECK(pwm_b10.is_hardware_output());
+	CHECK_EQ(Sim::get_mode(pin_b10), PIN_MODE_AF);
+	CHECK_EQ(Sim::get_af(pin_b10), AF_TIM2);
+	CHECK_EQ(TIM2->CCER, TIM_CCER_CC3E);
+	CHECK_EQ(TIM2->DIER, TIM_DIER_UIE | TIM_DIER_CC1IE); //just the ISR channel
+
+	//the compare goes straight into CCR3
+	pwm_b10.set(0.25f);
+	CHECK_EQ(TIM2->CCR3, 25);
+}
+
+TEST(constructing_after_configure_turns_its_interrupts_on) {
+	DIO first(pin_a8), second(pin_a9);
+	Hard_PWM pwm_first(first, false);
+	Hard_PWM::configure(PWM_FREQ, MED);
+
+	Hard_PWM pwm_second(second, false);
+	CHECK_EQ(TIM2->DIER, TIM_DIER_UIE | TIM_DIER_CC1IE | TIM_DIER_CC2IE);
+}
+
+TEST(irq_rate_counts_the_update_once_per_group) {
+	DIO a8(pin_a8), a9(pin_a9), b6(pin_b6);
+	Hard_PWM pwm_0(a8, false), pwm_1(a9, false), pwm_2(b6, true);
+	Hard_PWM::configure(PWM_FREQ, MED);
+
+	//three compares plus the shared rollover
+	CHECK_EQ(Hard_PWM::get_irq_rate(0, PWM_FREQ), 4 * PWM_FREQ);
+	CHECK_EQ(Hard_PWM::get_irq_rate(1, PWM_FREQ), 0);
+	CHECK_EQ(Hard_PWM::get_irq_rate(2, PWM_FREQ), 0); //no such group
+}
+
+TEST(irq_rate_follows_the_channels_into_group_b) {
+	DIO a8(pin_a8), a9(pin_a9), b6(pin_b6), b7(pin_b7), c0(pin_c0);
+	Hard_PWM pwm_0(a8, false), pwm_1(a9, false), pwm_2(b6, false), pwm_3(b7, false), pwm_4(c0, false);
+	Hard_PWM::configure(PWM_FREQ, MED);
+
+	CHECK_EQ(Hard_PWM::get_irq_rate(0, PWM_FREQ), 5 * PWM_FREQ);
+	CHECK_EQ(Hard_PWM::get_irq_rate(1, PWM_FREQ), 2 * PWM_FREQ);
+	CHECK_EQ(Hard_PWM::get_irq_rate(1, 2 * PWM_FREQ), 4 * PWM_FREQ); //scales with the frequency asked about
+}
+
+TEST(irq_rate_counts_both_edges_of_a_phased_channel) {
+	DIO a8(pin_a8), a9(pin_a9);
+	Hard_PWM pwm_0(a8, false), pwm_1(a9, false);
+	Hard_PWM::configure(PWM_FREQ, MED);
+
+	//one compare plus the rollover for the plain channel, two compares for the phased one
+	pwm_1.set_phase(0.5f);
+	CHECK_EQ(Hard_PWM::get_irq_rate(0, PWM_FREQ), 4 * PWM_FREQ);
+
+	//with nothing left on the rollover, the update doesn't count either
+	pwm_0.set_phase(0.25f);
+	CHECK_EQ(Hard_PWM::get_irq_rate(0, PWM_FREQ), 4 * PWM_FREQ);
+}
+
+TEST(irq_rate_drops_unmapped_channels) {
+	DIO a8(pin_a8);
+	Hard_PWM pwm_0(a8, false);
+	Hard_PWM::configure(PWM_FREQ, MED);
+	{
+		DIO a9(pin_a9);
+		Hard_PWM pwm_1(a9, false);
+		CHECK_EQ(Hard_PWM::get_irq_rate(0, PWM_FREQ), 3 * PWM_FREQ);
+	}
+	CHECK_EQ(Hard_PWM::get_irq_rate(0, PWM_FREQ), 2 * PWM_FREQ);
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,142 @@
+/*
+ * test_hard_pwm_bench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Hard_PWM ISR before and after the per-port BSRR tables, with 1, 4 and 8 channels running off the ISR
+ *  "Before" is the old unrolled ISR, kept here as a reference: per channel it checks the blank/in use/inverted flags
+ *  and drives the pin through its `DIO`, one BSRR store per channel. "After" is the real `isr_groupA()`/`isr_groupB()`
+ *  The sim runs code in zero virtual time, so this times host wall clock per interrupt--only the before/after ratio means
+ *  anything. Cycle counts on the target come from the BENCHMARKS build (`Benchmark::run_all()`)
+ *  Only the pin levels get checked, the timings are just printed
+ */
+
+#include "host_test.h"
+#include "app_hal_pwm.h"
+#include <algorithm>
+#include <chrono>
+extern "C" {
+	#include "tim.h"
+}
+
+#define BENCH_IRQS 20000 //per round, alternating rollover and compare interrupts
+#define BENCH_ROUNDS 25 //before and after take turns, best round of each counts--the host is noisy
+#define PWM_FREQ 1000.0f
+#define CC_FLAGS (TIM_SR_CC1IF | TIM_SR_CC2IF | TIM_SR_CC3IF | TIM_SR_CC4IF)
+
+//none of these have a TIM2/TIM3 alternate function, so they all run off the ISR
+//group A's four share two ports, group B's sit on a third; every other one is inverted
+static const dio_pin_t bench_pins[NUM_PWM_CHANNELS] = {
+		{PORT_A, 8}, {PORT_A, 9}, {PORT_B, 6}, {PORT_B, 7},
+		{PORT_C, 0}, {PORT_C, 1}, {PORT_C, 2}, {PORT_C, 3}
+};
+static bool bench_inverted(const uint8_t channel) { return channel & 1; }
+
+//============================== THE OLD ISR ==============================
+static const DIO *legacy_pins[NUM_PWM_CHANNELS];
+static bool legacy_inverted[NUM_PWM_CHANNELS];
+static bool legacy_blank[NUM_PWM_CHANNELS];
+static bool legacy_in_use[NUM_PWM_CHANNELS];
+
+#define DEASSERT(index)	legacy_inverted[index] ? legacy_pins[index]->set(): legacy_pins[index]->clear()
+#define ASSERT(index)	legacy_inverted[index] ? legacy_pins[index]->clear(): legacy_pins[index]->set()
+
+//one group's worth of the four unrolled blocks, as they were
+static void __attribute__((noinline, optimize("O3"))) legacy_isr(TIM_TypeDef *tim, const uint8_t base) {
+	uint32_t interrupt_status = tim->SR & tim->DIER;
+	tim->SR = 0;
+
+	if(!legacy_blank[base + 0] && legacy_in_use[base + 0]) {
+		if((interrupt_status & TIM_SR_CC1IF)) DEASSERT(base + 0);
+		else if(interrupt_status & TIM_SR_UIF) ASSERT(base + 0);
+	}
+	if(!legacy_blank[base + 1] && legacy_in_use[base + 1]) {
+		if((interrupt_status & TIM_SR_CC2IF)) DEASSERT(base + 1);
+		else if(interrupt_status & TIM_SR_UIF) ASSERT(base + 1);
+	}
+	if(!legacy_blank[base + 2] && legacy_in_use[base + 2]) {
+		if((interrupt_status & TIM_SR_CC3IF)) DEASSERT(base + 2);
+		else if(interrupt_status & TIM_SR_UIF) ASSERT(base + 2);
+	}
+	if(!legacy_blank[base + 3] && legacy_in_use[base + 3]) {
+		if((interrupt_status & TIM_SR_CC4IF)) DEASSERT(base + 3);
+		else if(interrupt_status & TIM_SR_UIF) ASSERT(base + 3);
+	}
+}
+
+static void legacy_groupA() { legacy_isr(TIM2, 0); }
+static void legacy_groupB() { legacy_isr(TIM3, PWM_CHANNELS_PER_GROUP); }
+
+//============================== HARNESS ==============================
+//one interrupt's worth on every group that has channels: raise the flags, run the ISR
+static double time_isrs(const uint8_t channels, callback_function_t group_a, callback_function_t group_b) {
+	auto start = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < BENCH_IRQS; i++) {
+		uint32_t flags = (i & 1) ? CC_FLAGS : TIM_SR_UIF;
+		TIM2->SR = flags;
+		group_a();
+		if(channels > PWM_CHANNELS_PER_GROUP) {
+			TIM3->SR = flags;
+			group_b();
+		}
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double, std::nano>(elapsed).count() / BENCH_IRQS;
+}
+
+//rollover asserts every channel, the compare deasserts them all again
+static bool pins_follow(const uint8_t channels, const uint32_t flags, const bool asserted) {
+	TIM2->SR = flags;
+	Hard_PWM::isr_groupA();
+	if(channels > PWM_CHANNELS_PER_GROUP) {
+		TIM3->SR = flags;
+		Hard_PWM::isr_groupB();
+	}
+	Sim::sync();
+	for(uint8_t i = 0; i < channels; i++)
+		if(Sim::get_output(bench_pins[i]) != (asserted != bench_inverted(i))) return false;
+	return true;
+}
+
+static void bench(const uint8_t channels) {
+	DIO::init();
+	DIO *pins[NUM_PWM_CHANNELS];
+	Hard_PWM *pwms[NUM_PWM_CHANNELS];
+	for(uint8_t i = 0; i < channels; i++) {
+		pins[i] = new DIO(bench_pins[i]);
+		pwms[i] = new Hard_PWM(*pins[i], bench_inverted(i));
+		legacy_pins[i] = pins[i];
+		legacy_inverted[i] = bench_inverted(i);
+		legacy_blank[i] = false;
+	}
+	for(uint8_t i = 0; i < NUM_PWM_CHANNELS; i++) legacy_in_use[i] = (i < channels);
+	Hard_PWM::configure(PWM_FREQ, MED);
+
+	//nothing but this loop gets to run the ISRs
+	TIM2->CR1 &= ~TIM_CR1_CEN;
+	TIM3->CR1 &= ~TIM_CR1_CEN;
+	NVIC_DisableIRQ(TIM2_IRQn);
+	NVIC_DisableIRQ(TIM3_IRQn);
+
+	CHECK(pins_follow(channels, TIM_SR_UIF, true));
+	CHECK(pins_follow(channels, CC_FLAGS, false));
+
+	double before = 1e9, after = 1e9;
+	for(uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+		before = std::min(before, time_isrs(channels, legacy_groupA, legacy_groupB));
+		after = std::min(after, time_isrs(channels, Hard_PWM::isr_groupA, Hard_PWM::isr_groupB));
+	}
+	printf("  %u channel%s: before %.1fns/irq, after %.1fns/irq (%.2fx)\n",
+			channels, channels == 1 ? "" : "s", before, after, before / after);
+
+	for(uint8_t i = 0; i < channels; i++) {
+		delete pwms[i];
+		delete pins[i];
+	}
+}
+
+TEST(one_channel) { bench(1); }
+TEST(four_channels) { bench(4); }
+TEST(eight_channels) { bench(8); }
+
+HOST_TEST_MAIN()
@@ -0,0 +1,176 @@
+/*
+ * test_hard_pwm_phase.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Hard_PWM phase offsets on the simulated timer: where the edges actually land in the period,
+ *  with `configure()` spreading the phases out (HARD_PWM_SPREAD_PHASES) and with `set_phase()` moving one by hand
+ *  Also built without the spreading (test_hard_pwm_phase_unspread), where a phase set before `configure()` has to stick
+ *  At 1kHz TIM2 counts every 10us, i.e. 1800 CPU cycles per count and 100 counts per period
+ */
+
+// HOST_TEST_DEFINES: HARD_PWM_SPREAD_PHASES=1
+// HOST_TEST_VARIANT unspread: HARD_PWM_SPREAD_PHASES=0
+
+#include "host_test.h"
+#include "app_hal_pwm.h"
+#include <vector>
+extern "C" {
+	#include "tim.h"
+}
+
+#define PWM_FREQ 1000.0f
+#define CYCLES_PER_COUNT 1800ULL
+#define COUNTS_PER_PERIOD 100ULL
+#define CYCLES_PER_PERIOD (CYCLES_PER_COUNT * COUNTS_PER_PERIOD)
+#define PERIODS 3
+
+//none of these have a TIM2/TIM3 alternate function, so they all run off the ISR
+//the board only sets a few of them up as outputs, `outputs()` does the rest (the sim only logs edges on outputs)
+static const dio_pin_t pin_a8 = {PORT_A, 8};
+static const dio_pin_t pin_a9 = {PORT_A, 9};
+static const dio_pin_t pin_b6 = {PORT_B, 6};
+static const dio_pin_t pin_b7 = {PORT_B, 7};
+static const dio_pin_t pin_a0 = {PORT_A, 0}; //TIM2_CH1
+
+static void outputs() {
+	const dio_pin_t pins[] = {pin_a8, pin_a9, pin_b6, pin_b7};
+	for(const dio_pin_t &pin : pins) {
+		GPIO_TypeDef *port = DIO::port_regs(pin.port);
+		port->MODER = (port->MODER & ~(3UL << (pin.pin * 2))) | (1UL << (pin.pin * 2));
+	}
+	Sim::sync();
+}
+
+//cycles (since the timers started) of every edge to `level` on the pin
+static std::vector<uint64_t> edges_to(const dio_pin_t &pin, const bool level, const uint64_t start) {
+	std::vector<uint64_t> cycles;
+	for(const sim_edge_t &edge : Sim::get_edges())
+		if(edge.port == pin.port && edge.pin == pin.pin && edge.level == level) cycles.push_back(edge.cycle - start);
+	return cycles;
+}
+
+//every rising edge lands on the phase count, and the falling edge `duty` counts after it (flipped on inverted pins)
+static bool edges_at(const dio_pin_t &pin, const uint64_t phase_count, const uint64_t duty_count, const uint64_t start,
+		const bool inverted = false) {
+	std::vector<uint64_t> rises = edges_to(pin, !inverted, start);
+	std::vector<uint64_t> falls = edges_to(pin, inverted, start);
+	if(rises.size() < PERIODS - 1 || falls.size() < PERIODS - 1) return false;
+	for(uint64_t rise : rises) {
+		if(rise % CYCLES_PER_PERIOD != phase_count * CYCLES_PER_COUNT) return false;
+		bool fell = false;
+		for(uint64_t fall : falls) fell |= (fall == rise + duty_count * CYCLES_PER_COUNT);
+		if(!fell && rise + duty_count * CYCLES_PER_COUNT < PERIODS * CYCLES_PER_PERIOD) return false;
+	}
+	return true;
+}
+
+#if HARD_PWM_SPREAD_PHASES
+TEST(configure_spreads_the_isr_channels_evenly) {
+	outputs();
+	DIO a8(pin_a8), a9(pin_a9), b6(pin_b6), b7(pin_b7);
+	Hard_PWM pwm_0(a8, false), pwm_1(a9, false), pwm_2(b6, false), pwm_3(b7, false);
+	Hard_PWM::configure(PWM_FREQ, MED);
+	uint64_t start = Sim::get_cycles();
+
+	pwm_0.set(0.1f);
+	pwm_1.set(0.1f);
+	pwm_2.set(0.1f);
+	pwm_3.set(0.1f);
+	Sim::clear_edges();
+	Sim::advance_cycles(PERIODS * CYCLES_PER_PERIOD);
+
+	//four channels, a quarter of the period apart
+	CHECK(edges_at(pin_a8, 0, 10, start));
+	CHECK(edges_at(pin_a9, 25, 10, start));
+	CHECK(edges_at(pin_b6, 50, 10, start));
+	CHECK(edges_at(pin_b7, 75, 10, start));
+	CHECK_EQ(Hard_PWM::get_irq_rate(0, PWM_FREQ), 8 * PWM_FREQ); //both edges of every channel
+}
+
+TEST(hardware_outputs_keep_the_first_slot) {
+	outputs();
+	DIO a8(pin_a8), a0(pin_a0), a9(pin_a9);
+	Hard_PWM pwm_a8(a8, false), pwm_a0(a0, false), pwm_a9(a9, false);
+	Hard_PWM::configure(PWM_FREQ, MED);
+	uint64_t start = Sim::get_cycles();
+	CHECK(pwm_a0.is_hardware_output());
+
+	//the timer output sits at 0, the two ISR channels split the rest of the period
+	pwm_a8.set(0.2f);
+	pwm_a9.set(0.2f);
+	Sim::clear_edges();
+	Sim::advance_cycles(PERIODS * CYCLES_PER_PERIOD);
+	CHECK(edges_at(pin_a8, 33, 20, start));
+	CHECK(edges_at(pin_a9, 66, 20, start));
+}
+
+//phased by the spreading, so 0 and 100% are held by hand
+TEST(zero_and_full_duty_hold_the_pin_without_interrupts) {
+	outputs();
+	DIO a8(pin_a8);
+	Hard_PWM pwm_0(a8, false);
+	Hard_PWM::configure(PWM_FREQ, MED);
+	uint64_t start = Sim::get_cycles();
+
+	pwm_0.set(1.0f);
+	Sim::clear_edges();
+	Sim::advance_cycles(PERIODS * CYCLES_PER_PERIOD);
+	CHECK(Sim::get_output(pin_a8));
+	CHECK_EQ(Sim::get_edges().size(), 0);
+	CHECK_EQ(TIM2->DIER & TIM_DIER_CC1IE, 0);
+
+	Sim::clear_edges();
+	pwm_0.set(0.0f);
+	Sim::advance_cycles(PERIODS * CYCLES_PER_PERIOD);
+	CHECK(!Sim::get_output(pin_a8));
+	CHECK_EQ(Sim::get_edges().size(), 1); //just the one we forced
+
+	//and it picks back up on its phase
+	pwm_0.set(0.4f);
+	Sim::clear_edges();
+	Sim::advance_cycles(PERIODS * CYCLES_PER_PERIOD);
+	CHECK(edges_at(pin_a8, 0, 40, start));
+}
+#else
+TEST(phase_set_before_configure_survives_a_swap) {
+	outputs();
+	MX_TIM2_Init(); //main() does this before the app starts
+	MX_TIM3_Init();
+	DIO a8(pin_a8), a0(pin_a0);
+	Hard_PWM pwm_a8(a8, false), pwm_a0(a0, false); //channels 0 and 1 for now
+	pwm_a8.set(0.3f);
+	pwm_a8.set_phase(0.5f);
+
+	//A0 is TIM2_CH1's output, so it takes channel 0 and A8 gets moved to channel 1--its phase has to go with it
+	Hard_PWM::configure(PWM_FREQ, MED);
+	uint64_t start = Sim::get_cycles();
+	CHECK(pwm_a0.is_hardware_output());
+	CHECK(!pwm_a8.is_hardware_output());
+	CHECK_EQ(Hard_PWM::get_irq_rate(0, PWM_FREQ), 2 * PWM_FREQ); //A8's two edges, no update interrupt
+
+	pwm_a0.set(0.6f);
+	Sim::clear_edges();
+	Sim::advance_cycles(PERIODS * CYCLES_PER_PERIOD);
+	CHECK(edges_at(pin_a8, 50, 30, start));
+	CHECK_EQ(TIM2->DIER & TIM_DIER_CC1IE, 0); //nothing left over on the hardware channel's compare
+}
+#endif
+
+TEST(set_phase_moves_the_rising_edge) {
+	outputs();
+	DIO a8(pin_a8), a9(pin_a9);
+	Hard_PWM pwm_0(a8, false), pwm_1(a9, true);
+	Hard_PWM::configure(PWM_FREQ, MED);
+	uint64_t start = Sim::get_cycles();
+
+	pwm_0.set(0.3f);
+	pwm_1.set(0.5f);
+	pwm_1.set_phase(0.8f); //wraps past the rollover
+	Sim::clear_edges();
+	Sim::advance_cycles(PERIODS * CYCLES_PER_PERIOD);
+	CHECK(edges_at(pin_a8, 0, 30, start));
+	CHECK(edges_at(pin_a9, 80, 50, start, true));
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,231 @@
+/*
+ * test_hard_stop.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Hard stop: the trip takes the step pin away (no step edge after the input, even mid-pulse),
+ *  and re-arming waits for a debounced deassert seen after the trip
+ *  The trip ISR runs in zero time on the sim, so the last step edge can't come any later than the input edge itself
+ */
+
+#include "host_test.h"
+#include "hard_stop.h"
+#include "app_hal_timestamp.h"
+
+#define REARM_MS 5
+#define STEP_PULSE_CYCLES 360 //2us
+#define STEP_PERIOD_CYCLES (SIM_CPU_F_CLK / 10000) //10kHz
+#define TRIP_LATENCY_CYCLES 0 //input edge to the last step edge
+
+//e-stop on the user button (active low with a pull-up), stepping the motor STEP pin
+static DIO *estop_in = NULL;
+static DIO *step_out = NULL;
+static Timer *step_timer = NULL;
+static volatile int32_t position = 0;
+static Hard_Stop *hard_stop = NULL;
+static int32_t trip_on_step = -1; //step that trips the input halfway through its pulse, -1 for none
+static uint64_t trip_cycle = 0;
+
+static void press(bool pressed) {
+	if(pressed) trip_cycle = Sim::get_cycles();
+	Sim::set_input(PinMap::user_button, !pressed);
+}
+
+static void step() {
+	step_out->set();
+	Sim::advance_cycles(STEP_PULSE_CYCLES / 2);
+	if(position == trip_on_step) press(true);
+	Sim::advance_cycles(STEP_PULSE_CYCLES / 2);
+	step_out->clear();
+	position++;
+}
+
+//cycle of the last edge on the step pin (0 if it never moved), and how many of each direction
+static uint64_t last_step_edge(uint32_t *rises = NULL, uint32_t *falls = NULL) {
+	uint64_t last = 0;
+	if(rises) *rises = 0;
+	if(falls) *falls = 0;
+	for(const sim_edge_t &edge : Sim::get_edges()) {
+		if(edge.port != PinMap::mot_step.port || edge.pin != PinMap::mot_step.pin) continue;
+		last = edge.cycle;
+		if(edge.level && rises) (*rises)++;
+		if(!edge.level && falls) (*falls)++;
+	}
+	return last;
+}
+
+//1kHz re-arm sampling, n times
+static void sample(uint32_t n) {
+	for(uint32_t i = 0; i < n; i++) {
+		hard_stop->sample_and_update();
+		Sim::advance_us(1000);
+	}
+}
+
+//fresh hard stop for every test, stepping at 10kHz and NOT tripped
+static void setup() {
+	DIO::init();
+	Timestamp::init();
+	press(false);
+	trip_on_step = -1;
+	if(hard_stop == NULL) {
+		estop_in = new DIO(PinMap::user_button);
+		step_out = new DIO(PinMap::mot_step);
+		step_timer = new Timer(CHANNEL_1);
+		hard_stop = new Hard_Stop(*estop_in, true, REARM_MS);
+	}
+	step_timer->init();
+	step_timer->set_freq(Timer::FREQ_10kHz);
+	step_timer->set_int_priority(HIGH);
+	step_timer->set_callback_func(step);
+	step_timer->enable_int();
+	step_timer->enable_tim();
+
+	hard_stop->attach_step_output(*step_timer, *step_out);
+	hard_stop->attach_position(&position);
+	hard_stop->arm();
+	if(hard_stop->is_tripped()) { //left over from the last test
+		sample(2 * REARM_MS + 1);
+		CHECK(hard_stop->rearm());
+	}
+	step_timer->enable_int();
+	step_timer->enable_tim();
+}
+
+TEST(trip_takes_the_step_pin_away) {
+	setup();
+	CHECK_EQ(Sim::get_mode(PinMap::mot_step), 1);
+	Sim::advance_us(1037); //somewhere between steps
+	CHECK(position > 0);
+
+	press(true);
+	CHECK(hard_stop->is_tripped());
+	CHECK_EQ(Sim::get_mode(PinMap::mot_step), 0); //input, pulled down
+	CHECK(!Sim::is_enabled(TIM1_TRG_COM_TIM11_IRQn)); //the step timer's
+	int32_t latched = hard_stop->get_latched_position();
+	CHECK_EQ(latched, position);
+	CHECK_EQ(hard_stop->get_trip_time(), trip_cycle / 2); //timestamp ticks at 90MHz
+
+	//nothing steps any more: the last edge was the train running right up to the trip
+	Sim::advance_us(1000);
+	CHECK_EQ(position, latched);
+	uint64_t last = last_step_edge();
+	CHECK(last != 0);
+	CHECK(last <= trip_cycle + TRIP_LATENCY_CYCLES);
+	CHECK(trip_cycle - last < STEP_PERIOD_CYCLES);
+	press(false);
+}
+
+TEST(trip_mid_pulse_cuts_the_pulse_short) {
+	setup();
+	Sim::clear_edges();
+	trip_on_step = position + 5;
+	Sim::advance_us(1000);
+	CHECK(hard_stop->is_tripped());
+
+	//the pulse that was high when the input came in never gets its falling edge--the pin isn't ours to drive any more
+	uint32_t rises, falls;
+	uint64_t last = last_step_edge(&rises, &falls);
+	CHECK_EQ(rises, 6);
+	CHECK_EQ(falls, 5);
+	CHECK(last <= trip_cycle + TRIP_LATENCY_CYCLES);
+	CHECK_EQ(trip_cycle - last, STEP_PULSE_CYCLES / 2); //the rising edge of the cut pulse
+	CHECK_EQ(Sim::get_mode(PinMap::mot_step), 0);
+	press(false);
+}
+
+TEST(rearm_ignores_a_deassert_seen_before_the_trip) {
+	setup();
+
+	//the re-arm debouncer has had a long look at the input deasserted
+	sample(50);
+	CHECK(!hard_stop->is_tripped());
+
+	//a short blip trips us, and the input is already deasserted again by the time anyone asks to re-arm
+	press(true);
+	press(false);
+	CHECK(hard_stop->is_tripped());
+	CHECK(!hard_stop->rearm());
+	CHECK_EQ(Sim::get_mode(PinMap::mot_step), 0);
+
+	//the debouncer has to see the deassert after the trip, then it has to hold for the whole re-arm time
+	sample(2 * REARM_MS - 1);
+	CHECK(!hard_stop->rearm());
+	sample(1);
+	CHECK(hard_stop->rearm());
+	CHECK(!hard_stop->is_tripped());
+	CHECK_EQ(Sim::get_mode(PinMap::mot_step), 1);
+	CHECK_EQ(Sim::get_output(PinMap::mot_step), 0);
+}
+
+TEST(a_bounce_restarts_the_rearm_wait) {
+	setup();
+	press(true);
+	press(false);
+	sample(2 * REARM_MS - 1);
+
+	//input asserts again just for one sample--the line is masked while tripped, so only the sampling sees it
+	press(true);
+	sample(1);
+	press(false);
+	sample(REARM_MS - 1);
+	CHECK(!hard_stop->rearm());
+	sample(1);
+	CHECK(hard_stop->rearm());
+}
+
+TEST(rearm_refuses_while_the_raw_input_is_asserted) {
+	setup();
+	press(true);
+	press(false);
+	sample(2 * REARM_MS + 1);
+
+	//asserted again, but no sample has seen it yet
+	press(true);
+	CHECK(!hard_stop->rearm());
+	CHECK(hard_stop->is_tripped());
+	CHECK_EQ(Sim::get_mode(PinMap::mot_step), 0);
+	press(false);
+}
+
+//a trip landing in the middle of a re-arm sample mustn't let that sample count
+static void trip_and_release() {
+	press(true);
+	press(false);
+}
+
+TEST(trip_mid_sample_resets_the_count) {
+	setup();
+	press(true);
+	press(false);
+	sample(2 * REARM_MS);
+	CHECK(hard_stop->rearm());
+
+	//then a fresh trip lands inside a sample's update of the count
+	step_timer->enable_int();
+	step_timer->enable_tim();
+	Sim::preempt_next_ldrex(trip_and_release);
+	hard_stop->sample_and_update();
+	CHECK(hard_stop->is_tripped());
+	CHECK(!hard_stop->rearm());
+
+	sample(2 * REARM_MS - 1);
+	CHECK(!hard_stop->rearm());
+	sample(1);
+	CHECK(hard_stop->rearm());
+}
+
+TEST(attach_after_trip_takes_the_pin_too) {
+	setup();
+	press(true);
+	CHECK(hard_stop->is_tripped());
+
+	//the app re-attaches (say, after a motor swap) while we're tripped--the pin has to stay off the driver
+	GPIO_TypeDef *port = DIO::port_regs(PinMap::mot_step.port);
+	port->MODER |= 1UL << (PinMap::mot_step.pin * 2);
+	hard_stop->attach_step_output(*step_timer, *step_out);
+	CHECK_EQ(Sim::get_mode(PinMap::mot_step), 0);
+	press(false);
+}
+
+HOST_TEST_MAIN()
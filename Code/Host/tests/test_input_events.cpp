@@ -0,0 +1,182 @@
+/*
+ * test_input_events.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Lock-free input event queue: ordering and drop counting with producers preempting each other mid-claim,
+ *  and an edge storm from two nested timer ISRs that overflows the queue while the main context drains it
+ */
+
+#include "host_test.h"
+#include "input_events.h"
+#include "app_hal_timestamp.h"
+#include "app_hal_timing.h"
+#include <vector>
+
+static Input_Event_Queue queue;
+
+static void drain_all() {
+	input_event_t event;
+	while(queue.pop(event));
+	queue.get_dropped();
+}
+
+TEST(events_come_out_in_order) {
+	Timestamp::init();
+	drain_all();
+	for(uint32_t i = 0; i < 10; i++) {
+		Sim::advance_cycles(100);
+		CHECK(queue.push(i, (i & 1) ? INPUT_EDGE_RISING : INPUT_EDGE_FALLING));
+	}
+
+	input_event_t events[16];
+	CHECK_EQ(queue.drain(events, 16), 10);
+	for(uint32_t i = 0; i < 10; i++) {
+		CHECK_EQ(events[i].pin_id, i);
+		CHECK_EQ(events[i].edge, i & 1);
+		CHECK_EQ(events[i].timestamp, (i + 1) * 50); //100 cycles is 50 timer ticks
+	}
+}
+
+//a higher priority producer that lands right inside somebody else's claim
+static void preempting_push() {
+	Sim::advance_cycles(10);
+	queue.push(99, INPUT_EDGE_RISING);
+}
+
+TEST(preempted_producer_keeps_timestamps_in_slot_order) {
+	Timestamp::init();
+	drain_all();
+	Sim::advance_cycles(1000);
+
+	Sim::preempt_next_ldrex(preempting_push);
+	CHECK(queue.push(1, INPUT_EDGE_FALLING));
+
+	input_event_t events[4];
+	CHECK_EQ(queue.drain(events, 4), 2);
+	CHECK_EQ(events[0].pin_id, 99); //the ISR's push beat ours to a slot...
+	CHECK_EQ(events[1].pin_id, 1);
+	CHECK(events[0].timestamp <= events[1].timestamp); //...and to the timestamp
+}
+
+TEST(full_queue_counts_drops) {
+	Timestamp::init();
+	drain_all();
+	for(uint32_t i = 0; i < INPUT_EVENT_QUEUE_SIZE; i++)
+		CHECK(queue.push(i, INPUT_EDGE_RISING));
+	CHECK(!queue.push(0, INPUT_EDGE_RISING));
+	CHECK(!queue.push(0, INPUT_EDGE_RISING));
+	CHECK_EQ(queue.get_dropped(false), 2);
+	CHECK_EQ(queue.get_dropped(), 2);
+	CHECK_EQ(queue.get_dropped(), 0);
+
+	//freeing one slot makes room for exactly one more
+	input_event_t event;
+	CHECK(queue.pop(event));
+	CHECK(queue.push(0, INPUT_EDGE_RISING));
+	CHECK(!queue.push(0, INPUT_EDGE_RISING));
+	drain_all();
+}
+
+static void dropping_push() {
+	queue.push(0, INPUT_EDGE_RISING);
+}
+
+TEST(concurrent_drops_all_get_counted) {
+	Timestamp::init();
+	drain_all();
+	for(uint32_t i = 0; i < INPUT_EVENT_QUEUE_SIZE; i++) queue.push(i, INPUT_EDGE_RISING);
+
+	//the ISR drops an event right inside our drop count's LDREX/STREX (skip the claim's LDREX)
+	Sim::preempt_next_ldrex(dropping_push, 1);
+	CHECK(!queue.push(0, INPUT_EDGE_RISING));
+	CHECK_EQ(queue.get_dropped(), 2);
+
+	//and one that lands inside the consumer clearing the count
+	queue.push(0, INPUT_EDGE_RISING);
+	Sim::preempt_next_ldrex(dropping_push);
+	uint32_t first = queue.get_dropped();
+	uint32_t second = queue.get_dropped();
+	CHECK_EQ(first + second, 2);
+	drain_all();
+}
+
+//edge storm: a MED priority ISR pushes bursts, and a HIGH priority one lands inside the first claim of every burst
+//(plus wherever else its own timer happens to fire); each event's pin ID is its producer and a sequence number
+#define STORM_BURST 8
+#define STORM_BURST_GAP_CYCLES 200
+#define STORM_MS 20
+#define STORM_DRAIN_US 50
+#define STORM_DRAIN_EVENTS 2 //far slower than the ISRs push, so the queue stays full
+#define STORM_SEQ_MASK 0x7F
+
+static std::vector<uint8_t> accepted[2]; //pin IDs the queue took from each producer, in push order
+static uint32_t attempts[2];
+
+static void storm_push(const uint32_t producer) {
+	uint8_t pin_id = (uint8_t)((producer << 7) | (attempts[producer]++ & STORM_SEQ_MASK));
+	if(queue.push(pin_id, (pin_id & 1) ? INPUT_EDGE_RISING : INPUT_EDGE_FALLING)) accepted[producer].push_back(pin_id);
+}
+
+static void storm_high() { storm_push(1); }
+
+static void storm_med() {
+	Sim::preempt_next_ldrex(storm_high);
+	for(uint32_t i = 0; i < STORM_BURST; i++) {
+		storm_push(0);
+		Sim::advance_cycles(STORM_BURST_GAP_CYCLES);
+	}
+}
+
+TEST(edge_storm_from_nested_producers) {
+	Timestamp::init();
+	drain_all();
+	Timer med(CHANNEL_0), high(CHANNEL_1);
+	med.init();
+	med.set_freq(Timer::FREQ_20kHz);
+	med.set_int_priority(MED);
+	med.set_callback_func(storm_med);
+	high.init();
+	high.set_freq(Timer::FREQ_10kHz);
+	high.set_int_priority(HIGH);
+	high.set_callback_func(storm_high);
+	med.enable_int();
+	high.enable_int();
+	med.enable_tim();
+	high.enable_tim();
+
+	std::vector<input_event_t> drained;
+	input_event_t events[STORM_DRAIN_EVENTS];
+	for(uint32_t i = 0; i < STORM_MS * 1000 / STORM_DRAIN_US; i++) {
+		Sim::advance_us(STORM_DRAIN_US);
+		uint32_t count = queue.drain(events, STORM_DRAIN_EVENTS);
+		drained.insert(drained.end(), events, events + count);
+	}
+	med.disable_tim();
+	high.disable_tim();
+	med.disable_int();
+	high.disable_int();
+	input_event_t event;
+	while(queue.pop(event)) drained.push_back(event);
+
+	//way more pushed than fits, and every push either made it out or got counted as a drop
+	CHECK(attempts[0] + attempts[1] > 4 * INPUT_EVENT_QUEUE_SIZE);
+	CHECK(Sim::get_max_depth() >= 2);
+	uint32_t dropped = queue.get_dropped();
+	CHECK(dropped > 0);
+	CHECK_EQ(accepted[0].size() + accepted[1].size() + dropped, attempts[0] + attempts[1]);
+	CHECK_EQ(drained.size(), accepted[0].size() + accepted[1].size());
+
+	//each producer's events come out in the order it pushed them, and timestamps never go backwards
+	std::vector<uint8_t> out[2];
+	for(size_t i = 0; i < drained.size(); i++) {
+		out[drained[i].pin_id >> 7].push_back(drained[i].pin_id);
+		CHECK_EQ(drained[i].edge, drained[i].pin_id & 1);
+		if(i > 0) CHECK(drained[i].timestamp >= drained[i - 1].timestamp);
+	}
+	CHECK(out[0] == accepted[0]);
+	CHECK(out[1] == accepted[1]);
+	CHECK(!accepted[1].empty());
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,151 @@
+/*
+ * test_isr_profiler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  ISR profiler: histogram bucket edges, min/max/total, preempted time coming out of the outer ISR,
+ *  the cycle counter wrapping mid-ISR, and the load figure
+ *  Most of these drive `enter()`/`exit()` by hand with DWT->CYCCNT set to whatever the test wants (the clock never moves,
+ *  so nothing else touches it); the last one profiles real timer ISRs nesting on the simulated clock
+ */
+
+// HOST_TEST_DEFINES: ISR_PROFILING=1
+
+#include "host_test.h"
+#include "app_hal_isr_profiler.h"
+#include "app_hal_timestamp.h"
+#include "app_hal_timing.h"
+
+//one ISR that starts at `start` and leaves at `end` on the cycle counter
+static void profile(const isr_profile_id_t id, const uint32_t start, const uint32_t end) {
+	DWT->CYCCNT = start;
+	isr_profile_ctx_t ctx = ISR_Profiler::enter();
+	DWT->CYCCNT = end;
+	ISR_Profiler::exit(id, ctx);
+}
+
+static void start() {
+	Timestamp::init();
+	ISR_Profiler::init();
+}
+
+TEST(histogram_bucket_edges) {
+	start();
+	//bucket N is [2^N, 2^(N+1)), with 0 cycles lumped in with 1
+	const uint32_t cycles[] = {0, 1, 2, 3, 4, 255, 256, 0x80000000};
+	const uint32_t buckets[] = {0, 0, 1, 1, 2, 7, 8, 31};
+	for(uint32_t cycle : cycles) profile(PROFILE_TIMER_CHAN_0, 1000, 1000 + cycle);
+
+	isr_profile_stats_t stats = ISR_Profiler::get_stats(PROFILE_TIMER_CHAN_0);
+	uint32_t expected[ISR_PROFILE_NUM_BUCKETS] = {0};
+	for(uint32_t bucket : buckets) expected[bucket]++;
+	for(uint32_t i = 0; i < ISR_PROFILE_NUM_BUCKETS; i++) CHECK_EQ(stats.histogram[i], expected[i]);
+
+	CHECK_EQ(stats.count, 8);
+	CHECK_EQ(stats.min_cycles, 0);
+	CHECK_EQ(stats.max_cycles, 0x80000000);
+	CHECK_EQ(stats.total_cycles, 0 + 1 + 2 + 3 + 4 + 255 + 256 + 0x80000000ULL);
+
+	//and it's all gone after a clear
+	ISR_Profiler::clear();
+	stats = ISR_Profiler::get_stats(PROFILE_TIMER_CHAN_0);
+	CHECK_EQ(stats.count, 0);
+	CHECK_EQ(stats.total_cycles, 0);
+	CHECK_EQ(stats.histogram[0], 0);
+}
+
+TEST(nested_isrs_only_count_their_own_time) {
+	start();
+
+	//timer ISR from 1000 to 3000, a PWM ISR on top of it from 1200-1500, which itself gets preempted for 100
+	//then a second PWM ISR at 2000-2050
+	DWT->CYCCNT = 1000;
+	isr_profile_ctx_t outer = ISR_Profiler::enter();
+	DWT->CYCCNT = 1200;
+	isr_profile_ctx_t middle = ISR_Profiler::enter();
+	profile(PROFILE_TIMER_CHAN_1, 1300, 1400);
+	DWT->CYCCNT = 1500;
+	ISR_Profiler::exit(PROFILE_PWM_GROUP_A, middle);
+	profile(PROFILE_PWM_GROUP_A, 2000, 2050);
+	DWT->CYCCNT = 3000;
+	ISR_Profiler::exit(PROFILE_TIMER_CHAN_0, outer);
+
+	isr_profile_stats_t timer = ISR_Profiler::get_stats(PROFILE_TIMER_CHAN_0);
+	isr_profile_stats_t pwm = ISR_Profiler::get_stats(PROFILE_PWM_GROUP_A);
+	isr_profile_stats_t inner = ISR_Profiler::get_stats(PROFILE_TIMER_CHAN_1);
+	CHECK_EQ(inner.total_cycles, 100);
+	CHECK_EQ(pwm.count, 2);
+	CHECK_EQ(pwm.min_cycles, 50);
+	CHECK_EQ(pwm.max_cycles, 200);
+	CHECK_EQ(timer.total_cycles, 2000 - 300 - 50);
+
+	//everything together is exactly the wall time of the outer ISR
+	CHECK_EQ(timer.total_cycles + pwm.total_cycles + inner.total_cycles, 2000);
+}
+
+TEST(cycle_counter_wraps_mid_isr) {
+	start();
+	profile(PROFILE_TIMER_CHAN_2, 0xFFFFFF00, 0x100);
+
+	//the preempted tally wraps too, and still comes out of an ISR that straddles it
+	DWT->CYCCNT = 0xFFFFFFF0;
+	isr_profile_ctx_t outer = ISR_Profiler::enter();
+	profile(PROFILE_TIMER_CHAN_1, 0xFFFFFFF8, 0x8);
+	DWT->CYCCNT = 0x20;
+	ISR_Profiler::exit(PROFILE_TIMER_CHAN_3, outer);
+
+	CHECK_EQ(ISR_Profiler::get_stats(PROFILE_TIMER_CHAN_2).max_cycles, 0x200);
+	CHECK_EQ(ISR_Profiler::get_stats(PROFILE_TIMER_CHAN_2).histogram[9], 1);
+	CHECK_EQ(ISR_Profiler::get_stats(PROFILE_TIMER_CHAN_1).max_cycles, 0x10);
+	CHECK_EQ(ISR_Profiler::get_stats(PROFILE_TIMER_CHAN_3).max_cycles, 0x30 - 0x10);
+}
+
+TEST(load_over_the_time_since_the_clear) {
+	start();
+	profile(PROFILE_PWM_GROUP_B, 0, 45000);
+	Sim::advance_us(1000); //180000 cycles
+	CHECK_EQ(ISR_Profiler::get_load_centipercent(PROFILE_PWM_GROUP_B), 2500);
+	CHECK_EQ(ISR_Profiler::get_load_centipercent(PROFILE_PWM_GROUP_A), 0);
+}
+
+//the real handlers: a long MED priority timer callback that the HIGH one always lands in the middle of
+//the clock keeps going while the fast one runs, so the slow one's own time is what's left of its window after that
+#define SLOW_CYCLES 13500 //75% of its 10kHz period, longer than the fast timer's period so it always gets preempted
+#define FAST_CYCLES 900 //10% of its 20kHz period
+
+static void slow_callback() { Sim::advance_cycles(SLOW_CYCLES); }
+static void fast_callback() { Sim::advance_cycles(FAST_CYCLES); }
+
+TEST(profiles_real_nested_timer_isrs) {
+	start();
+	Timer slow(CHANNEL_0), fast(CHANNEL_1);
+	slow.init();
+	slow.set_freq(Timer::FREQ_10kHz);
+	slow.set_int_priority(MED);
+	slow.set_callback_func(slow_callback);
+	fast.init();
+	fast.set_freq(Timer::FREQ_20kHz);
+	fast.set_int_priority(HIGH);
+	fast.set_callback_func(fast_callback);
+	slow.enable_int();
+	fast.enable_int();
+	slow.enable_tim();
+	fast.enable_tim();
+	Sim::advance_us(1000);
+
+	isr_profile_stats_t slow_stats = ISR_Profiler::get_stats(PROFILE_TIMER_CHAN_0);
+	isr_profile_stats_t fast_stats = ISR_Profiler::get_stats(PROFILE_TIMER_CHAN_1);
+	CHECK_EQ(Sim::get_max_depth(), 2);
+	CHECK(slow_stats.count >= 9);
+	//both start together, so the fast one goes first, then lands once in the middle of every slow one
+	CHECK_EQ(slow_stats.min_cycles, SLOW_CYCLES - FAST_CYCLES);
+	CHECK_EQ(slow_stats.max_cycles, SLOW_CYCLES - FAST_CYCLES);
+	CHECK(fast_stats.count >= 19);
+	CHECK_EQ(fast_stats.min_cycles, FAST_CYCLES);
+	CHECK_EQ(fast_stats.max_cycles, FAST_CYCLES);
+
+	slow.disable_tim();
+	fast.disable_tim();
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,92 @@
+/*
+ * test_load_window.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Sliding load window: running sums as samples age out, wrap reporting, and the partial window before it fills
+ */
+
+#include "host_test.h"
+#include "load_window.h"
+
+#define SLOTS 4
+
+static uint32_t busy_slots[SLOTS], total_slots[SLOTS];
+
+TEST(empty_window_reads_zero) {
+	Load_Window window(busy_slots, total_slots, SLOTS);
+	CHECK_EQ(window.get_load_centipercent(), 0);
+	CHECK_EQ(window.get_busy(), 0);
+	CHECK_EQ(window.get_total(), 0);
+	CHECK(!window.is_full());
+}
+
+TEST(partial_window_averages_what_it_has) {
+	Load_Window window(busy_slots, total_slots, SLOTS);
+	window.push(25, 100);
+	CHECK_EQ(window.get_load_centipercent(), 2500);
+	window.push(75, 100);
+	CHECK_EQ(window.get_load_centipercent(), 5000);
+	CHECK(!window.is_full());
+}
+
+TEST(weights_samples_by_their_total) {
+	Load_Window window(busy_slots, total_slots, SLOTS);
+	window.push(100, 100); //short sample, fully busy
+	window.push(0, 300); //long sample, idle
+	CHECK_EQ(window.get_load_centipercent(), 2500);
+}
+
+TEST(wraps_every_num_slots_pushes) {
+	Load_Window window(busy_slots, total_slots, SLOTS);
+	for(uint32_t lap = 0; lap < 3; lap++) {
+		for(uint32_t i = 0; i < SLOTS - 1; i++) CHECK(!window.push(1, 10));
+		CHECK(window.push(1, 10));
+		CHECK(window.is_full());
+	}
+}
+
+TEST(oldest_sample_ages_out_of_the_sums) {
+	Load_Window window(busy_slots, total_slots, SLOTS);
+	window.push(100, 100);
+	for(uint32_t i = 0; i < SLOTS - 1; i++) window.push(0, 100);
+	CHECK_EQ(window.get_load_centipercent(), 2500);
+	CHECK_EQ(window.get_busy(), 100);
+	CHECK_EQ(window.get_total(), 400);
+
+	//the busy sample is the oldest, so the next push swaps it out
+	window.push(0, 100);
+	CHECK_EQ(window.get_busy(), 0);
+	CHECK_EQ(window.get_total(), 400);
+	CHECK_EQ(window.get_load_centipercent(), 0);
+
+	//and the sums stay exact lap after lap
+	for(uint32_t i = 0; i < 10 * SLOTS; i++) window.push(i % 2 ? 50 : 0, 100);
+	CHECK_EQ(window.get_busy(), 100);
+	CHECK_EQ(window.get_total(), 400);
+}
+
+TEST(sums_dont_overflow_32_bits) {
+	Load_Window window(busy_slots, total_slots, SLOTS);
+	for(uint32_t i = 0; i < SLOTS; i++) window.push(0xC0000000, 0xFFFFFFFF);
+	CHECK_EQ(window.get_total(), 4ULL * 0xFFFFFFFF);
+	CHECK_EQ(window.get_load_centipercent(), 7500);
+}
+
+TEST(clear_starts_over) {
+	Load_Window window(busy_slots, total_slots, SLOTS);
+	for(uint32_t i = 0; i < SLOTS; i++) window.push(10, 10);
+	window.clear();
+	CHECK(!window.is_full());
+	CHECK_EQ(window.get_total(), 0);
+	window.push(0, 10);
+	CHECK_EQ(window.get_load_centipercent(), 0);
+}
+
+TEST(zero_slot_window_ignores_pushes) {
+	Load_Window window(busy_slots, total_slots, 0);
+	CHECK(!window.push(10, 10));
+	CHECK_EQ(window.get_total(), 0);
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,195 @@
+/*
+ * test_port_debouncer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Vertical-counter port debouncer: each pin flips after 4 stable samples, independently of every other pin on the port,
+ *  and gives the same edges as `Debouncer` on a bouncing input, each within one of its sample periods
+ */
+
+#include "host_test.h"
+#include "port_debouncer.h"
+#include "debouncer.h"
+#include "input_events.h"
+#include "app_hal_timestamp.h"
+#include <random>
+#include <vector>
+
+static const dio_pin_t pin0 = {PORT_C, 0};
+static const dio_pin_t pin1 = {PORT_C, 1};
+static const dio_pin_t pin2 = {PORT_C, 2};
+
+//one sample per ms with a 4ms bounce time
+static void sample(PortDebouncer &db, uint32_t n) {
+	for(uint32_t i = 0; i < n; i++) db.sample_and_update();
+}
+
+TEST(flips_after_four_stable_samples) {
+	PortDebouncer db(PORT_C, 0x0001, 4, 0);
+	Sim::set_input(pin0, true);
+	sample(db, 3);
+	CHECK_EQ(db.read_db(), 0);
+	sample(db, 1);
+	CHECK_EQ(db.read_db(), 1);
+	CHECK_EQ(db.get_rising_edges_db(), 1);
+	CHECK_EQ(db.get_rising_edges_db(), 0); //cleared on read
+	CHECK_EQ(db.get_falling_edges_db(), 0);
+
+	Sim::set_input(pin0, false);
+	sample(db, 4);
+	CHECK_EQ(db.read_db(), 0);
+	CHECK_EQ(db.get_falling_edges_db(), 1);
+	CHECK_EQ(db.get_changes_db(), 1);
+}
+
+TEST(glitches_reset_the_counter) {
+	PortDebouncer db(PORT_C, 0x0001, 4, 0);
+	for(uint32_t i = 0; i < 10; i++) {
+		Sim::set_input(pin0, true);
+		sample(db, 3);
+		Sim::set_input(pin0, false);
+		sample(db, 1);
+	}
+	CHECK_EQ(db.read_db(), 0);
+	CHECK_EQ(db.get_changes_db(), 0);
+}
+
+TEST(pins_count_independently) {
+	PortDebouncer db(PORT_C, 0x0007, 4, 0);
+	Sim::set_input(pin0, true);
+	sample(db, 2);
+	Sim::set_input(pin1, true);
+	sample(db, 2);
+	CHECK_EQ(db.read_db(), 0x1); //pin 0 done, pin 1 halfway
+
+	Sim::set_input(pin2, true); //pin 2 starts counting while pin 1 is mid-count
+	sample(db, 2);
+	CHECK_EQ(db.read_db(), 0x3);
+	sample(db, 2);
+	CHECK_EQ(db.read_db(), 0x7);
+	CHECK_EQ(db.get_rising_edges_db(), 0x7);
+}
+
+TEST(masked_pins_are_ignored_and_inverted_pins_flip) {
+	//pin 2 isn't in the mask, pin 1 is active low
+	PortDebouncer db(PORT_C, 0x0003, 4, 0x0002);
+	sample(db, 4);
+	CHECK_EQ(db.read_db(), 0x2); //pin 1 reads low, so it's asserted
+
+	Sim::set_input(pin1, true);
+	Sim::set_input(pin2, true);
+	sample(db, 4);
+	CHECK_EQ(db.read_db(), 0x0);
+	CHECK_EQ(db.get_falling_edges_db(), 0x2);
+}
+
+TEST(bounce_time_sets_the_sample_period) {
+	PortDebouncer db(PORT_C, 0x0001, 20, 0); //5ms between samples
+	Sim::set_input(pin0, true);
+	sample(db, 15);
+	CHECK_EQ(db.read_db(), 0); //samples on calls 0, 5, 10 so far
+	sample(db, 1);
+	CHECK_EQ(db.read_db(), 1); //fourth sample on call 15
+}
+
+TEST(edges_go_into_the_event_queue) {
+	Timestamp::init();
+	static Input_Event_Queue queue;
+	PortDebouncer db(PORT_C, 0x0003, 4, 0);
+	db.set_event_queue(&queue, 10);
+
+	Sim::set_input(pin0, true);
+	Sim::set_input(pin1, true);
+	sample(db, 4);
+	Sim::set_input(pin1, false);
+	sample(db, 4);
+
+	input_event_t events[4];
+	CHECK_EQ(queue.drain(events, 4), 3);
+	CHECK(events[0].pin_id == 10 && events[0].edge == INPUT_EDGE_RISING);
+	CHECK(events[1].pin_id == 11 && events[1].edge == INPUT_EDGE_RISING);
+	CHECK(events[2].pin_id == 11 && events[2].edge == INPUT_EDGE_FALLING);
+}
+
+//an edge accepted by an ISR in the middle of our fetch-and-clear is either returned or left for next time
+static PortDebouncer *isr_db = NULL;
+static void sampling_isr() {
+	sample(*isr_db, 4);
+}
+
+TEST(fetch_and_clear_never_loses_an_edge) {
+	PortDebouncer db(PORT_C, 0x0003, 4, 0);
+	isr_db = &db;
+	Sim::set_input(pin0, true);
+	sample(db, 4);
+	Sim::set_input(pin1, true);
+
+	//the ISR flips pin 1 right between our LDREX and STREX
+	Sim::preempt_next_ldrex(sampling_isr);
+	uint16_t first = db.get_rising_edges_db();
+	uint16_t second = db.get_rising_edges_db();
+	CHECK_EQ(first | second, 0x3);
+	CHECK_EQ(first & second, 0);
+	CHECK_EQ(db.get_rising_edges_db(), 0);
+}
+
+//a seeded bouncing trace: every transition comes with up to 3 extra bounces inside its first 1.5ms,
+//then holds for 30-50ms; stepped every 100us with both debouncers sampling every 1ms
+#define EQ_BOUNCE_MS 8 //2ms between the port debouncer's samples
+#define EQ_SAMPLE_PERIOD_US (EQ_BOUNCE_MS / 4 * 1000)
+#define EQ_STEP_US 100
+#define EQ_BURST_STEPS 15
+#define EQ_TRANSITIONS 20
+#define EQ_SEEDS 8
+
+TEST(matches_debouncer_on_a_bouncing_trace) {
+	DIO pin(pin0);
+	for(uint32_t seed = 1; seed <= EQ_SEEDS; seed++) {
+		Sim::set_input(pin0, false);
+		Debouncer single(pin, EQ_BOUNCE_MS, false);
+		PortDebouncer port(PORT_C, 0x0001, EQ_BOUNCE_MS, 0);
+
+		//steps at which the input toggles
+		std::mt19937 rng(seed);
+		std::vector<uint32_t> toggles;
+		uint32_t step = 50 + rng() % 10;
+		for(uint32_t i = 0; i < EQ_TRANSITIONS; i++) {
+			toggles.push_back(step);
+			uint32_t bounces = rng() % 4;
+			for(uint32_t j = 0; j < 2 * bounces; j++) {
+				step += 1 + rng() % (EQ_BURST_STEPS / (2 * bounces) + 1);
+				toggles.push_back(step);
+			}
+			step += 300 + rng() % 200;
+		}
+
+		std::vector<uint32_t> single_us, port_us;
+		bool level = false;
+		size_t next = 0;
+		for(uint32_t i = 0; i < step + 300; i++) {
+			while(next < toggles.size() && toggles[next] == i) {
+				level = !level;
+				Sim::set_input(pin0, level);
+				next++;
+			}
+			if(i % (1000 / EQ_STEP_US) == 0) {
+				single.sample_and_update();
+				port.sample_and_update();
+				if(single.get_change_db()) single_us.push_back(i * EQ_STEP_US);
+				if(port.get_changes_db()) port_us.push_back(i * EQ_STEP_US);
+			}
+			Sim::advance_us(EQ_STEP_US);
+		}
+
+		//one edge per transition from both, never more than a port sample period apart
+		CHECK_EQ(single_us.size(), EQ_TRANSITIONS);
+		CHECK_EQ(port_us.size(), EQ_TRANSITIONS);
+		for(size_t i = 0; i < single_us.size() && i < port_us.size(); i++) {
+			int32_t diff = (int32_t)port_us[i] - (int32_t)single_us[i];
+			CHECK(diff >= -EQ_SAMPLE_PERIOD_US && diff <= EQ_SAMPLE_PERIOD_US);
+		}
+		CHECK_EQ(single.read_db(), port.read_db());
+	}
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,101 @@
+/*
+ * test_priority_registry.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Deadline-monotonic priority assignment and the response-time analysis, against worked examples
+ */
+
+#include "host_test.h"
+#include "priority_registry.h"
+
+#define OVERHEAD 24 //ISR_OVERHEAD_CYCLES, charged on top of every WCET
+
+//rates that come out to round periods at 180MHz
+#define RATE_1000_CYCLES	180000.0f
+#define RATE_1500_CYCLES	120000.0f
+#define RATE_2500_CYCLES	72000.0f
+
+//three sources at 200/300/500 cycles (with overhead), periods 1000/1500/2500:
+//R1 = 200
+//R2 = 300 + 1*200 = 500
+//R3 = 500 + ceil(R/1000)*200 + ceil(R/1500)*300 -> 500, 1000, 1000
+TEST(textbook_set_is_schedulable) {
+	Priority_Registry::clear();
+	isr_source_t a = Priority_Registry::add_source(RATE_1000_CYCLES, 200 - OVERHEAD);
+	isr_source_t c = Priority_Registry::add_source(RATE_2500_CYCLES, 500 - OVERHEAD);
+	isr_source_t b = Priority_Registry::add_source(RATE_1500_CYCLES, 300 - OVERHEAD);
+	CHECK(Priority_Registry::assign(Priorities::HIGH, Priorities::LOW));
+
+	CHECK_EQ(Priority_Registry::get_priority(a), Priorities::HIGH);
+	CHECK_EQ(Priority_Registry::get_priority(b), Priorities::MED_HIGH);
+	CHECK_EQ(Priority_Registry::get_priority(c), Priorities::MED);
+	CHECK_EQ(Priority_Registry::get_response_cycles(a), 200);
+	CHECK_EQ(Priority_Registry::get_response_cycles(b), 500);
+	CHECK_EQ(Priority_Registry::get_response_cycles(c), 1000);
+	CHECK(Priority_Registry::meets_deadline(c));
+}
+
+//same set with the slowest source at 1400 cycles:
+//R3 = 1400 -> 1400 + 200 + 300 = 1900 -> 1400 + 400 + 600 = 2400... -> 1400 + 600 + 600 = 2600 > 2500
+TEST(overloaded_set_is_rejected) {
+	Priority_Registry::clear();
+	Priority_Registry::add_source(RATE_1000_CYCLES, 200 - OVERHEAD);
+	Priority_Registry::add_source(RATE_1500_CYCLES, 300 - OVERHEAD);
+	isr_source_t c = Priority_Registry::add_source(RATE_2500_CYCLES, 1400 - OVERHEAD);
+	CHECK(!Priority_Registry::assign());
+	CHECK(!Priority_Registry::meets_deadline(c));
+	CHECK(Priority_Registry::get_response_cycles(c) > 2500);
+}
+
+TEST(blocking_adds_to_every_response) {
+	Priority_Registry::clear();
+	isr_source_t a = Priority_Registry::add_source(RATE_1000_CYCLES, 200 - OVERHEAD);
+	isr_source_t b = Priority_Registry::add_source(RATE_1500_CYCLES, 300 - OVERHEAD);
+	Priority_Registry::set_blocking_cycles(100);
+	CHECK(Priority_Registry::assign());
+	CHECK_EQ(Priority_Registry::get_response_cycles(a), 300);
+	CHECK_EQ(Priority_Registry::get_response_cycles(b), 600); //300 + 100 + 200
+}
+
+//a tighter deadline outranks a faster rate, and equal deadlines share a level (and interfere both ways)
+TEST(deadlines_pick_the_order_and_ties_share_a_level) {
+	Priority_Registry::clear();
+	isr_source_t fast = Priority_Registry::add_source(RATE_1000_CYCLES, 100 - OVERHEAD);
+	isr_source_t urgent = Priority_Registry::add_source(RATE_2500_CYCLES, 100 - OVERHEAD, 400);
+	isr_source_t twin = Priority_Registry::add_source(RATE_1500_CYCLES, 100 - OVERHEAD, 400);
+	CHECK(Priority_Registry::assign(Priorities::MED_HIGH, Priorities::LOW));
+	CHECK_EQ(Priority_Registry::get_priority(urgent), Priorities::MED_HIGH);
+	CHECK_EQ(Priority_Registry::get_priority(twin), Priorities::MED_HIGH);
+	CHECK_EQ(Priority_Registry::get_priority(fast), Priorities::MED);
+	CHECK_EQ(Priority_Registry::get_response_cycles(urgent), 200);
+	CHECK_EQ(Priority_Registry::get_response_cycles(fast), 300);
+}
+
+//measured WCETs go in without moving priorities, and can push a set over
+TEST(measured_wcets_are_rechecked_in_place) {
+	Priority_Registry::clear();
+	isr_source_t a = Priority_Registry::add_source(RATE_1000_CYCLES, 200 - OVERHEAD);
+	Priority_Registry::add_source(RATE_1500_CYCLES, 300 - OVERHEAD);
+	isr_source_t c = Priority_Registry::add_source(RATE_2500_CYCLES, 500 - OVERHEAD);
+	CHECK(Priority_Registry::assign());
+
+	Priority_Registry::set_wcet(c, 1400 - OVERHEAD);
+	CHECK_EQ(Priority_Registry::get_wcet_cycles(c), 1400);
+	CHECK(!Priority_Registry::check());
+	CHECK_EQ(Priority_Registry::get_priority(a), Priorities::HIGH);
+	CHECK_EQ(Priority_Registry::get_priority(c), Priorities::MED);
+
+	Priority_Registry::set_wcet(c, 500 - OVERHEAD);
+	CHECK(Priority_Registry::check());
+	CHECK_EQ(Priority_Registry::get_response_cycles(c), 1000);
+}
+
+//a group with no interrupting channels doesn't get a source at all
+TEST(zero_rate_source_is_refused) {
+	Priority_Registry::clear();
+	CHECK_EQ(Priority_Registry::add_source(0, 100), PRIORITY_REGISTRY_INVALID);
+	CHECK_EQ(Priority_Registry::get_priority(PRIORITY_REGISTRY_INVALID), Priorities::LOW);
+}
+
+HOST_TEST_MAIN()
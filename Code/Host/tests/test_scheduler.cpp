@@ -0,0 +1,128 @@
+/*
+ * test_scheduler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Scheduler: most urgent ready task first, event bits merging between runs, a post landing in the middle of `run_once()`,
+ *  and the time spent asleep in WFI going to CPU_Load as idle
+ *  Tasks stay registered across tests, so every test uses its own priorities
+ */
+
+#include "host_test.h"
+#include "scheduler.h"
+#include "cpu_load.h"
+#include "app_hal_timestamp.h"
+#include <vector>
+
+#define SYSTICK_US 1000 //the sim's SysTick wakes WFI every ms
+#define BUSY_US 250
+
+static std::vector<uint32_t> ran; //priority of every task run, in order
+static std::vector<uint32_t> ran_events;
+
+template <uint32_t PRIORITY>
+static void record_task(uint32_t events) {
+	ran.push_back(PRIORITY);
+	ran_events.push_back(events);
+}
+
+static void start() {
+	Timestamp::init();
+	ran.clear();
+	ran_events.clear();
+}
+
+//with nothing ready `run_once()` sleeps until the next interrupt, so the clock moving is how we tell
+static bool slept() {
+	uint64_t before = Sim::get_cycles();
+	Scheduler::run_once();
+	return Sim::get_cycles() != before;
+}
+
+TEST(most_urgent_task_runs_first) {
+	start();
+	CHECK(Scheduler::add_task(5, record_task<5>));
+	CHECK(Scheduler::add_task(12, record_task<12>));
+	CHECK(Scheduler::add_task(31, record_task<31>));
+	CHECK(!Scheduler::add_task(12, record_task<5>)); //taken
+	CHECK(!Scheduler::add_task(SCHEDULER_MAX_TASKS, record_task<5>));
+
+	Scheduler::post(31);
+	Scheduler::post(12);
+	Scheduler::post(5);
+	for(uint32_t i = 0; i < 3; i++) Scheduler::run_once();
+	CHECK_EQ(ran.size(), 3);
+	if(ran.size() == 3) {
+		CHECK_EQ(ran[0], 5);
+		CHECK_EQ(ran[1], 12);
+		CHECK_EQ(ran[2], 31);
+	}
+
+	//a more urgent post jumps the queue even if the other one was there first
+	Scheduler::post(31);
+	Scheduler::post(5);
+	Scheduler::run_once();
+	CHECK_EQ(ran.back(), 5);
+	Scheduler::run_once();
+	CHECK_EQ(ran.back(), 31);
+	CHECK(slept());
+}
+
+TEST(events_merge_until_the_task_runs) {
+	start();
+	CHECK(Scheduler::add_task(7, record_task<7>));
+
+	Scheduler::post(7, 0x1);
+	Scheduler::post(7, 0x4);
+	Scheduler::post(7, 0x1);
+	Scheduler::post(7, 0); //no events, no post
+	Scheduler::run_once();
+	CHECK_EQ(ran.size(), 1);
+	CHECK_EQ(ran_events[0], 0x5);
+
+	//handed over and cleared in one go
+	CHECK(slept());
+	CHECK_EQ(ran.size(), 1);
+
+	Scheduler::post(7, 0x8);
+	Scheduler::run_once();
+	CHECK_EQ(ran_events.back(), 0x8);
+}
+
+static void late_post() { Scheduler::post(9, 0x2); }
+
+TEST(post_between_ready_clear_and_events_swap) {
+	start();
+	CHECK(Scheduler::add_task(9, record_task<9>));
+
+	//first LDREX in `run_once()` clears the ready bit, the second swaps the events out--land in that one
+	Scheduler::post(9, 0x1);
+	Sim::preempt_next_ldrex(late_post, 1);
+	Scheduler::run_once();
+
+	//the swap retries and picks up both posts in the one run
+	CHECK_EQ(ran.size(), 1);
+	CHECK_EQ(ran_events[0], 0x3);
+
+	//the late post set the ready bit again after we'd cleared it: next time round there's nothing to hand over
+	Scheduler::run_once();
+	CHECK_EQ(ran.size(), 1);
+	CHECK(!Sim::get_cycles()); //and that wasn't a sleep
+	CHECK(slept());
+}
+
+TEST(sleep_counts_as_idle) {
+	start();
+	CPU_Load::sample(); //first one just sets the reference point
+
+	//busy for a quarter of each ms, asleep until the SysTick for the rest of it
+	for(uint32_t i = 0; i < CPU_LOAD_SAMPLE_MS; i++) {
+		Sim::advance_us(BUSY_US);
+		CHECK(slept());
+		CHECK_EQ(Sim::get_cycles(), (i + 1) * SYSTICK_US * (SIM_CPU_F_CLK / 1000000));
+	}
+	CPU_Load::sample();
+	CHECK_EQ(CPU_Load::get_load_10ms(), BUSY_US * 10000 / SYSTICK_US);
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,123 @@
+/*
+ * test_sim.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Sanity checks on the simulated chip itself, so a broken model shows up here and not as a mystery in some other test
+ */
+
+#include "host_test.h"
+#include "app_hal_timing.h"
+#include "app_hal_dio.h"
+#include "app_hal_exti.h"
+
+static volatile uint32_t ticks = 0;
+static void count_tick() { ticks++; }
+
+TEST(timer_interrupts_follow_the_virtual_clock) {
+	ticks = 0;
+	Timer tim(CHANNEL_0);
+	tim.init();
+	tim.set_freq(Timer::FREQ_1kHz);
+	tim.set_callback_func(count_tick);
+	tim.set_int_priority(LOW);
+	tim.enable_int();
+	tim.enable_tim();
+
+	Sim::advance_us(100000);
+	CHECK_EQ(ticks, 100);
+	CHECK_EQ(Timer::get_ms(), 100);
+	tim.disable_tim();
+}
+
+TEST(primask_holds_off_interrupts_until_cleared) {
+	ticks = 0;
+	Timer tim(CHANNEL_1);
+	tim.init();
+	tim.set_freq(Timer::FREQ_10kHz);
+	tim.set_callback_func(count_tick);
+	tim.enable_int();
+	tim.enable_tim();
+
+	__disable_irq();
+	Sim::advance_us(1000);
+	CHECK_EQ(ticks, 0);
+	CHECK(Sim::is_pending(TIM1_TRG_COM_TIM11_IRQn));
+	__enable_irq();
+	CHECK_EQ(ticks, 1); //a level source only pends once no matter how many events it missed
+	tim.disable_tim();
+}
+
+TEST(gpio_writes_land_and_get_logged) {
+	DIO::init();
+	DIO led(PinMap::status_led);
+	Sim::clear_edges();
+
+	led.set();
+	Sim::advance_cycles(100);
+	led.clear();
+	Sim::sync();
+
+	const std::vector<sim_edge_t> &edges = Sim::get_edges();
+	CHECK_EQ(edges.size(), 2);
+	if(edges.size() == 2) {
+		CHECK(edges[0].level && !edges[1].level);
+		CHECK_EQ(edges[1].cycle - edges[0].cycle, 100);
+	}
+	CHECK(!Sim::get_output(PinMap::status_led));
+}
+
+TEST(inputs_read_back_their_pull_until_driven) {
+	DIO::init();
+	DIO button(PinMap::user_button);
+	CHECK(button.read()); //pull-up
+	Sim::set_input(PinMap::user_button, false);
+	CHECK(!button.read());
+}
+
+static volatile uint32_t inner_runs = 0;
+static void inner() { inner_runs++; }
+
+TEST(ldrex_window_sees_preemption) {
+	volatile uint32_t word = 0;
+	Sim::preempt_next_ldrex(inner);
+	uint32_t value = __LDREXW(&word);
+	CHECK_EQ(inner_runs, 1);
+	CHECK(__STREXW(value + 1, &word) != 0); //the interrupt broke the reservation
+	value = __LDREXW(&word);
+	CHECK(__STREXW(value + 1, &word) == 0);
+	CHECK_EQ(word, 1);
+}
+
+//a slow low priority callback gets preempted by a faster high priority one
+static void slow_tick() {
+	ticks++;
+	Sim::advance_us(300);
+}
+
+TEST(higher_priority_interrupts_nest) {
+	ticks = 0;
+	inner_runs = 0;
+	Timer slow(CHANNEL_0), fast(CHANNEL_1);
+	slow.init();
+	fast.init();
+	slow.set_freq(Timer::FREQ_1kHz);
+	fast.set_freq(Timer::FREQ_10kHz);
+	slow.set_callback_func(slow_tick);
+	fast.set_callback_func(inner);
+	slow.set_int_priority(LOW);
+	fast.set_int_priority(HIGH);
+	slow.enable_int();
+	fast.enable_int();
+	slow.enable_tim();
+	fast.enable_tim();
+
+	Sim::advance_us(9500);
+	CHECK_EQ(ticks, 9);
+	CHECK_EQ(inner_runs, 95);
+	CHECK_EQ(Sim::get_max_depth(), 2);
+	slow.disable_tim();
+	fast.disable_tim();
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,166 @@
+/*
+ * test_soft_timer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Timing wheel: every timer has to fire on exactly the tick it was armed for, across every level and cascade boundary
+ *  The wheel is static, so every test works relative to wherever the wheel has got to
+ */
+
+#include "host_test.h"
+#include "soft_timer.h"
+#include <stdlib.h>
+
+#define NUM_RANDOM_TIMERS 200
+
+static uint32_t fired_at[NUM_RANDOM_TIMERS];
+static uint32_t fire_count[NUM_RANDOM_TIMERS];
+
+//one callback per timer so we know which one fired--generated rather than written out
+template<uint32_t N> static void record() {
+	fired_at[N] = Soft_Timer::get_ticks();
+	fire_count[N]++;
+}
+
+template<uint32_t... N> struct callback_table {
+	static constexpr callback_function_t table[] = {record<N>...};
+};
+
+template<uint32_t COUNT, uint32_t... N> struct make_table : make_table<COUNT - 1, COUNT - 1, N...> {};
+template<uint32_t... N> struct make_table<0, N...> : callback_table<N...> {};
+
+static const callback_function_t *callbacks = make_table<NUM_RANDOM_TIMERS>::table;
+
+static void clear_records() {
+	for(uint32_t i = 0; i < NUM_RANDOM_TIMERS; i++) {
+		fired_at[i] = 0;
+		fire_count[i] = 0;
+	}
+}
+
+static void run_ticks(uint32_t n) {
+	for(uint32_t i = 0; i < n; i++) Soft_Timer::tick();
+}
+
+TEST(oneshot_fires_on_exact_tick_across_levels) {
+	//around every level boundary, plus the very top of the range
+	static const uint32_t delays[] = {1, 2, 63, 64, 65, 127, 128, 4095, 4096, 4097, 262143, 262144, 262145};
+	const uint32_t n = sizeof(delays) / sizeof(delays[0]);
+
+	//try it from a few different spots in the wheel so the slot indices wrap differently
+	for(uint32_t offset = 0; offset < 3; offset++) {
+		run_ticks(offset * 37 + 1);
+		clear_records();
+		Soft_Timer *timers[n];
+		uint32_t start = Soft_Timer::get_ticks();
+		for(uint32_t i = 0; i < n; i++) {
+			timers[i] = new Soft_Timer(callbacks[i]);
+			timers[i]->arm_oneshot(delays[i]);
+		}
+
+		run_ticks(262145 + 64);
+		for(uint32_t i = 0; i < n; i++) {
+			CHECK_EQ(fire_count[i], 1);
+			CHECK_EQ(fired_at[i] - start, delays[i]);
+			CHECK(!timers[i]->is_armed());
+			delete timers[i];
+		}
+	}
+}
+
+TEST(random_delays_from_random_start_points) {
+	srand(1234);
+	clear_records();
+	Soft_Timer *timers[NUM_RANDOM_TIMERS];
+	uint32_t expected[NUM_RANDOM_TIMERS];
+	for(uint32_t i = 0; i < NUM_RANDOM_TIMERS; i++) {
+		run_ticks(rand() % 100);
+		uint32_t delay = 1 + rand() % 20000;
+		timers[i] = new Soft_Timer(callbacks[i]);
+		timers[i]->arm_oneshot(delay);
+		expected[i] = Soft_Timer::get_ticks() + delay;
+	}
+
+	run_ticks(20000);
+	for(uint32_t i = 0; i < NUM_RANDOM_TIMERS; i++) {
+		CHECK_EQ(fire_count[i], 1);
+		CHECK_EQ(fired_at[i], expected[i]);
+		delete timers[i];
+	}
+}
+
+TEST(periodic_timers_dont_drift) {
+	clear_records();
+	Soft_Timer fast(callbacks[0]), slow(callbacks[1]);
+	fast.arm_periodic(3);
+	slow.arm_periodic(1000);
+	uint32_t start = Soft_Timer::get_ticks();
+
+	run_ticks(10000);
+	CHECK_EQ(fire_count[0], 3333);
+	CHECK_EQ(fire_count[1], 10);
+	CHECK_EQ(fired_at[1] - start, 10000);
+	CHECK(fast.is_armed() && slow.is_armed());
+}
+
+TEST(clamps_out_of_range_delays) {
+	clear_records();
+	Soft_Timer zero(callbacks[0]);
+	zero.arm_oneshot(0);
+	uint32_t start = Soft_Timer::get_ticks();
+	run_ticks(1);
+	CHECK_EQ(fire_count[0], 1);
+	CHECK_EQ(fired_at[0] - start, 1);
+
+	Soft_Timer huge(callbacks[1]);
+	huge.arm_oneshot(0xFFFFFFFF);
+	start = Soft_Timer::get_ticks();
+	run_ticks(SOFT_TIMER_MAX_TICKS);
+	CHECK_EQ(fire_count[1], 1);
+	CHECK_EQ(fired_at[1] - start, SOFT_TIMER_MAX_TICKS);
+}
+
+TEST(cancel_and_rearm) {
+	clear_records();
+	Soft_Timer a(callbacks[0]), b(callbacks[1]);
+	a.arm_oneshot(100);
+	b.arm_oneshot(100);
+	a.cancel();
+	CHECK(!a.is_armed());
+
+	run_ticks(50);
+	uint32_t rearmed = Soft_Timer::get_ticks();
+	b.arm_oneshot(5000); //moves it rather than adding a second copy
+	run_ticks(6000);
+	CHECK_EQ(fire_count[0], 0);
+	CHECK_EQ(fire_count[1], 1);
+	CHECK_EQ(fired_at[1] - rearmed, 5000);
+}
+
+//callbacks can arm and cancel timers, including ones due on the same tick
+static Soft_Timer *victim = NULL;
+static Soft_Timer *follow_up = NULL;
+static void cancel_victim() {
+	record<2>();
+	victim->cancel();
+	follow_up->arm_oneshot(1);
+}
+
+TEST(callbacks_can_cancel_timers_due_on_the_same_tick) {
+	clear_records();
+	Soft_Timer first(cancel_victim), second(callbacks[0]), third(callbacks[1]);
+	victim = &second;
+	follow_up = &third;
+
+	//the slot is a stack, so arm the canceller last to have it run first
+	second.arm_oneshot(10);
+	first.arm_oneshot(10);
+	uint32_t start = Soft_Timer::get_ticks();
+	run_ticks(20);
+	CHECK_EQ(fire_count[2], 1);
+	CHECK_EQ(fire_count[0], 0);
+	CHECK_EQ(fire_count[1], 1);
+	CHECK_EQ(fired_at[1] - start, 11);
+}
+
+HOST_TEST_MAIN()
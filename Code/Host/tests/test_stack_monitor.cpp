@@ -0,0 +1,161 @@
+/*
+ * test_stack_monitor.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Stack monitor: the high-water scan over the painted region, the nesting depth and priorities the handlers record
+ *  (including handlers that never sample themselves), and the telemetry lines
+ *  The host link puts _estack at 0x20020000 with a 0x400 byte stack, same layout as the .ld
+ */
+
+#include "host_test.h"
+#include "app_hal_stack_monitor.h"
+#include "app_hal_timing.h"
+#include <string>
+extern "C" {
+	#include "usart.h"
+}
+
+#define STACK_TOP	0x20020000UL
+#define STACK_SIZE	0x400UL
+
+static void scribble(const uint32_t bytes_from_top) {
+	*(volatile uint32_t*)(STACK_TOP - bytes_from_top) = 0;
+}
+
+TEST(paint_stops_short_of_the_live_stack) {
+	Sim::set_msp(STACK_TOP - 0x100);
+	stack_paint();
+	CHECK_EQ(Stack_Monitor::get_size(), STACK_SIZE);
+	CHECK_EQ(Stack_Monitor::get_high_water(), 0x100 + STACK_PAINT_MARGIN_WORDS * 4);
+	CHECK_EQ(*(volatile uint32_t*)(STACK_TOP - STACK_SIZE), STACK_PAINT_PATTERN);
+}
+
+TEST(mark_only_ever_moves_down) {
+	Sim::set_msp(STACK_TOP - 0x100);
+	stack_paint();
+	scribble(0x300);
+	CHECK_EQ(Stack_Monitor::get_high_water(), 0x300);
+
+	//a shallower write, or the deep one getting repainted by somebody, doesn't bring it back up
+	scribble(0x200);
+	*(volatile uint32_t*)(STACK_TOP - 0x300) = STACK_PAINT_PATTERN;
+	CHECK_EQ(Stack_Monitor::get_high_water(), 0x300);
+}
+
+TEST(blowing_the_bottom_reads_as_the_full_size) {
+	Sim::set_msp(STACK_TOP - 0x100);
+	stack_paint();
+	scribble(STACK_SIZE);
+	CHECK_EQ(Stack_Monitor::get_high_water(), STACK_SIZE);
+}
+
+TEST(thread_mode_samples_nothing) {
+	Stack_Monitor::clear_nesting();
+	Stack_Monitor::sample_nesting();
+	uint32_t priorities = 0xFFFF;
+	CHECK_EQ(Stack_Monitor::get_max_nesting(&priorities), 0);
+	CHECK_EQ(priorities, 0);
+}
+
+//a slow low priority callback that a fast high priority one lands on top of
+static void slow_tick() { Sim::advance_us(300); }
+static void fast_tick() {}
+
+TEST(nested_timer_handlers_record_depth_and_priorities) {
+	Stack_Monitor::clear_nesting();
+	Timer slow(CHANNEL_0), fast(CHANNEL_1);
+	slow.init();
+	fast.init();
+	slow.set_freq(Timer::FREQ_1kHz);
+	fast.set_freq(Timer::FREQ_10kHz);
+	slow.set_callback_func(slow_tick);
+	fast.set_callback_func(fast_tick);
+	slow.set_int_priority(LOW);
+	fast.set_int_priority(HIGH);
+	slow.enable_int();
+	fast.enable_int();
+	slow.enable_tim();
+	fast.enable_tim();
+
+	Sim::advance_us(2500);
+	slow.disable_tim();
+	fast.disable_tim();
+
+	uint32_t priorities;
+	CHECK_EQ(Stack_Monitor::get_max_nesting(&priorities), 2);
+	CHECK_EQ(priorities, (1UL << LOW) | (1UL << HIGH));
+	CHECK_EQ(Stack_Monitor::get_max_nesting(&priorities), Sim::get_max_depth());
+
+	//the record sticks around once the nest has unwound, until it's cleared
+	Stack_Monitor::clear_nesting();
+	CHECK_EQ(Stack_Monitor::get_max_nesting(NULL), 0);
+}
+
+TEST(handlers_that_dont_sample_still_count) {
+	Stack_Monitor::clear_nesting();
+
+	//pretend USART2 and SVCall are both active underneath us--neither of them samples
+	NVIC_SetPriority(USART2_IRQn, 7);
+	NVIC_SetPriority(SVCall_IRQn, 9);
+	NVIC->IABR[USART2_IRQn >> 5] |= 1UL << (USART2_IRQn & 0x1F);
+	SCB->SHCSR |= SCB_SHCSR_SVCALLACT_Msk;
+
+	//then a timer handler lands on top and does
+	Timer fast(CHANNEL_1);
+	fast.init();
+	fast.set_freq(Timer::FREQ_10kHz);
+	fast.set_callback_func(fast_tick);
+	fast.set_int_priority(HIGH);
+	fast.enable_int();
+	fast.enable_tim();
+	Sim::advance_us(150);
+	fast.disable_tim();
+
+	uint32_t priorities;
+	CHECK_EQ(Stack_Monitor::get_max_nesting(&priorities), 3);
+	CHECK_EQ(priorities, (1UL << 9) | (1UL << 7) | (1UL << HIGH));
+}
+
+TEST(only_a_deeper_nest_replaces_the_record) {
+	Stack_Monitor::clear_nesting();
+	NVIC_SetPriority(TIM2_IRQn, MED);
+	NVIC_SetPriority(TIM3_IRQn, HIGH);
+	NVIC_SetPriority(USART2_IRQn, LOW);
+
+	NVIC->IABR[0] |= 1UL << TIM2_IRQn;
+	NVIC->IABR[0] |= 1UL << TIM3_IRQn;
+	Stack_Monitor::sample_nesting();
+
+	//same depth, different priorities: the first one stays
+	NVIC->IABR[0] &= ~(1UL << TIM2_IRQn);
+	NVIC->IABR[USART2_IRQn >> 5] |= 1UL << (USART2_IRQn & 0x1F);
+	Stack_Monitor::sample_nesting();
+
+	uint32_t priorities;
+	CHECK_EQ(Stack_Monitor::get_max_nesting(&priorities), 2);
+	CHECK_EQ(priorities, (1UL << MED) | (1UL << HIGH));
+}
+
+TEST(report_lines) {
+	Sim::set_msp(STACK_TOP - 0x100);
+	stack_paint();
+	scribble(0x300);
+
+	Stack_Monitor::clear_nesting();
+	NVIC_SetPriority(TIM2_IRQn, MED);
+	NVIC->IABR[0] |= 1UL << TIM2_IRQn;
+	SCB->SHCSR |= SCB_SHCSR_PENDSVACT_Msk;
+	NVIC_SetPriority(PendSV_IRQn, 15);
+	Stack_Monitor::sample_nesting();
+
+	//unwind, so the SysTicks that come in while the report goes out don't stack on top of it
+	NVIC->IABR[0] &= ~(1UL << TIM2_IRQn);
+	SCB->SHCSR &= ~SCB_SHCSR_PENDSVACT_Msk;
+
+	Sim::uart_output().clear();
+	Stack_Monitor::report(&huart2);
+	CHECK(Sim::uart_output() == "stack,768,1024\r\nnesting,2,0x8008\r\n");
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,71 @@
+/*
+ * test_timer_group.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  TimerGroup phase math, and phased timers started as a group keeping their offsets on the virtual clock
+ */
+
+#include "host_test.h"
+#include "app_hal_timing.h"
+
+TEST(seed_is_the_phase_rounded_to_a_tick) {
+	CHECK_EQ(TimerGroup::phase_seed(0.0f, 8999, 9, 0), 0);
+	CHECK_EQ(TimerGroup::phase_seed(0.25f, 8999, 9, 0), 2250);
+	CHECK_EQ(TimerGroup::phase_seed(0.5f, 99, 0, 0), 50);
+	CHECK_EQ(TimerGroup::phase_seed(1.0f / 3.0f, 99, 0, 0), 33);
+	CHECK_EQ(TimerGroup::phase_seed(2.0f / 3.0f, 99, 0, 0), 67); //rounds, doesn't truncate
+}
+
+TEST(lag_rounds_to_the_nearest_prescaled_tick) {
+	//no prescaler: 2 CPU cycles per tick
+	CHECK_EQ(TimerGroup::phase_seed(0.0f, 449, 0, 8), 4);
+	CHECK_EQ(TimerGroup::phase_seed(0.0f, 449, 0, 9), 5);
+	CHECK_EQ(TimerGroup::phase_seed(0.0f, 449, 0, 1), 1);
+
+	//PSC 9: 20 CPU cycles per tick, so a short lag rounds away
+	CHECK_EQ(TimerGroup::phase_seed(0.0f, 8999, 9, 9), 0);
+	CHECK_EQ(TimerGroup::phase_seed(0.0f, 8999, 9, 10), 1);
+	CHECK_EQ(TimerGroup::phase_seed(0.0f, 8999, 9, 30), 2);
+}
+
+TEST(seed_wraps_within_the_period) {
+	CHECK_EQ(TimerGroup::phase_seed(0.999f, 99, 0, 0), 0);
+	CHECK_EQ(TimerGroup::phase_seed(0.99f, 99, 0, 4), 1);
+}
+
+static uint64_t fire_time[2][4];
+static uint32_t fire_count[2];
+static void fired_0() { if(fire_count[0] < 4) fire_time[0][fire_count[0]] = Sim::get_cycles(); fire_count[0]++; }
+static void fired_1() { if(fire_count[1] < 4) fire_time[1][fire_count[1]] = Sim::get_cycles(); fire_count[1]++; }
+
+TEST(group_keeps_phase_offsets) {
+	fire_count[0] = fire_count[1] = 0;
+	Timer a(CHANNEL_0), b(CHANNEL_1);
+	a.init();
+	b.init();
+	a.set_freq(Timer::FREQ_1kHz);
+	b.set_freq(Timer::FREQ_1kHz);
+	a.set_phase(0.0f);
+	b.set_phase(0.25f); //a quarter period ahead
+	a.set_callback_func(fired_0);
+	b.set_callback_func(fired_1);
+	a.enable_int();
+	b.enable_int();
+
+	Timer *timers[] = {&a, &b};
+	TimerGroup group(timers, 2);
+	group.start();
+	Sim::advance_us(3500);
+
+	CHECK_EQ(fire_count[0], 3);
+	CHECK_EQ(fire_count[1], 3);
+	const uint64_t period = SIM_CPU_F_CLK / 1000;
+	for(uint32_t i = 0; i < 3; i++) {
+		CHECK_EQ(fire_time[0][i] - fire_time[1][i], period / 4);
+		CHECK_EQ(fire_time[0][i], (i + 1) * period);
+	}
+	group.stop();
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,173 @@
+/*
+ * test_timer_overrun.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Timer deadline bookkeeping: entry latency, completion time, and overruns when a callback outlasts its period,
+ *  including ones that keep PendSV out for as long as they last
+ */
+
+#include "host_test.h"
+#include "app_hal_timing.h"
+#include "app_hal_deferred.h"
+
+static uint32_t callback_us = 0; //how long the callback "takes" on the virtual clock
+static uint32_t calls = 0;
+static uint32_t degrade_calls = 0;
+
+static void busy_callback() {
+	calls++;
+	Sim::advance_us(callback_us);
+}
+
+static void degrade() {
+	degrade_calls++;
+	callback_us = 0; //shed the work
+}
+
+static void setup(Timer &tim, bool deferred = false) {
+	calls = 0;
+	degrade_calls = 0;
+	Deferred_Work::init();
+	tim.init();
+	tim.set_freq(Timer::FREQ_10kHz); //100us period, 9000 ticks
+	tim.set_callback_func(busy_callback);
+	tim.set_overrun_func(degrade, deferred);
+	tim.set_int_priority(MED);
+	tim.clear_overrun_stats();
+	tim.enable_int();
+}
+
+TEST(completion_time_tracks_the_callback) {
+	Timer tim(CHANNEL_0);
+	setup(tim);
+	callback_us = 40;
+	tim.enable_tim();
+	Sim::advance_us(1000);
+	tim.disable_tim();
+
+	timer_overrun_stats_t stats = tim.get_overrun_stats();
+	CHECK_EQ(calls, 10);
+	CHECK_EQ(stats.overruns, 0);
+	CHECK_EQ(stats.worst_latency, 0);
+	CHECK_EQ(stats.worst_completion, 40 * 90);
+	CHECK_EQ(degrade_calls, 0);
+}
+
+TEST(latency_counts_time_spent_masked) {
+	Timer tim(CHANNEL_0);
+	setup(tim);
+	callback_us = 0;
+	tim.enable_tim();
+	__disable_irq();
+	Sim::advance_us(110); //compare event at 100us, we get there 10us late
+	__enable_irq();
+	tim.disable_tim();
+
+	timer_overrun_stats_t stats = tim.get_overrun_stats();
+	CHECK_EQ(calls, 1);
+	CHECK_EQ(stats.worst_latency, 10 * 90);
+}
+
+TEST(overrun_is_counted_and_the_app_told) {
+	Timer tim(CHANNEL_0);
+	setup(tim);
+	callback_us = 150; //longer than the 100us period
+	tim.enable_tim();
+	Sim::advance_us(1000);
+	tim.disable_tim();
+
+	timer_overrun_stats_t stats = tim.get_overrun_stats();
+	CHECK_EQ(stats.overruns, 1);
+	CHECK_EQ(degrade_calls, 1);
+	CHECK(stats.worst_completion > 9000); //over a whole period
+	CHECK(calls >= 9); //the missed compare still got serviced, and things recovered after the degrade
+}
+
+//one long callback, then it sheds the work on its own--deferring the degrade is fine when the overrun can't persist
+static void one_long_callback() {
+	calls++;
+	Sim::advance_us(callback_us);
+	callback_us = 0;
+}
+
+TEST(deferred_overrun_runs_from_pendsv) {
+	Timer tim(CHANNEL_0);
+	setup(tim, true);
+	tim.set_callback_func(one_long_callback);
+	callback_us = 150;
+	tim.enable_tim();
+	Sim::advance_us(1000);
+	tim.disable_tim();
+
+	timer_overrun_stats_t stats = tim.get_overrun_stats();
+	CHECK_EQ(stats.overruns, 1);
+	CHECK_EQ(degrade_calls, 1);
+	CHECK_EQ(stats.dropped_samples, 0);
+}
+
+//a long, low priority ISR keeps PendSV out, so the fast channel's samples pile up until there's no room left
+static void long_low_priority_isr() {
+	Sim::advance_us(2000);
+}
+
+TEST(samples_pile_up_while_pendsv_is_held_off) {
+	Timer tim(CHANNEL_0);
+	setup(tim);
+	callback_us = 10;
+	tim.set_int_priority(HIGH);
+	tim.enable_int();
+
+	static Timer blocker(CHANNEL_1);
+	blocker.init();
+	blocker.set_freq(Timer::FREQ_100Hz);
+	blocker.set_callback_func(long_low_priority_isr);
+	blocker.set_int_priority(LOW);
+	blocker.enable_int();
+
+	tim.enable_tim();
+	blocker.enable_tim();
+	Sim::advance_us(10000); //blocker fires at 10ms, runs to 12ms
+	blocker.disable_int();
+	blocker.disable_tim();
+	Sim::advance_us(1000);
+	tim.disable_tim();
+
+	//the 21 periods from 10ms to 12ms (the one at 10ms beats the blocker in, but its tally doesn't) only had room for TIMER_STATS_DEPTH samples
+	timer_overrun_stats_t stats = tim.get_overrun_stats();
+	CHECK_EQ(stats.dropped_samples, 21 - TIMER_STATS_DEPTH);
+	CHECK_EQ(stats.overruns, 0);
+	CHECK_EQ(stats.worst_completion, 10 * 90);
+}
+
+//overruns back to back for a while--PendSV can't get in until it stops, but every one of them still has to be counted
+#define PERSISTENT_OVERRUNS 20
+static void keeps_overrunning() {
+	calls++;
+	Sim::advance_us((calls <= PERSISTENT_OVERRUNS) ? 150 : 10);
+}
+static void ignore_overrun() {}
+
+TEST(persistent_overruns_all_get_counted) {
+	Timer tim(CHANNEL_0);
+	setup(tim);
+	tim.set_callback_func(keeps_overrunning);
+	tim.set_overrun_func(ignore_overrun);
+	tim.enable_tim();
+	Sim::advance_us(5000);
+	tim.disable_tim();
+
+	//the sample ring only held the first few, the rest only made it into the counts
+	//(the last overrun leaves its flag set, so the short call after it runs back to back with them too)
+	timer_overrun_stats_t stats = tim.get_overrun_stats();
+	CHECK_EQ(stats.overruns, PERSISTENT_OVERRUNS);
+	CHECK_EQ(stats.dropped_samples, PERSISTENT_OVERRUNS + 1 - TIMER_STATS_DEPTH);
+	CHECK(stats.worst_completion > 9000);
+
+	tim.clear_overrun_stats();
+	stats = tim.get_overrun_stats();
+	CHECK_EQ(stats.overruns, 0);
+	CHECK_EQ(stats.dropped_samples, 0);
+}
+
+HOST_TEST_MAIN()
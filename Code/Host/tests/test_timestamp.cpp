@@ -0,0 +1,93 @@
+/*
+ * test_timestamp.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  64-bit extension of TIM5: wraps get counted exactly once, no matter who notices them or gets preempted doing so
+ */
+
+#include "host_test.h"
+#include "app_hal_timestamp.h"
+
+#define WRAP_TICKS (1ULL << 32)
+
+TEST(counts_at_the_timer_clock) {
+	Timestamp::init();
+	Sim::advance_us(1000);
+	CHECK_EQ(Timestamp::now_ticks(), 90000);
+	CHECK_EQ(Timestamp::now_us(), 1000);
+	CHECK_EQ(Timestamp::now_ns(), 1000000);
+}
+
+TEST(extends_across_wraps) {
+	Timestamp::init();
+	TIM5->CNT = 0xFFFFFF00UL;
+	uint64_t before = Timestamp::now_ticks();
+	CHECK_EQ(before, 0xFFFFFF00ULL);
+
+	Sim::advance_cycles(2 * 0x200); //0x200 timer ticks, over the wrap
+	uint64_t after = Timestamp::now_ticks();
+	CHECK_EQ(after, WRAP_TICKS + 0x100);
+
+	//reading again doesn't count the same wrap twice
+	CHECK_EQ(Timestamp::now_ticks(), after);
+}
+
+TEST(keepalive_carries_it_through_long_gaps) {
+	Timestamp::init();
+	//nobody reads it for ~3 wraps except the SysTick keepalive
+	const uint64_t seconds = 150;
+	Sim::advance_us(seconds * 1000000);
+	CHECK_EQ(Timestamp::now_ticks(), seconds * Timestamp::get_tick_freq());
+}
+
+//without the keepalive, a single gap over half a period still can't double count
+TEST(a_read_per_half_period_is_enough) {
+	Timestamp::init();
+	uint64_t last = 0;
+	for(uint32_t i = 0; i < 10; i++) {
+		TIM5->CNT += 0x7FFFFFFFUL;
+		uint64_t now = Timestamp::now_ticks();
+		CHECK(now > last);
+		CHECK_EQ(now - last, 0x7FFFFFFFULL);
+		last = now;
+	}
+}
+
+//an ISR that reads the timestamp right inside our LDREX/STREX window
+static uint64_t isr_read = 0;
+static void reading_isr() {
+	isr_read = Timestamp::now_ticks();
+}
+
+TEST(preempted_publish_counts_the_wrap_once) {
+	Timestamp::init();
+	TIM5->CNT = 0xFFFFFFF0UL;
+	Timestamp::now_ticks(); //note the MSB as set
+	TIM5->CNT = 0x10;
+
+	Sim::preempt_next_ldrex(reading_isr);
+	uint64_t main_read = Timestamp::now_ticks();
+	CHECK_EQ(main_read, WRAP_TICKS + 0x10);
+	CHECK_EQ(isr_read, WRAP_TICKS + 0x10);
+
+	//both saw the wrap, only one of them got to publish it
+	TIM5->CNT = 0x20;
+	CHECK_EQ(Timestamp::now_ticks(), WRAP_TICKS + 0x20);
+}
+
+TEST(monotonic_under_random_reads) {
+	Timestamp::init();
+	uint64_t last = Timestamp::now_ticks();
+	uint32_t seed = 42;
+	for(uint32_t i = 0; i < 20000; i++) {
+		seed = seed * 1664525UL + 1013904223UL;
+		Sim::advance_cycles(seed >> 12); //up to ~1M cycles per step
+		uint64_t now = Timestamp::now_ticks();
+		CHECK(now >= last);
+		last = now;
+	}
+	CHECK_EQ(last, Sim::get_cycles() / 2);
+}
+
+HOST_TEST_MAIN()
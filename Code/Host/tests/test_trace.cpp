@@ -0,0 +1,168 @@
+/*
+ * test_trace.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Trace ring: the dump format byte for byte, wrap-around, and writers preempting each other mid-claim
+ *  `dump_for_decoder` leaves a dump in the build directory for tools/test_trace_decode.py to read back
+ */
+// HOST_TEST_DEFINES: TRACING=1
+
+#include "host_test.h"
+#include "app_hal_trace.h"
+#include <string>
+extern "C" {
+	#include "usart.h"
+}
+
+#define HEADER_SIZE 16
+#define RECORD_SIZE 8
+
+static uint32_t read_u32(const std::string &bytes, const size_t offset) {
+	return (uint32_t)(uint8_t)bytes[offset] | ((uint32_t)(uint8_t)bytes[offset + 1] << 8) |
+			((uint32_t)(uint8_t)bytes[offset + 2] << 16) | ((uint32_t)(uint8_t)bytes[offset + 3] << 24);
+}
+
+static uint16_t read_u16(const std::string &bytes, const size_t offset) {
+	return (uint16_t)((uint8_t)bytes[offset] | ((uint8_t)bytes[offset + 1] << 8));
+}
+
+static trace_record_t record_at(const std::string &dump, const uint32_t index) {
+	size_t offset = HEADER_SIZE + index * RECORD_SIZE;
+	return {read_u32(dump, offset), read_u16(dump, offset + 4), read_u16(dump, offset + 6)};
+}
+
+static std::string take_dump() {
+	Sim::uart_output().clear();
+	Trace::dump(&huart2);
+	return Sim::uart_output();
+}
+
+TEST(dump_header_and_records_are_little_endian) {
+	Timestamp::init();
+	Trace::start();
+	Sim::advance_cycles(200);
+	TRACE(TRACE_TIMER_ISR_ENTER, 2);
+	Sim::advance_cycles(200);
+	TRACE(TRACE_PWM_ISR_ENTER, 0x0103);
+
+	std::string dump = take_dump();
+	CHECK_EQ(dump.size(), HEADER_SIZE + 2 * RECORD_SIZE);
+	CHECK(dump.compare(0, 4, "QSTR") == 0);
+	CHECK_EQ(read_u16(dump, 4), 1); //format version
+	CHECK_EQ(read_u16(dump, 6), RECORD_SIZE);
+	CHECK_EQ(read_u32(dump, 8), Timestamp::get_tick_freq());
+	CHECK_EQ(read_u32(dump, 12), 2);
+
+	trace_record_t first = record_at(dump, 0);
+	trace_record_t second = record_at(dump, 1);
+	CHECK_EQ(first.timestamp, 100); //200 cycles is 100 timer ticks
+	CHECK_EQ(first.id, TRACE_TIMER_ISR_ENTER);
+	CHECK_EQ(first.arg, 2);
+	CHECK_EQ(second.timestamp, 200);
+	CHECK_EQ(second.id, TRACE_PWM_ISR_ENTER);
+	CHECK_EQ(second.arg, 0x0103);
+	Trace::stop();
+}
+
+TEST(full_ring_dumps_the_newest_records_oldest_first) {
+	Timestamp::init();
+	Trace::start();
+	for(uint32_t i = 0; i < TRACE_DEPTH + 5; i++) {
+		Sim::advance_cycles(2);
+		TRACE(TRACE_DEBOUNCE_EDGE, i);
+	}
+
+	std::string dump = take_dump();
+	CHECK_EQ(read_u32(dump, 12), TRACE_DEPTH);
+	CHECK_EQ(dump.size(), HEADER_SIZE + TRACE_DEPTH * RECORD_SIZE);
+
+	//the five oldest got overwritten, everything else comes out in order across the wrap
+	bool in_order = true;
+	for(uint32_t i = 0; i < TRACE_DEPTH; i++) {
+		trace_record_t rec = record_at(dump, i);
+		if(rec.arg != i + 5 || rec.timestamp != i + 6) in_order = false;
+	}
+	CHECK(in_order);
+	Trace::stop();
+}
+
+TEST(stopped_trace_records_nothing_and_dump_picks_back_up) {
+	Timestamp::init();
+	Trace::start();
+	TRACE(TRACE_TIMER_ISR_ENTER, 0);
+	Trace::stop();
+	TRACE(TRACE_TIMER_ISR_EXIT, 0);
+	CHECK_EQ(read_u32(take_dump(), 12), 1);
+
+	//the dump holds writers off while it runs, then puts the run flag back the way it was
+	Trace::start();
+	TRACE(TRACE_TIMER_ISR_ENTER, 0);
+	take_dump();
+	TRACE(TRACE_TIMER_ISR_EXIT, 0);
+	CHECK_EQ(read_u32(take_dump(), 12), 2);
+	Trace::stop();
+}
+
+//writers that land right inside somebody else's claim, a little later on the clock each time
+static void inner_writer() {
+	Sim::advance_cycles(10);
+	TRACE(TRACE_TIMER_ISR_ENTER, 2);
+}
+
+static void middle_writer() {
+	Sim::advance_cycles(10);
+	Sim::preempt_next_ldrex(inner_writer);
+	TRACE(TRACE_TIMER_ISR_ENTER, 1);
+}
+
+TEST(preempting_writer_gets_the_earlier_slot_and_timestamp) {
+	Timestamp::init();
+	Trace::start();
+	Sim::advance_cycles(1000);
+
+	Sim::preempt_next_ldrex(middle_writer);
+	TRACE(TRACE_TIMER_ISR_ENTER, 0);
+
+	//three writers, three slots--nobody overwrote anybody, and the deepest one is first
+	std::string dump = take_dump();
+	CHECK_EQ(read_u32(dump, 12), 3);
+	CHECK_EQ(record_at(dump, 0).arg, 2);
+	CHECK_EQ(record_at(dump, 1).arg, 1);
+	CHECK_EQ(record_at(dump, 2).arg, 0);
+	CHECK(record_at(dump, 0).timestamp <= record_at(dump, 1).timestamp);
+	CHECK(record_at(dump, 1).timestamp <= record_at(dump, 2).timestamp);
+	Trace::stop();
+}
+
+//a timer ISR with a PWM ISR nested inside it, then a debounced edge and a hard stop trip
+TEST(dump_for_decoder) {
+	Timestamp::init();
+	Trace::start();
+	Sim::advance_cycles(180);
+	TRACE(TRACE_TIMER_ISR_ENTER, 1);
+	Sim::advance_cycles(90);
+	TRACE(TRACE_PWM_ISR_ENTER, (1 << 8) | TIM_SR_UIF | TIM_SR_CC2IF);
+	Sim::advance_cycles(90);
+	TRACE(TRACE_PWM_ISR_EXIT, 1);
+	Sim::advance_cycles(180);
+	TRACE(TRACE_TIMER_ISR_EXIT, 1);
+	Sim::advance_cycles(360);
+	TRACE(TRACE_TIMER_OVERRUN, 1);
+	TRACE(TRACE_DEBOUNCE_EDGE, (2 << 5) | (13 << 1) | 1); //PC13 went high
+	TRACE(TRACE_HARD_STOP_TRIP, (2 << 4) | 13);
+
+	std::string dump = take_dump();
+	CHECK_EQ(read_u32(dump, 12), 7);
+	FILE *file = fopen("trace_dump.bin", "wb");
+	CHECK(file != NULL);
+	if(file != NULL) {
+		//the decoder has to find the dump in whatever else came over the UART
+		fputs("cpu,12,34\r\n", file);
+		fwrite(dump.data(), 1, dump.size(), file);
+		fclose(file);
+	}
+	Trace::stop();
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+#
+# bench_compare.py
+#
+#  Created on: Oct 19, 2026
+#
+#  Checks a benchmark run against a stored baseline, one line per benchmark with the ratio to the baseline
+#  Takes either format: the firmware's `Benchmark::run_all()` dump (compared on "cycles_min"), straight off a UART capture,
+#  or host_bench's (compared on "ns_min"). Both files have to be the same kind
+#  A benchmark regresses if it gets slower than --threshold times the baseline AND by more than --floor
+#  (in the unit being compared), so a couple of cycles/ns of noise on the tiny ones doesn't fail the run
+#  Anything in one file but not the other fails too--add a benchmark, regenerate the baseline
+#
+#  usage: bench_compare.py <baseline> <result> [--threshold 1.5] [--floor 5] [--names-only]
+
+import json
+import sys
+
+USAGE = "usage: bench_compare.py <baseline> <result> [--threshold 1.5] [--floor 5] [--names-only]"
+METRICS = ["cycles_min", "ns_min"]
+
+class BenchError(Exception):
+	pass
+
+# the JSON object is a line of its own, whatever else the capture has around it
+def load(path):
+	with open(path) as f:
+		text = f.read()
+	for line in text.splitlines():
+		line = line.strip()
+		if line.startswith("{") and "\"benchmarks\"" in line:
+			try:
+				results = json.loads(line)
+			except ValueError as e:
+				raise BenchError("%s: %s" % (path, e))
+			break
+	else:
+		try:
+			results = json.loads(text)
+		except ValueError:
+			raise BenchError("%s: no benchmark results in it" % path)
+
+	benchmarks = results.get("benchmarks", [])
+	metric = next((m for m in METRICS if benchmarks and m in benchmarks[0]), None)
+	if metric is None:
+		raise BenchError("%s: no benchmark results in it" % path)
+	return metric, {b["name"]: b[metric] for b in benchmarks}
+
+# (lines to print, whether it passed)
+def compare(baseline_path, result_path, threshold=1.5, floor=5.0, names_only=False):
+	base_metric, baseline = load(baseline_path)
+	metric, result = load(result_path)
+	if base_metric != metric:
+		raise BenchError("%s is in %s but %s is in %s" % (baseline_path, base_metric, result_path, metric))
+
+	lines = []
+	passed = True
+	for name in sorted(set(baseline) | set(result)):
+		if name not in result:
+			lines.append("%-32s missing from the run" % name)
+			passed = False
+		elif name not in baseline:
+			lines.append("%-32s not in the baseline" % name)
+			passed = False
+		elif not names_only:
+			old, new = baseline[name], result[name]
+			ratio = (new / old) if old > 0 else float("inf") if new > 0 else 1.0
+			regressed = new > old * threshold and new - old > floor
+			passed &= not regressed
+			lines.append("%-32s %12.3f -> %12.3f %s  x%.2f%s" % (name, old, new, metric, ratio,
+					"  REGRESSED" if regressed else ""))
+	return lines, passed
+
+def main(argv):
+	args = argv[1:]
+	options = {"--threshold": 1.5, "--floor": 5.0}
+	for option in options:
+		if option in args:
+			i = args.index(option)
+			if i + 1 >= len(args):
+				sys.exit(USAGE)
+			try:
+				options[option] = float(args[i + 1])
+			except ValueError:
+				sys.exit(USAGE)
+			del args[i:i + 2]
+	names_only = "--names-only" in args
+	if names_only:
+		args.remove("--names-only")
+	if len(args) != 2:
+		sys.exit(USAGE)
+
+	try:
+		lines, passed = compare(args[0], args[1], options["--threshold"], options["--floor"], names_only)
+	except (BenchError, OSError) as e:
+		sys.exit("error: %s" % e)
+	for line in lines:
+		print(line)
+	print("benchmarks match the baseline" if passed else "benchmarks DON'T match the baseline")
+	return 0 if passed else 1
+
+if __name__ == "__main__":
+	sys.exit(main(sys.argv))
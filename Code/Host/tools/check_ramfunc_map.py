@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+#
+# check_ramfunc_map.py
+#
+#  Created on: Oct 19, 2026
+#
+#  Checks a GNU ld map file to make sure the hot ISR chain (see app_hal_ramfunc.h) really ended up in SRAM
+#   - every hot symbol has to sit in a .RamFunc input section
+#   - no long branch veneer can sit in SRAM--the linker only puts one there when SRAM code branches straight into flash
+#  Works on the firmware map (Debug/Quickstep Firmware.map) and on the host build's maps, which is how ctest runs it
+#
+#  usage: check_ramfunc_map.py <map file> [--no-app]
+#   --no-app skips the callbacks that live in app_main.cpp (the host build leaves that file out)
+
+import re
+import shutil
+import subprocess
+import sys
+
+SRAM_START = 0x20000000
+SRAM_END = 0x20020000
+
+# matched on the name up to the argument list, so `uint32_t` being a different type on the host doesn't matter
+HOT_SYMBOLS = [
+	# vectors
+	"TIM1_BRK_TIM9_IRQHandler",
+	"TIM1_TRG_COM_TIM11_IRQHandler",
+	"TIM8_TRG_COM_TIM14_IRQHandler",
+	"TIM8_UP_TIM13_IRQHandler",
+	"TIM2_IRQHandler",
+	"TIM3_IRQHandler",
+	"EXTI0_IRQHandler",
+	"EXTI1_IRQHandler",
+	"EXTI2_IRQHandler",
+	"EXTI3_IRQHandler",
+	"EXTI4_IRQHandler",
+	"EXTI9_5_IRQHandler",
+	"EXTI15_10_IRQHandler",
+
+	# class ISRs and what they call directly
+	"Timer::ISR_func",
+	"Timer::disable_tim",
+	"Timer::disable_int",
+	"Hard_PWM::isr_groupA",
+	"Hard_PWM::isr_groupB",
+	"Ext_Int::ISR_func",
+	"Ext_Int::disable",
+	"Deferred_Work::queue",
+	"Timestamp::now_ticks",
+	"Timestamp::now_ticks32",
+	"Input_Event_Queue::push",
+	"Stack_Monitor::record_nesting",
+
+	# high rate callbacks
+	"Soft_PWM::update",
+	"Soft_Timer::tick",
+	"Soft_Timer::cascade",
+	"Soft_Timer::insert",
+	"Soft_Timer::unlink",
+	"Debouncer::sample_and_update",
+	"Debouncer::read_input",
+	"Debouncer::update_integrator",
+	"Debouncer::record_edge",
+	"Debouncer::force_state",
+	"Hard_Stop::trip_isr",
+	"Hard_Stop::trip",
+]
+
+# app_main.cpp
+APP_HOT_SYMBOLS = [
+	"run_pwm",
+	"stepper_func",
+]
+
+INPUT_SECTION = re.compile(r"^ (\.\S+|COMMON)(?:\s+0x[0-9a-fA-F]+\s+0x[0-9a-fA-F]+(?:\s+.*)?)?$")
+OUTPUT_SECTION = re.compile(r"^(\.\S+|\S+)(?:\s+0x[0-9a-fA-F]+.*)?$")
+SYMBOL = re.compile(r"^\s{16,}(0x[0-9a-fA-F]+)\s+(\S.*)$")
+VENEER = re.compile(r"^__(.+)_veneer$")
+
+# pull (section, address, name) out of the memory map part of the file
+def parse_map(lines):
+	symbols = []
+	section = None
+	in_memory_map = False
+	for line in lines:
+		line = line.rstrip("\n")
+		if line.startswith("Linker script and memory map"):
+			in_memory_map = True
+			continue
+		if not in_memory_map or not line.strip():
+			continue
+
+		match = INPUT_SECTION.match(line)
+		if match:
+			section = match.group(1)
+			continue
+		match = SYMBOL.match(line)
+		if match:
+			name = match.group(2).strip()
+			#skip linker script assignments and PROVIDEs
+			if "=" in name or name.startswith("PROVIDE") or name.startswith("0x"):
+				continue
+			symbols.append((section, int(match.group(1), 16), name))
+			continue
+		match = OUTPUT_SECTION.match(line)
+		if match and not line.startswith(" "):
+			section = match.group(1)
+	return symbols
+
+# the firmware map usually has mangled names, the host one doesn't
+def demangle(names):
+	mangled = [n for n in names if n.startswith("_Z")]
+	if not mangled:
+		return {}
+	tool = shutil.which("arm-none-eabi-c++filt") or shutil.which("c++filt")
+	if tool is None:
+		sys.exit("error: the map has mangled names and there's no c++filt to read them with")
+	out = subprocess.run([tool], input="\n".join(mangled), capture_output=True, text=True, check=True).stdout
+	return dict(zip(mangled, out.splitlines()))
+
+def base_name(name):
+	return name.split("(", 1)[0].strip()
+
+def main(argv):
+	args = [a for a in argv[1:] if not a.startswith("--")]
+	if len(args) != 1:
+		sys.exit("usage: check_ramfunc_map.py <map file> [--no-app]")
+	wanted = list(HOT_SYMBOLS)
+	if "--no-app" not in argv:
+		wanted += APP_HOT_SYMBOLS
+
+	with open(args[0]) as f:
+		symbols = parse_map(f.readlines())
+	raw_names = [name for _, _, name in symbols]
+	names = demangle(raw_names + [m.group(1) for m in map(VENEER.match, raw_names) if m])
+
+	placement = {}
+	veneers = []
+	for section, address, name in symbols:
+		name = names.get(name, name)
+		placement.setdefault(base_name(name), []).append((section, address))
+		veneer = VENEER.match(name)
+		if veneer and SRAM_START <= address < SRAM_END:
+			veneers.append((address, veneer.group(1)))
+
+	errors = []
+	for symbol in wanted:
+		if symbol not in placement:
+			errors.append("%s: not in the map (renamed, or not linked in?)" % symbol)
+			continue
+		for section, address in placement[symbol]:
+			if section is None or not section.startswith(".RamFunc"):
+				errors.append("%s: in %s at 0x%08x, not .RamFunc" % (symbol, section, address))
+	for address, target in veneers:
+		target = names.get(target, target)
+		errors.append("veneer to %s at 0x%08x: something in SRAM calls straight into flash" % (target, address))
+
+	for error in errors:
+		print(error)
+	print("%d hot symbols checked, %d problems" % (len(wanted), len(errors)))
+	return 1 if errors else 0
+
+if __name__ == "__main__":
+	sys.exit(main(sys.argv))
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+#
+# test_trace_decode.py
+#
+#  Created on: Oct 19, 2026
+#
+#  trace_decode.py against hand-built dumps, and against the dump test_trace leaves behind (path in TRACE_DUMP)
+
+import json
+import os
+import re
+import struct
+import sys
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import trace_decode as td
+
+TRACE_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+		"..", "..", "User_App", "Board_HAL", "inc", "app_hal_trace.h")
+TICK_FREQ = 90000000
+
+def make_dump(records, tick_freq=TICK_FREQ, version=td.FORMAT_VERSION, count=None):
+	header = td.HEADER.pack(td.MAGIC, version, td.RECORD.size, tick_freq, len(records) if count is None else count)
+	return header + b"".join(td.RECORD.pack(*r) for r in records)
+
+class Decoder(unittest.TestCase):
+	def test_event_table_matches_the_firmware(self):
+		with open(TRACE_HEADER) as f:
+			source = f.read()
+		body = re.search(r"typedef enum Trace_Events \{(.*?)\}", source, re.S).group(1)
+		self.assertEqual(re.findall(r"^\s*(TRACE_\w+)", body, re.M), td.EVENTS)
+
+	def test_timestamps_unwrap_across_the_counter_wrap(self):
+		_, records = td.parse(make_dump([(0xFFFFFF00, 0, 0), (0x00000100, 1, 0), (0x00000200, 2, 0)]))
+		self.assertEqual([r[0] for r in records], [0, 0x200, 0x300])
+
+	def test_finds_the_dump_behind_other_uart_traffic(self):
+		_, records = td.parse(b"cpu,1,2\r\ntask,3\r\n" + make_dump([(5, 0, 3)]))
+		self.assertEqual(records, [(0, 0, 3)])
+
+	def test_rejects_bad_dumps(self):
+		with self.assertRaises(td.TraceError):
+			td.parse(b"nothing to see here")
+		with self.assertRaises(td.TraceError):
+			td.parse(make_dump([(0, 0, 0)], version=2))
+		with self.assertRaises(td.TraceError):
+			td.parse(make_dump([(0, 0, 0)], count=2)) #second record is missing
+		with self.assertRaises(td.TraceError):
+			td.parse(make_dump([])[:10])
+
+	def test_arguments_decode(self):
+		self.assertEqual(td.describe(td.PWM_ISR_ENTER, (1 << 8) | 0x1F), "group B UIF|CC1IF|CC2IF|CC3IF|CC4IF")
+		self.assertEqual(td.describe(td.PWM_ISR_ENTER, 0), "group A no flags")
+		self.assertEqual(td.describe(td.DEBOUNCE_EDGE, (0 << 5) | (5 << 1) | 0), "PA5 -> 0")
+		self.assertEqual(td.describe(td.HARD_STOP_TRIP, (1 << 4) | 15), "PB15")
+		self.assertEqual(td.event_name(200), "UNKNOWN_200")
+
+	def test_nested_isrs_indent_and_time_their_exits(self):
+		records = [(0, td.TIMER_ISR_ENTER, 0), (90, td.PWM_ISR_ENTER, 0x0001),
+				(180, td.PWM_ISR_EXIT, 0), (900, td.TIMER_ISR_EXIT, 0)]
+		lines = td.render_text(TICK_FREQ, td.parse(make_dump(records))[1]).splitlines()
+		self.assertEqual(lines[1].split("us", 1)[1], "    PWM_ISR_ENTER group A UIF")
+		self.assertTrue(lines[2].endswith("(1.000us)"))
+		self.assertTrue(lines[3].endswith("TIMER_ISR_EXIT chan 0  (10.000us)"))
+
+	def test_exit_closes_out_isrs_that_lost_their_exit(self):
+		#the ring overwrote the PWM exit, the timer exit still has to pop back out to the top level
+		records = [(0, td.TIMER_ISR_ENTER, 0), (90, td.PWM_ISR_ENTER, 0), (900, td.TIMER_ISR_EXIT, 0), (1000, td.TIMER_OVERRUN, 0)]
+		lines = td.render_text(TICK_FREQ, td.parse(make_dump(records))[1]).splitlines()
+		self.assertEqual(lines[3].split("us", 1)[1], "  TIMER_OVERRUN chan 0")
+
+	def test_chrome_output_pairs_begins_and_ends(self):
+		records = [(0, td.TIMER_ISR_ENTER, 2), (90, td.TIMER_ISR_EXIT, 2), (90, td.HARD_STOP_TRIP, 0)]
+		events = json.loads(td.render_chrome(TICK_FREQ, td.parse(make_dump(records))[1]))["traceEvents"]
+		self.assertEqual([e["ph"] for e in events], ["B", "E", "i"])
+		self.assertEqual(events[0]["name"], events[1]["name"])
+		self.assertAlmostEqual(events[1]["ts"], 1.0)
+
+	@unittest.skipUnless(os.environ.get("TRACE_DUMP"), "no firmware dump to read (set TRACE_DUMP)")
+	def test_firmware_dump_decodes(self):
+		with open(os.environ["TRACE_DUMP"], "rb") as f:
+			tick_freq, records = td.parse(f.read())
+		self.assertEqual(tick_freq, TICK_FREQ)
+		lines = [line.split("us", 1)[1] for line in td.render_text(tick_freq, records).splitlines()]
+		self.assertEqual(lines, [
+			"  TIMER_ISR_ENTER chan 1",
+			"    PWM_ISR_ENTER group B UIF|CC2IF",
+			"    PWM_ISR_EXIT group B  (0.500us)",
+			"  TIMER_ISR_EXIT chan 1  (2.000us)",
+			"  TIMER_OVERRUN chan 1",
+			"  DEBOUNCE_EDGE PC13 -> 1",
+			"  HARD_STOP_TRIP PC13",
+		])
+
+if __name__ == "__main__":
+	unittest.main()
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+#
+# trace_decode.py
+#
+#  Created on: Oct 19, 2026
+#
+#  Decodes a `Trace::dump()` (format in app_hal_trace.h) into a timeline
+#  Point it at a raw capture of the UART--it skips everything before the "QSTR" magic, so telemetry lines in front are fine:
+#   - text (default): one line per record, time since the first record, ISRs indented by how deeply they're nested
+#     and each exit tagged with how long that ISR ran
+#   - --chrome FILE: Chrome trace event JSON, opens in Perfetto (ui.perfetto.dev) or chrome://tracing
+#
+#  usage: trace_decode.py <capture> [--chrome out.json]
+
+import json
+import struct
+import sys
+
+MAGIC = b"QSTR"
+FORMAT_VERSION = 1
+HEADER = struct.Struct("<4sHHII")
+RECORD = struct.Struct("<IHH")
+
+# in `trace_event_t` order--keep in step with app_hal_trace.h (test_trace_decode.py checks)
+EVENTS = [
+	"TRACE_TIMER_ISR_ENTER",
+	"TRACE_TIMER_ISR_EXIT",
+	"TRACE_TIMER_OVERRUN",
+	"TRACE_PWM_ISR_ENTER",
+	"TRACE_PWM_ISR_EXIT",
+	"TRACE_DEBOUNCE_EDGE",
+	"TRACE_HARD_STOP_TRIP",
+]
+TIMER_ISR_ENTER, TIMER_ISR_EXIT, TIMER_OVERRUN, PWM_ISR_ENTER, PWM_ISR_EXIT, DEBOUNCE_EDGE, HARD_STOP_TRIP = range(len(EVENTS))
+
+PWM_FLAGS = ["UIF", "CC1IF", "CC2IF", "CC3IF", "CC4IF"]
+
+class TraceError(Exception):
+	pass
+
+# returns (tick frequency, [(ticks since the first record, id, arg), ...])
+# raw timestamps wrap every ~47s, so unwrap them by summing the deltas between consecutive records
+def parse(data):
+	start = data.find(MAGIC)
+	if start < 0:
+		raise TraceError("no trace dump in here (no \"QSTR\" magic)")
+	if len(data) - start < HEADER.size:
+		raise TraceError("dump header is cut off")
+	_, version, record_size, tick_freq, count = HEADER.unpack_from(data, start)
+	if version != FORMAT_VERSION:
+		raise TraceError("format version %d, this decoder reads %d" % (version, FORMAT_VERSION))
+	if record_size != RECORD.size:
+		raise TraceError("%d byte records, expected %d" % (record_size, RECORD.size))
+	if tick_freq == 0:
+		raise TraceError("tick frequency is zero")
+	offset = start + HEADER.size
+	if len(data) - offset < count * record_size:
+		raise TraceError("dump says %d records, only %d bytes follow" % (count, len(data) - offset))
+
+	records = []
+	ticks = 0
+	previous = None
+	for i in range(count):
+		timestamp, event_id, arg = RECORD.unpack_from(data, offset + i * record_size)
+		if previous is not None:
+			ticks += (timestamp - previous) & 0xFFFFFFFF
+		previous = timestamp
+		records.append((ticks, event_id, arg))
+	return tick_freq, records
+
+def pin_name(port, pin):
+	return "P%s%d" % (chr(ord("A") + port), pin)
+
+def describe(event_id, arg):
+	if event_id in (TIMER_ISR_ENTER, TIMER_ISR_EXIT, TIMER_OVERRUN):
+		return "chan %d" % arg
+	if event_id == PWM_ISR_ENTER:
+		flags = [name for bit, name in enumerate(PWM_FLAGS) if arg & (1 << bit)]
+		return "group %s %s" % ("AB"[(arg >> 8) & 1], "|".join(flags) if flags else "no flags")
+	if event_id == PWM_ISR_EXIT:
+		return "group %s" % "AB"[arg & 1]
+	if event_id == DEBOUNCE_EDGE:
+		return "%s -> %d" % (pin_name(arg >> 5, (arg >> 1) & 0xF), arg & 1)
+	if event_id == HARD_STOP_TRIP:
+		return pin_name(arg >> 4, arg & 0xF)
+	return "arg 0x%04x" % arg
+
+def event_name(event_id):
+	if event_id < len(EVENTS):
+		return EVENTS[event_id][len("TRACE_"):]
+	return "UNKNOWN_%d" % event_id
+
+# ISR enter/exit pairs get matched on the ISR they belong to: the timer channel, or the PWM group
+def isr_key(event_id, arg):
+	if event_id in (TIMER_ISR_ENTER, TIMER_ISR_EXIT):
+		return ("timer", arg)
+	if event_id == PWM_ISR_ENTER:
+		return ("pwm", (arg >> 8) & 1)
+	if event_id == PWM_ISR_EXIT:
+		return ("pwm", arg & 1)
+	return None
+
+def render_text(tick_freq, records):
+	lines = []
+	open_isrs = []
+	for ticks, event_id, arg in records:
+		key = isr_key(event_id, arg)
+		time_us = ticks * 1e6 / tick_freq
+		suffix = ""
+		if event_id in (TIMER_ISR_EXIT, PWM_ISR_EXIT) and key in [k for k, _ in open_isrs]:
+			#close it out, along with anything nested inside it that never logged its exit (i.e. got overwritten)
+			while open_isrs:
+				open_key, enter_ticks = open_isrs.pop()
+				if open_key == key:
+					suffix = "  (%.3fus)" % ((ticks - enter_ticks) * 1e6 / tick_freq)
+					break
+		indent = "  " * len(open_isrs)
+		lines.append("%12.3fus  %s%s %s%s" % (time_us, indent, event_name(event_id), describe(event_id, arg), suffix))
+		if event_id in (TIMER_ISR_ENTER, PWM_ISR_ENTER):
+			open_isrs.append((key, ticks))
+	return "\n".join(lines)
+
+def render_chrome(tick_freq, records):
+	events = []
+	for ticks, event_id, arg in records:
+		key = isr_key(event_id, arg)
+		event = {"name": event_name(event_id), "ts": ticks * 1e6 / tick_freq, "pid": 0, "tid": 0,
+				"args": {"arg": arg, "decoded": describe(event_id, arg)}}
+		if event_id in (TIMER_ISR_ENTER, PWM_ISR_ENTER):
+			event.update(ph="B", name="%s %d ISR" % key)
+		elif event_id in (TIMER_ISR_EXIT, PWM_ISR_EXIT):
+			event.update(ph="E", name="%s %d ISR" % key)
+		else:
+			event.update(ph="i", s="t")
+		events.append(event)
+	return json.dumps({"traceEvents": events, "displayTimeUnit": "ns"}, indent=1)
+
+def main(argv):
+	args = argv[1:]
+	chrome = None
+	if "--chrome" in args:
+		i = args.index("--chrome")
+		if i + 1 >= len(args):
+			sys.exit("usage: trace_decode.py <capture> [--chrome out.json]")
+		chrome = args[i + 1]
+		del args[i:i + 2]
+	if len(args) != 1:
+		sys.exit("usage: trace_decode.py <capture> [--chrome out.json]")
+
+	with open(args[0], "rb") as f:
+		data = f.read()
+	try:
+		tick_freq, records = parse(data)
+	except TraceError as e:
+		sys.exit("error: %s" % e)
+
+	if chrome is not None:
+		with open(chrome, "w") as f:
+			f.write(render_chrome(tick_freq, records))
+	else:
+		print(render_text(tick_freq, records))
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main(sys.argv))
@@ -0,0 +1,57 @@
+/*
+ * app_hal_deferred.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Deferred work ("bottom halves") for ISRs
+ *  High rate ISRs should only do the time critical stuff (GPIO writes) at their own priority
+ *  Anything that can wait a little (counters, logging, buffer refills) gets queued here instead,
+ *  and runs from PendSV at the very lowest interrupt priority once every other ISR has finished
+ *
+ *  Work items are statically allocated by whoever owns them, so there's no memory management
+ *  Queueing is a lock-free push (LDREX/STREX) onto a single list, safe from any ISR priority
+ *  Queueing an item that's already waiting to run does nothing, so a burst of ISRs collapses into one run
+ *  Items run in the order they were queued
+ */
+
+#ifndef BOARD_HAL_INC_APP_HAL_DEFERRED_H_
+#define BOARD_HAL_INC_APP_HAL_DEFERRED_H_
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "app_hal_int_utils.h"
+#include "app_hal_ramfunc.h"
+
+class Deferred_Work {
+public:
+	Deferred_Work(callback_function_t _func);
+	void set_func(callback_function_t _func);
+
+	//aggressively optimize here since this will be called from ISRs
+	//returns false if the item was already queued
+	bool RAMFUNC __attribute__((optimize("O3"))) queue();
+
+	static void init(); //puts PendSV at the lowest priority--call before queueing anything
+
+	//drains the list; called from the PendSV handler
+	//NOTE FOR PORTING: APP WILL NEVER CALL THIS FUNCTION, SO IMPLEMENT HOW YOU'D LIKE
+	static void run_pending();
+
+private:
+	//don't allow one of these to be copied, the list holds pointers to the original
+	Deferred_Work(Deferred_Work &other){}
+
+	callback_function_t func;
+	Deferred_Work *next;
+	volatile uint32_t queued; //non-zero while sitting on the list
+
+	static Deferred_Work * volatile head; //most recently queued item
+};
+
+//called from the PendSV handler
+extern "C" {
+	void deferred_work_handler(void);
+}
+
+#endif /* BOARD_HAL_INC_APP_HAL_DEFERRED_H_ */
@@ -12,6 +12,7 @@
 extern "C" {
 	#include "stm32f446xx.h" //for uint32_t
 }
+#include "app_hal_gpio_capture.h"
 
 class DIO {
 
@@ -27,13 +28,32 @@ private:
 public:
 	DIO(const dio_pin_t &pin_name);
 	static void init();
+	const dio_pin_t &get_pin() const { return pin_ref; } //which physical pin we're mapped to
+	static GPIO_TypeDef *port_regs(const gpio_port_t port); //register block of a port--ALL GPIO register access goes through here
 
 //heavily optimize these functions for high performance
 #pragma GCC push_options
 #pragma GCC optimize ("O3")
-	void set() const;
-	void clear() const;
-	uint32_t read() const;
+	//the single pin ones get inlined into their callers, so an ISR running out of SRAM never branches back into flash for them
+	inline __attribute__((always_inline)) void set() const {
+		*port_BSRR = DRIVE_HIGH_MASK;
+#if GPIO_CAPTURE
+		GPIO_Capture::record(pin_ref, true);
+#endif
+	}
+
+	inline __attribute__((always_inline)) void clear() const {
+		*port_BSRR = DRIVE_LOW_MASK;
+#if GPIO_CAPTURE
+		GPIO_Capture::record(pin_ref, false);
+#endif
+	}
+
+	inline __attribute__((always_inline)) uint32_t read() const {
+		return ( (*port_IDR) & READ_MASK );
+	}
+
+	static uint32_t read_port(const gpio_port_t port); //read every pin on a port in one shot
 #pragma GCC pop_options
 };
 
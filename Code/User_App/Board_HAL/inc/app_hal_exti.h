@@ -0,0 +1,58 @@
+/*
+ * app_hal_exti.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Thin wrapper around the external interrupt controller so app code can get a callback on a pin edge
+ *  There are 16 EXTI lines, and line N can only be connected to pin N of ONE port at a time
+ *
+ *  NOTE: lines 5-9 and 10-15 share an NVIC channel each, so they also share a priority
+ *  whatever priority was attached last wins for the whole group
+ */
+
+#ifndef BOARD_HAL_INC_APP_HAL_EXTI_H_
+#define BOARD_HAL_INC_APP_HAL_EXTI_H_
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "app_hal_int_utils.h"
+#include "app_pin_mapping.h"
+#include "app_hal_ramfunc.h"
+
+#define NUM_EXTI_LINES 16
+
+//EXTI callbacks get passed the line that fired, so one function can service several lines
+typedef void (*exti_callback_function_t)(uint32_t line);
+
+typedef enum EXTI_Edges {
+	EDGE_RISING = 1,
+	EDGE_FALLING = 2,
+	EDGE_BOTH = 3
+} exti_edge_t;
+
+class Ext_Int {
+public:
+	//connect the pin to its EXTI line and start firing the callback on the requested edges
+	//returns the line number (which is just the pin number)
+	static uint32_t attach(const dio_pin_t &pin, exti_edge_t edges, int_priority_t prio, exti_callback_function_t cb);
+	static void detach(uint32_t line);
+
+	//mask/unmask a line without touching the rest of its configuration
+	//unmasking clears any edge that was latched while the line was masked
+	static void enable(uint32_t line);
+	static void RAMFUNC disable(uint32_t line);
+
+	//single ISR function that dispatches every pending line in the range
+	//NOTE FOR PORTING: APP WILL NEVER CALL THIS FUNCTION, SO IMPLEMENT HOW YOU'D LIKE
+	static void RAMFUNC __attribute__((optimize("O3"))) ISR_func(uint32_t first_line, uint32_t last_line);
+
+private:
+	//shouldn't be able to instantiate this class
+	Ext_Int(){};
+
+	static IRQn_Type line_to_irq(uint32_t line);
+	static exti_callback_function_t callbacks[NUM_EXTI_LINES];
+};
+
+#endif /* BOARD_HAL_INC_APP_HAL_EXTI_H_ */
@@ -0,0 +1,134 @@
+/*
+ * app_hal_gpio_capture.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Opt-in logic analyzer built into the DIO layer
+ *  With capture enabled, every `DIO::set()`/`DIO::clear()` gets timestamped into a buffer, so we can check
+ *  Soft_PWM, Hard_PWM and step outputs quantitatively without hooking up a scope:
+ *   - per-pin duty cycle, frequency, period jitter (peak to peak) and minimum pulse width
+ *   - skew between the rising edges of two pins (e.g. the phase spread between soft PWM channels)
+ *   - a VCD dump over the UART that opens straight in GTKWave
+ *
+ *  Single shot, like a real logic analyzer: `start()` arms it, and it stops on its own once the buffer fills
+ *  Timestamps are taken inside the LDREX/STREX slot claim, so records from nested ISRs always end up in time order
+ *  Edges logged after the fact with `record_at()` (e.g. Hard_PWM's, from PendSV) land out of order, so `stop()` sorts the buffer
+ *  Call `stop()` before analyzing or dumping
+ *
+ *  Adds a slot claim, a timestamp read and the record to every pin write when enabled (build the benchmarks with capture on,
+ *  and `dio_set_captured` less `dio_set` is that cost), and compiles out to nothing when disabled
+ *  To enable, set GPIO_CAPTURE to 1 here (or pass -DGPIO_CAPTURE=1)
+ */
+
+#ifndef BOARD_HAL_INC_APP_HAL_GPIO_CAPTURE_H_
+#define BOARD_HAL_INC_APP_HAL_GPIO_CAPTURE_H_
+
+#ifndef GPIO_CAPTURE
+#define GPIO_CAPTURE 0
+#endif
+
+#define GPIO_CAPTURE_DEPTH 2048 //records, 8 bytes each
+#define GPIO_CAPTURE_NUM_LINES 128 //8 ports x 16 pins
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "stdbool.h"
+#include "app_pin_mapping.h"
+#include "app_hal_timestamp.h"
+
+typedef struct {
+	uint32_t timestamp; //raw timestamp counter
+	uint8_t line; //port index * 16 + pin
+	uint8_t level;
+} gpio_capture_record_t;
+
+//all times in ns; anything that needs a full period is 0 if we never saw one
+typedef struct {
+	uint32_t edges; //actual level changes, repeated writes of the same level don't count
+	uint32_t periods; //complete rising edge to rising edge periods
+	float frequency_hz;
+	float duty; //0 to 1
+	uint32_t period_min_ns;
+	uint32_t period_max_ns;
+	uint32_t jitter_ns; //peak to peak period variation
+	uint32_t min_pulse_ns; //shortest high OR low time
+} gpio_capture_metrics_t;
+
+//rising edge of one pin to the next rising edge of another
+typedef struct {
+	uint32_t pairs;
+	int32_t mean_ns;
+	int32_t min_ns;
+	int32_t max_ns;
+} gpio_capture_skew_t;
+
+class GPIO_Capture {
+public:
+	static void start(); //clears out the buffer and starts recording
+	static void stop();
+	static bool is_running();
+	static uint32_t get_count(); //how many records we have
+
+	static gpio_capture_metrics_t analyze(const dio_pin_t &pin);
+	static gpio_capture_skew_t skew(const dio_pin_t &from, const dio_pin_t &to);
+
+	//blocking VCD dump of every pin that got written during the capture--call this from main context
+	static void dump_vcd(UART_HandleTypeDef *huart);
+
+	static inline __attribute__((always_inline)) void record(const dio_pin_t &pin, const bool level) {
+		if(!GPIO_Capture::running) return;
+
+		//claim a slot and timestamp it in one go
+		//if anything preempts us the STREX fails and we come back with a fresh (later) timestamp
+		uint32_t index, timestamp;
+		do {
+			index = __LDREXW(&GPIO_Capture::write_index);
+			if(index >= GPIO_CAPTURE_DEPTH) {
+				__CLREX();
+				GPIO_Capture::running = false;
+				return;
+			}
+			timestamp = Timestamp::now_ticks32();
+		} while(__STREXW(index + 1, &GPIO_Capture::write_index));
+
+		gpio_capture_record_t &rec = GPIO_Capture::buffer[index];
+		rec.timestamp = timestamp;
+		rec.line = GPIO_Capture::line_of(pin);
+		rec.level = level;
+	}
+
+	//same thing, for an edge that got timestamped earlier--`stop()` puts it back in order
+	static inline __attribute__((always_inline)) void record_at(const dio_pin_t &pin, const bool level, const uint32_t timestamp) {
+		if(!GPIO_Capture::running) return;
+
+		uint32_t index;
+		do {
+			index = __LDREXW(&GPIO_Capture::write_index);
+			if(index >= GPIO_CAPTURE_DEPTH) {
+				__CLREX();
+				GPIO_Capture::running = false;
+				return;
+			}
+		} while(__STREXW(index + 1, &GPIO_Capture::write_index));
+
+		gpio_capture_record_t &rec = GPIO_Capture::buffer[index];
+		rec.timestamp = timestamp;
+		rec.line = GPIO_Capture::line_of(pin);
+		rec.level = level;
+	}
+
+private:
+	//shouldn't be able to instantiate this class
+	GPIO_Capture(){};
+
+	static inline __attribute__((always_inline)) uint8_t line_of(const dio_pin_t &pin) {
+		return (uint8_t)((((uint32_t)pin.port >> 10) << 4) | pin.pin); //port enum values are 0x400 apart
+	}
+
+	static gpio_capture_record_t buffer[GPIO_CAPTURE_DEPTH];
+	static volatile uint32_t write_index;
+	static volatile bool running;
+};
+
+#endif /* BOARD_HAL_INC_APP_HAL_GPIO_CAPTURE_H_ */
@@ -29,8 +29,16 @@ extern "C" {
 	void TIM1_BRK_TIM9_IRQHandler(void); //general purpose timer channel 0
 	void TIM1_TRG_COM_TIM11_IRQHandler(void); //general purpose timer channel 1
 	void TIM8_TRG_COM_TIM14_IRQHandler(void); //general purpose timer channel 2
+	void TIM8_UP_TIM13_IRQHandler(void); //general purpose timer channel 3
 	void TIM2_IRQHandler(void); //hard PWM
 	void TIM3_IRQHandler(void); //hard PWM
+	void EXTI0_IRQHandler(void); //external interrupts
+	void EXTI1_IRQHandler(void);
+	void EXTI2_IRQHandler(void);
+	void EXTI3_IRQHandler(void);
+	void EXTI4_IRQHandler(void);
+	void EXTI9_5_IRQHandler(void);
+	void EXTI15_10_IRQHandler(void);
 }
 
 #endif /* BOARD_HAL_INC_APP_HAL_INT_UTILS_H_ */
@@ -0,0 +1,112 @@
+/*
+ * app_hal_isr_profiler.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Opt-in cycle-accurate profiling of ISRs using the DWT cycle counter
+ *  Wrap an IRQ handler body in ISR_PROFILE_ENTER()/ISR_PROFILE_EXIT() and every call gets recorded into:
+ *   - min/max/count/total cycles
+ *   - a log2 histogram (bucket N holds calls that took [2^N, 2^(N+1)) cycles)
+ *
+ *  Times are EXCLUSIVE of any higher priority ISRs that preempted us, so loads add up properly across nested ISRs
+ *  Adds a couple of DWT reads, an LDREX/STREX add and the stats update per ISR when enabled (the `isr_profiler_enter_exit`
+ *  benchmark times all of it), and compiles out to nothing when disabled
+ *
+ *  To enable, set ISR_PROFILING to 1 here (or pass -DISR_PROFILING=1)
+ */
+
+#ifndef BOARD_HAL_INC_APP_HAL_ISR_PROFILER_H_
+#define BOARD_HAL_INC_APP_HAL_ISR_PROFILER_H_
+
+#ifndef ISR_PROFILING
+#define ISR_PROFILING 0
+#endif
+
+#define ISR_PROFILE_NUM_BUCKETS 32 //one bucket per bit of the cycle counter
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+
+//every ISR we profile gets an ID here--ADD NEW ISRs HERE (and a name in the .cpp)
+typedef enum ISR_Profile_IDs {
+	PROFILE_TIMER_CHAN_0 = 0,
+	PROFILE_TIMER_CHAN_1,
+	PROFILE_TIMER_CHAN_2,
+	PROFILE_TIMER_CHAN_3,
+	PROFILE_PWM_GROUP_A,
+	PROFILE_PWM_GROUP_B,
+	NUM_PROFILED_ISRS
+} isr_profile_id_t;
+
+//what we save on ISR entry so we can work out our own time on exit
+typedef struct {
+	uint32_t start; //cycle count on entry
+	uint32_t preempted_start; //preempted cycle tally on entry
+} isr_profile_ctx_t;
+
+typedef struct {
+	uint32_t count;
+	uint32_t min_cycles;
+	uint32_t max_cycles;
+	uint64_t total_cycles;
+	uint32_t histogram[ISR_PROFILE_NUM_BUCKETS];
+} isr_profile_stats_t;
+
+class ISR_Profiler {
+public:
+	static void init(); //enables the DWT cycle counter and clears everything out
+	static void clear();
+
+	//snapshot a single ISR's stats, and how much of the CPU it has eaten since the last clear (in 0.01% units)
+	static isr_profile_stats_t get_stats(isr_profile_id_t id);
+	static uint32_t get_load_centipercent(isr_profile_id_t id);
+	static const char *get_name(isr_profile_id_t id);
+
+	//blocking dump of every profiled ISR over the UART--call this from main context
+	static void dump(UART_HandleTypeDef *huart);
+
+	static inline __attribute__((always_inline)) isr_profile_ctx_t enter() {
+		isr_profile_ctx_t ctx;
+		ctx.start = DWT->CYCCNT;
+		ctx.preempted_start = ISR_Profiler::preempted_cycles;
+		return ctx;
+	}
+
+	static inline __attribute__((always_inline)) void exit(isr_profile_id_t id, isr_profile_ctx_t ctx) {
+		//take out the time higher priority ISRs spent running on top of us
+		uint32_t cycles = (DWT->CYCCNT - ctx.start) - (ISR_Profiler::preempted_cycles - ctx.preempted_start);
+
+		//then add our own time to the tally for anyone we preempted
+		//a failed STREX means something preempted us, just redo the add
+		uint32_t tally;
+		do {
+			tally = __LDREXW(&ISR_Profiler::preempted_cycles);
+		} while(__STREXW(tally + cycles, &ISR_Profiler::preempted_cycles));
+
+		isr_profile_stats_t &stats = ISR_Profiler::stats[id];
+		stats.histogram[31 - __CLZ(cycles | 1)]++;
+		stats.count++;
+		stats.total_cycles += cycles;
+		if(cycles < stats.min_cycles) stats.min_cycles = cycles;
+		if(cycles > stats.max_cycles) stats.max_cycles = cycles;
+	}
+
+private:
+	//shouldn't be able to instantiate this class
+	ISR_Profiler(){};
+
+	static volatile uint32_t preempted_cycles; //running total of every profiled ISR's own cycles
+	static isr_profile_stats_t stats[NUM_PROFILED_ISRS];
+	static uint64_t clear_time; //timestamp of the last clear, for computing load
+};
+
+#if ISR_PROFILING
+#define ISR_PROFILE_ENTER(id)	isr_profile_ctx_t isr_profile_ctx_ = ISR_Profiler::enter()
+#define ISR_PROFILE_EXIT(id)	ISR_Profiler::exit(id, isr_profile_ctx_)
+#else
+#define ISR_PROFILE_ENTER(id)
+#define ISR_PROFILE_EXIT(id)
+#endif
+
+#endif /* BOARD_HAL_INC_APP_HAL_ISR_PROFILER_H_ */
@@ -11,24 +11,68 @@
  *  It leverages the compare and overflow interrupts to set and reset whatever Output pin the user wants
  *  As a result, it's has higher performance/lower overhead than pure soft PWM, but performs worse than true hardware PWM
  *
+ *  EXCEPTION: if the pin happens to be one of the PWM timers' own outputs (see the AF table in the .cpp),
+ *  and that timer channel is still free, the instance claims it and the timer drives the pin directly
+ *  That costs zero interrupts and has zero jitter, and it's picked automatically--the interface doesn't change
+ *  The pick happens in `configure()` (instances constructed before it are mapped to the ISR until then, since their `DIO`
+ *  might not exist yet), or right in the constructor for instances created after it
+ *  Edges on those pins never go through the CPU though, so GPIO_Capture won't see them
+ *  The ISR-driven edges do get captured, but the ISR only timestamps them--they get written into the capture from PendSV
+ *
+ *  PHASE OFFSETS: by default every channel asserts on the counter rollover, so they all switch at once
+ *  Calling `set_phase()` moves an ISR-driven channel's rising edge anywhere in the period instead:
+ *  its compare channel alternates between the rise and fall points, reprogrammed by the ISR at each edge
+ *  `spread_phases()` spaces every channel out evenly to keep high-current loads from switching together
+ *  (building with HARD_PWM_SPREAD_PHASES=1 does that in `configure()`, after the hardware outputs have been picked)
+ *  Each edge of a phased channel costs an interrupt (rather than sharing the rollover one), and both edges need
+ *  to be at least a count plus the ISR latency apart, otherwise an edge is missed and that pulse runs a full period
+ *  Hardware output channels always stay at phase 0
+ *
  */
 
 #ifndef BOARD_HAL_INC_APP_HAL_PWM_H_
 #define BOARD_HAL_INC_APP_HAL_PWM_H_
 
 #define NUM_PWM_CHANNELS 8 //maximum number of PWM channels we can instantiate
+#define CHANNEL_NOT_MAPPED 0xFF
+#define NUM_PWM_GROUPS 2 //one timer per group
+#define PWM_CHANNELS_PER_GROUP 4 //one compare channel per PWM channel
+#define PWM_CHANNEL_SETS (1 << PWM_CHANNELS_PER_GROUP) //every combination of channels in a group
 
 extern "C" {
 	#include "stm32f4xx_hal.h"
 }
 #include "app_hal_int_utils.h"
 #include "app_hal_dio.h"
+#include "app_hal_ramfunc.h"
+#include "app_hal_deferred.h"
+#include "app_hal_gpio_capture.h"
+
+#ifndef HARD_PWM_SPREAD_PHASES
+#define HARD_PWM_SPREAD_PHASES 0 //set to have `configure()` call `spread_phases()` once every pin is mapped
+#endif
+
+#define PWM_CAPTURE_DEPTH 16 //ISRs worth of edges each group can have waiting to go into the capture, has to be a power of 2
+
+//precomputed BSRR words for one GPIO port touched by a PWM group
+//indexed by a bitmask of the group's channels, so the ISR can drive any combination of them with a single store
+typedef struct {
+	volatile uint32_t *bsrr;
+	uint32_t assert_word[PWM_CHANNEL_SETS];
+	uint32_t deassert_word[PWM_CHANNEL_SETS];
+} pwm_port_table_t;
+
+//the edges one ISR drove, for GPIO_Capture
+typedef struct {
+	uint32_t timestamp; //raw timestamp counter, right after the BSRR writes
+	uint8_t assert_set; //bitmask of the group's channels
+	uint8_t deassert_set;
+} pwm_capture_event_t;
 
 class Hard_PWM {
 public:
 	//trying to keep the interface as similar to Soft_PWM as possible
-	//could theoretically set up a phase offset, but that would require twice as many timer channels to be efficient
-	//as such, going to just have all PWM channels reset when counter rolls over
+	//all PWM channels assert when the counter rolls over, unless given a phase offset (see above)
 	Hard_PWM(const DIO &_pin, const bool _inverted);
 	~Hard_PWM(); //should never be called, but writing this just in case
 
@@ -37,28 +81,87 @@ public:
 	void operate_normally();
 	void force_asserted();
 	void force_deasserted();
+	bool is_hardware_output(); //true if the timer is driving the pin directly
+
+	//float from 0 to 1 (exclusive), where in the period the channel asserts
+	//switches the channel over to phase offset mode; does nothing on hardware output channels
+	void set_phase(float _phase);
+	static void spread_phases(); //space the rising edges of every channel evenly across the period
+
+	//which PWM channel's timer output the pin can be muxed to, CHANNEL_NOT_MAPPED if none
+	static uint8_t timer_channel_of(const dio_pin_t &pin);
 
 	static void configure(const float _freq, int_priority_t _priority); //have this apply to all PWM pins
 
+	//worst case interrupts per second a group's timer (0 = TIM2, 1 = TIM3) fires, from the channels mapped to it right now:
+	//one compare per ISR-driven channel plus the shared update, or two compares (both edges) per phased channel
+	//hardware output channels don't interrupt at all
+	static float get_irq_rate(const uint8_t group, const float _freq);
+	static void set_int_priority(const uint8_t group, int_priority_t _priority);
+
 	//aggressively optimize here since this will be called from timer ISRs
 	//splitting into two ISRs due to two separate channel groups of four
 	//THESE FUNCTIONS WILL NEVER BE CALLED FROM THE APP, SO CAN IMPLEMENT THE ISR
 	//HOWEVER YOU WANT BASED OFF OF WHAT'S BEST FOR YOUR HARDWARE
-	static void __attribute__((optimize("O3"))) isr_groupA();
-	static void __attribute__((optimize("O3"))) isr_groupB();
+	static void RAMFUNC __attribute__((optimize("O3"))) isr_groupA();
+	static void RAMFUNC __attribute__((optimize("O3"))) isr_groupB();
 
 private:
 	//don't allow one of these to be copied, since conflicts could arise writing to the same output pin
 	Hard_PWM(Hard_PWM &other){}
+	friend class Benchmark; //benchmarks swap synthetic channel sets into the ISR tables
+
 	static void enable_chan_interrupt(uint8_t pwm_channel);
 	static void disable_chan_interrupt(uint8_t pwm_channel);
+	static void set_channel_active(uint8_t pwm_channel, bool active); //false blanks the channel--the ISR won't touch the pin
+	static TIM_TypeDef *group_timer(uint8_t group);
+	static IRQn_Type group_irq(uint8_t group);
+	static volatile uint32_t *compare_reg(uint8_t pwm_channel); //CCRx of the channel
+	static void set_output_mode(uint8_t pwm_channel, uint32_t oc_mode); //OCxM, one of the TIM_OCMODE_xxx values
+	static void enable_hw_output(uint8_t pwm_channel); //hand the pin over to the timer
+	static void disable_hw_output(uint8_t pwm_channel); //and give it back
+	static void set_compare_preload(uint8_t pwm_channel, bool preload); //whether CCRx writes wait for the rollover
+	static void enable_phase(uint8_t pwm_channel, uint32_t phase_count); //put the channel in phase offset mode
+	static void apply_phase(uint8_t pwm_channel); //recompute the edges of a phased channel from its duty and phase
+	static void build_port_tables(uint8_t group); //call whenever a channel in the group is mapped or unmapped
+	static void assign_hw_outputs(); //move every pin the timers can drive onto its own timer channel
+	static void swap_channels(uint8_t a, uint8_t b); //trade two channels' pins (and instances) before the timers start
+	static void swap_mask_bits(volatile uint8_t *masks, uint8_t a, uint8_t b); //same for their bits in a per-group mask
+
+	//both groups' ISRs are the same thing with a different timer
+	static inline __attribute__((always_inline)) void service_group(const uint8_t group, TIM_TypeDef *tim);
 
 	uint8_t channel_mapping; //which pwm channel the particular instance corresponds to
 
 	static bool channel_inverted[8];
 	static const DIO *pwm_pins[8];
-	static bool blank_channel[8]; //true indicates that the ISR shouldn't affect the pin
+	static Hard_PWM *instances[8]; //who owns each channel, so `configure()` can move them around
 	static bool channel_in_use[8]; //true indicates that the channel is active
+	static bool hw_output[8]; //true indicates the timer drives the pin, no ISR involvement
+	static bool configured; //whether the timers have been set up yet
+
+	//what the ISR actually looks at
+	static volatile uint8_t active_mask[NUM_PWM_GROUPS]; //bit per channel in the group, set if in use and not blanked
+	static pwm_port_table_t port_tables[NUM_PWM_GROUPS][PWM_CHANNELS_PER_GROUP]; //worst case every channel on its own port
+	static uint8_t num_ports[NUM_PWM_GROUPS]; //how many entries of `port_tables` each group is using
+
+	//phase offset mode
+	static uint32_t duty_count[8]; //last duty cycle set, in timer counts
+	static uint32_t rise_count[8]; //CCRx value for the rising edge, i.e. the phase offset
+	static uint32_t fall_count[8]; //CCRx value for the falling edge
+	static volatile uint8_t phased_mask[NUM_PWM_GROUPS]; //bit per channel in the group, set if it's in phase offset mode
+	static volatile uint8_t fall_pending_mask[NUM_PWM_GROUPS]; //set if the channel's next compare is its falling edge
+
+#if GPIO_CAPTURE
+	//edges handed from each group's ISR (the only writer of the head) to PendSV (the only writer of the tail)
+	static pwm_capture_event_t capture_events[NUM_PWM_GROUPS][PWM_CAPTURE_DEPTH];
+	static volatile uint32_t capture_head[NUM_PWM_GROUPS];
+	static volatile uint32_t capture_tail[NUM_PWM_GROUPS];
+	static Deferred_Work capture_work[NUM_PWM_GROUPS];
+	static void capture_edges(uint8_t group);
+	static void capture_edges_a();
+	static void capture_edges_b();
+#endif
 };
 
 #endif /* BOARD_HAL_INC_APP_HAL_PWM_H_ */
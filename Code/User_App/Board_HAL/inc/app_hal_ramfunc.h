@@ -0,0 +1,57 @@
+/*
+ * app_hal_ramfunc.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Running the hot ISR paths out of SRAM
+ *  At 180MHz flash needs 5 wait states, so any ART accelerator miss in an ISR costs us a stall
+ *  SRAM has zero wait states, so:
+ *   - RAMFUNC puts a function in the .RamFunc section, which the linker script drops in .data (copied out of flash by the startup code)
+ *   - HOT_DATA groups the state those ISRs touch into .hot_data, right at the start of .data
+ *   - `Vector_Table::relocate()` copies the vector table into SRAM and points VTOR at it, so vector fetches don't hit flash either
+ *
+ *  Calls from SRAM back into flash (and vice versa) are out of BL range--the linker patches in long branch veneers for those
+ *  A hot path only pays off if ALL of it is in SRAM, one call out to flash and we're back to eating wait states (plus the veneer), so:
+ *   - the vectors: timer channels, Hard_PWM groups and EXTI lines
+ *   - everything they call directly: the timer/PWM/EXTI class ISRs, Deferred_Work::queue(), Timestamp reads, Input_Event_Queue::push(),
+ *     and the nesting record (`Stack_Monitor::record_nesting()`)
+ *   - the high rate callbacks hung off them: Soft_PWM, the stepper, the soft timer wheel tick, debouncer sampling and the hard stop trip
+ *   - DIO set/clear/read are always inlined instead, so they land in whichever section calls them
+ *  Callbacks called through function pointers don't need a veneer, so nothing at link time catches one left in flash
+ *  Run `Code/Host/tools/check_ramfunc_map.py` on the map file to check placement--it fails on any hot symbol outside
+ *  SRAM and on any veneer the linker had to put in SRAM (i.e. SRAM code branching back out to flash)
+ *
+ *  To run everything straight out of flash instead, set USE_RAMFUNC to 0 here (or pass -DUSE_RAMFUNC=0)
+ */
+
+#ifndef BOARD_HAL_INC_APP_HAL_RAMFUNC_H_
+#define BOARD_HAL_INC_APP_HAL_RAMFUNC_H_
+
+#ifndef USE_RAMFUNC
+#define USE_RAMFUNC 1
+#endif
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+
+#if USE_RAMFUNC
+#define RAMFUNC		__attribute__((section(".RamFunc"), noinline))
+#define HOT_DATA	__attribute__((section(".hot_data")))
+#else
+#define RAMFUNC
+#define HOT_DATA
+#endif
+
+class Vector_Table {
+public:
+	//copy the vector table into SRAM and switch over to it
+	//call this early, before anything starts messing with interrupt vectors; does nothing if USE_RAMFUNC is 0
+	static void relocate();
+
+private:
+	//shouldn't be able to instantiate this class
+	Vector_Table(){};
+};
+
+#endif /* BOARD_HAL_INC_APP_HAL_RAMFUNC_H_ */
@@ -0,0 +1,98 @@
+/*
+ * app_hal_stack_monitor.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Main stack high-water mark
+ *  Everything (main context and every nested ISR) runs on the one main stack, reserved as the last _Min_Stack_Size bytes of RAM
+ *   - `stack_paint()` fills the unused part of that region with a known pattern, first thing in `main()`
+ *   - `get_high_water()` scans up from the bottom of the region until it hits a word that's been overwritten
+ *     the mark only ever moves down, so the scan costs one load per still-untouched word
+ *  The heap can't grow into the reserved region (see `_sbrk()`), so the pattern only ever gets disturbed by the stack
+ *  If the stack ever blows past the reserved region, the mark reads as the full size--treat that as an overflow
+ *
+ *  Nesting depth: how many exception handlers were stacked up at once, and at which NVIC priorities
+ *   - `NESTING_SAMPLE()` at the top of a handler counts the active bits in NVIC->IABR and SCB->SHCSR, so it sees
+ *     EVERY handler underneath it (UART, faults, SysTick...), not just the ones that sample
+ *   - every handler the app owns samples (timer channels, Hard_PWM groups, EXTI lines, PendSV, SysTick), so the deepest
+ *     nest gets seen by whichever of them is on top of it--anything deeper than that would have to be built by handlers
+ *     that never sample, stacked on top of ones that do
+ *   - the sample is a handful of loads and a compare; the priorities only get looked up when the depth beats the record
+ *  With NVIC_PRIORITYGROUP_4 (what `HAL_Init()` sets), only a strictly higher priority can preempt, so depth == bits in the mask
+ *
+ *  To compile the sampling out of the handlers, set NESTING_MONITOR to 0 here (or pass -DNESTING_MONITOR=0)
+ */
+
+#ifndef BOARD_HAL_INC_APP_HAL_STACK_MONITOR_H_
+#define BOARD_HAL_INC_APP_HAL_STACK_MONITOR_H_
+
+#ifndef NESTING_MONITOR
+#define NESTING_MONITOR 1
+#endif
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "app_hal_ramfunc.h"
+
+#define STACK_PAINT_PATTERN 0xC5C5C5C5UL
+#define STACK_PAINT_MARGIN_WORDS 16 //leave this much below the live stack pointer alone while painting
+
+#define NESTING_DEPTH_SHIFT 16 //priority mask fits under this, one bit per level
+#define NVIC_ACTIVE_WORDS ((FMPI2C1_ER_IRQn >> 5) + 1) //IABR words that have any IRQs behind them
+//system handlers that show up as active in SHCSR (HardFault and NMI don't, and we're not going to be reporting from those)
+#define SHCSR_ACTIVE_MASK (SCB_SHCSR_MEMFAULTACT_Msk | SCB_SHCSR_BUSFAULTACT_Msk | SCB_SHCSR_USGFAULTACT_Msk | \
+		SCB_SHCSR_SVCALLACT_Msk | SCB_SHCSR_MONITORACT_Msk | SCB_SHCSR_PENDSVACT_Msk | SCB_SHCSR_SYSTICKACT_Msk)
+
+class Stack_Monitor {
+public:
+	static uint32_t get_size(); //bytes reserved for the main stack
+	static uint32_t get_high_water(); //most bytes of stack ever used
+
+	/*
+	 * blocking telemetry dump--call this from main context
+	 * stack,<high water bytes>,<reserved bytes>
+	 * nesting,<max handler depth>,<mask of the priorities active at the time, bit N = priority N>
+	 */
+	static void report(UART_HandleTypeDef *huart);
+
+	//deepest nesting seen since the last clear, and the priorities active at that point (bit N = priority N)
+	static uint32_t get_max_nesting(uint32_t *priority_mask);
+	static void clear_nesting();
+
+	//count everything that's active right now, and hang on to it if it's the deepest yet--call from handlers through `NESTING_SAMPLE()`
+	static inline __attribute__((always_inline)) void sample_nesting() {
+		uint32_t depth = count_bits(SCB->SHCSR & SHCSR_ACTIVE_MASK);
+		for(uint32_t i = 0; i < NVIC_ACTIVE_WORDS; i++) depth += count_bits(NVIC->IABR[i]);
+		if(depth > (Stack_Monitor::nesting_record >> NESTING_DEPTH_SHIFT)) Stack_Monitor::record_nesting(depth);
+	}
+
+private:
+	//shouldn't be able to instantiate this class
+	Stack_Monitor(){};
+
+	//one pass per set bit--there's hardly ever more than a couple, and no popcount instruction (or libgcc call out to flash)
+	static inline __attribute__((always_inline)) uint32_t count_bits(uint32_t word) {
+		uint32_t count = 0;
+		for(; word; word &= word - 1) count++;
+		return count;
+	}
+
+	static void RAMFUNC record_nesting(uint32_t depth);
+
+	//depth in the top half, priority mask in the bottom, so the pair goes in with one LDREX/STREX and reads back in one load
+	static volatile uint32_t nesting_record;
+};
+
+#if NESTING_MONITOR
+#define NESTING_SAMPLE()	Stack_Monitor::sample_nesting()
+#else
+#define NESTING_SAMPLE()
+#endif
+
+//called at the very top of main(), before anything else has touched the stack
+extern "C" {
+	void stack_paint(void);
+}
+
+#endif /* BOARD_HAL_INC_APP_HAL_STACK_MONITOR_H_ */
@@ -0,0 +1,57 @@
+/*
+ * app_hal_timestamp.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  64-bit monotonic timestamps with ~11ns resolution
+ *  Built off of a free-running 32-bit hardware timer (TIM5 at 90MHz) that we extend to 64 bits in software
+ *
+ *  The overflow extension is lock-free, so `now_ticks()` can be called from main or from an ISR at ANY priority:
+ *   - we keep a 32-bit state word: upper 31 bits count counter wraps, bit 0 remembers the counter MSB when last seen
+ *   - a reader that sees the MSB go from 1 -> 0 knows the counter wrapped, and tries to publish that with LDREX/STREX
+ *   - if the STREX fails someone else (an ISR that preempted us) already published the same thing, so we just move on
+ *  The only requirement is that SOMETHING reads the timestamp at least once every half counter period (~23s)
+ *  The SysTick handler calls `timestamp_keepalive()` every ms to guarantee this
+ *
+ *  A read is one APB1 read of the counter plus a handful of ALU ops--the `timestamp_read` benchmark has the measured cost
+ *  For short deltas inside an ISR, `now_ticks32()` is a single peripheral read
+ */
+
+#ifndef BOARD_HAL_INC_APP_HAL_TIMESTAMP_H_
+#define BOARD_HAL_INC_APP_HAL_TIMESTAMP_H_
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "app_hal_ramfunc.h"
+
+class Timestamp {
+public:
+	static void init(); //call this before reading any timestamps
+
+	//aggressively optimize these since they'll be called from ISRs
+	static uint64_t RAMFUNC __attribute__((optimize("O3"))) now_ticks(); //full 64-bit timestamp in timer ticks
+	static uint32_t RAMFUNC __attribute__((optimize("O3"))) now_ticks32(); //raw counter, good for deltas under ~47s
+	static uint64_t now_us();
+	static uint64_t now_ns();
+
+	static uint64_t ticks_to_us(uint64_t ticks);
+	static uint64_t ticks_to_ns(uint64_t ticks);
+	static uint32_t get_tick_freq();
+
+	static void keepalive(); //just a timestamp read that throws away the result
+
+private:
+	//shouldn't be able to instantiate this class
+	Timestamp(){};
+
+	static volatile uint32_t extension_state; //wrap count in the upper 31 bits, last seen counter MSB in bit 0
+	static bool initialized;
+};
+
+//called from the SysTick handler to make sure the overflow extension never misses a wrap
+extern "C" {
+	void timestamp_keepalive(void);
+}
+
+#endif /* BOARD_HAL_INC_APP_HAL_TIMESTAMP_H_ */
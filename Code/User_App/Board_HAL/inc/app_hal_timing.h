@@ -17,6 +17,8 @@ extern "C" {
 	#include "stm32f446xx.h" //need this for the IRQn_type
 }
 #include "app_hal_int_utils.h"
+#include "app_hal_deferred.h"
+#include "app_hal_ramfunc.h"
 
 typedef struct {
 	callback_function_t init_func; //not a callback function, but has the same signature so just gonna use this typedef
@@ -28,7 +30,8 @@ typedef struct {
 typedef enum Timer_Channels {
 	CHANNEL_0 = 0,
 	CHANNEL_1 = 1,
-	CHANNEL_2 = 2
+	CHANNEL_2 = 2,
+	CHANNEL_3 = 3
 } timer_channel_t;
 
 //have a very explicit struct named by tick frequency to
@@ -37,6 +40,24 @@ typedef struct {
 	uint16_t auto_reload;
 } timer_freq_t;
 
+//deadline bookkeeping for a timer channel, all times are in timer ticks since the compare event
+//the counts are kept right in the ISR; the maxima come from a raw sample the ISR hands off each period,
+//tallied from PendSV (so they lag the ISR a little, and miss the periods PendSV couldn't keep up with)
+typedef struct {
+	uint32_t overruns; //number of times the compare flag re-asserted before the callback finished
+	uint32_t worst_latency; //longest time from the compare event to entering the ISR
+	uint32_t worst_completion; //longest time from the compare event to the callback returning
+	uint32_t dropped_samples; //periods left out of the maxima because PendSV couldn't keep up
+} timer_overrun_stats_t;
+
+#define TIMER_STATS_DEPTH 8 //samples each channel can have waiting to be tallied, has to be a power of 2
+
+//one period's worth of raw deadline numbers, straight out of the ISR
+typedef struct {
+	uint32_t latency;
+	uint32_t completion;
+} timer_deadline_sample_t;
+
 class Timer {
 public:
 	Timer(timer_channel_t _channel);
@@ -45,14 +66,19 @@ public:
 	void set_freq(timer_freq_t freq);
 	void set_phase(float phase);
 	void set_callback_func(callback_function_t cb);
+	//called right from the ISR whenever the callback blows its deadline, so the app can shed work before the next period
+	//pass `deferred` to run it from PendSV instead--ONLY if the overrun can't persist, PendSV never runs while a callback keeps overrunning
+	void set_overrun_func(callback_function_t cb, bool deferred = false);
 	void set_int_priority(int_priority_t prio);
 	void enable_int();
-	void disable_int();
+	void RAMFUNC disable_int();
 	void enable_tim();
-	void disable_tim();
+	void RAMFUNC disable_tim();
 
 	float get_freq();
 	float get_tim_fclk();
+	timer_overrun_stats_t get_overrun_stats();
+	void clear_overrun_stats();
 
 	static void delay_ms(uint32_t ms);
 	static uint32_t get_ms();
@@ -62,7 +88,7 @@ public:
 	//if this is optimized hard enough, the array indexing should hopefully unroll and be
 	//as fast as if we had individual ISRs for each timer channel
 	//NOTE FOR PORTING: APP WILL NEVER CALL THIS FUNCTION, SO IMPLEMENT HOW YOU'D LIKE
-	static void __attribute__((optimize("O3"))) ISR_func(int channel);
+	static void RAMFUNC __attribute__((optimize("O3"))) ISR_func(int channel);
 
 	//=================== section here just to declare frequency presets ======================
 	static const timer_freq_t FREQ_200kHz;
@@ -89,10 +115,59 @@ public:
 
 
 private:
+	friend class TimerGroup; //group needs to get at the timer registers to start everything in lockstep
+
 	static const timer_config_struct_t timer_chan_configs[];
 	static callback_function_t callbacks[];
+	static callback_function_t overrun_callbacks[];
+	static Deferred_Work overrun_work[];
+	static volatile bool overrun_deferred[];
+	static volatile timer_overrun_stats_t overrun_stats[];
+
+	//deadline samples handed from each channel's ISR (the only writer of the head) to its tally (the only writer of the tail)
+	static timer_deadline_sample_t stats_samples[][TIMER_STATS_DEPTH];
+	static volatile uint32_t stats_head[];
+	static volatile uint32_t stats_tail[];
+	static Deferred_Work stats_work[];
+	static void tally_stats(int channel);
+	static void RAMFUNC __attribute__((optimize("O3"))) count(volatile uint32_t &counter);
+	static void tally_chan_0();
+	static void tally_chan_1();
+	static void tally_chan_2();
+	static void tally_chan_3();
 
 	int channel; //which channel the particular instance is mapped to
+	float phase = 0; //fraction of a period the counter is seeded ahead by when the timer starts
+};
+
+/*
+ * Starts a group of timers on (effectively) the same clock edge so the phase offsets set by `Timer::set_phase()` hold exactly
+ * Starting timers one after the other with `enable_tim()` lets them drift apart by however many cycles elapse between calls
+ *
+ * Our timer channels don't all have slave mode controllers to chain triggers (TIM11/TIM14 don't), so instead:
+ *  - everything gets stopped and reloaded with an update event (which also latches any pending PSC/ARR writes)
+ *  - the counter seeds and CR1 words are all computed ahead of time
+ *  - the CR1 writes then go out back-to-back with interrupts masked
+ *  - each counter seed is advanced by the timer ticks that elapse before its CR1 write actually lands,
+ *    timed with the DWT cycle counter on a dry run of the same write loop and rounded to the nearest tick
+ *
+ * As with Soft_PWM, pass the number of timers and not just the size_of() array!
+ */
+#define TIMER_GROUP_MAX_TIMERS 4 //one per timer channel
+
+class TimerGroup {
+public:
+	TimerGroup(Timer *_timers[], const uint32_t _num_timers);
+
+	void start();
+	void stop();
+
+	//counter value that starts a timer `phase` of a period ahead, having started `lag_cycles` CPU cycles late
+	static uint32_t phase_seed(const float phase, const uint32_t arr, const uint32_t psc, const uint32_t lag_cycles);
+
+private:
+	Timer *timers[TIMER_GROUP_MAX_TIMERS];
+	uint32_t num_timers;
 };
 
 #endif /* BOARD_HAL_INC_APP_HAL_TIMING_H_ */
@@ -0,0 +1,100 @@
+/*
+ * app_hal_trace.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Opt-in flight recorder for field debugging under load
+ *  A fixed-size ring of compact binary records that any ISR can write to in a few cycles, without locks:
+ *   - a slot gets claimed (and timestamped) in a single LDREX/STREX loop, so nested writers always land in time order
+ *   - the ring just overwrites the oldest records, so it always holds the most recent TRACE_DEPTH events
+ *  Drop `TRACE(id, arg)` wherever you want an event--it compiles out to nothing when tracing is disabled
+ *
+ *  Dump format (all little endian), sent over the UART by `dump()`:
+ *   header, 16 bytes:
+ *     char[4]   magic "QSTR"
+ *     uint16    format version (1)
+ *     uint16    record size in bytes (8)
+ *     uint32    timestamp tick frequency in Hz
+ *     uint32    number of records that follow
+ *   records, oldest first, 8 bytes each:
+ *     uint32    raw timestamp counter (TIM5, wraps every ~47s--take deltas between consecutive records)
+ *     uint16    event ID (`trace_event_t`)
+ *     uint16    argument, meaning depends on the event (see below)
+ *  `Code/Host/tools/trace_decode.py` turns a raw UART capture of the dump into a text timeline, or Chrome trace JSON for Perfetto
+ *
+ *  To enable, set TRACING to 1 here (or pass -DTRACING=1)
+ */
+
+#ifndef BOARD_HAL_INC_APP_HAL_TRACE_H_
+#define BOARD_HAL_INC_APP_HAL_TRACE_H_
+
+#ifndef TRACING
+#define TRACING 0
+#endif
+
+#define TRACE_DEPTH 1024 //records, has to be a power of 2
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "stdbool.h"
+#include "app_hal_timestamp.h"
+
+//event IDs--ADD NEW EVENTS AT THE END so old dumps still decode
+typedef enum Trace_Events {
+	TRACE_TIMER_ISR_ENTER = 0,	//arg: timer channel
+	TRACE_TIMER_ISR_EXIT,		//arg: timer channel
+	TRACE_TIMER_OVERRUN,		//arg: timer channel--logged when PendSV tallies the overrun, not when it happened
+	TRACE_PWM_ISR_ENTER,		//arg: (group << 8) | pending SR flags (UIF, CC1IF-CC4IF)
+	TRACE_PWM_ISR_EXIT,			//arg: group (0 = A, 1 = B)
+	TRACE_DEBOUNCE_EDGE,		//arg: (port index << 5) | (pin << 1) | new state
+	TRACE_HARD_STOP_TRIP		//arg: (port index << 4) | pin of the stop input
+} trace_event_t;
+
+typedef struct {
+	uint32_t timestamp;
+	uint16_t id;
+	uint16_t arg;
+} trace_record_t;
+
+class Trace {
+public:
+	static void start(); //clears the ring and starts recording
+	static void stop();
+
+	//blocking binary dump of the ring (oldest first), in the format described above--call this from main context
+	//stops tracing while it runs, then picks back up where it was
+	static void dump(UART_HandleTypeDef *huart);
+
+	static inline __attribute__((always_inline)) void record(const uint16_t id, const uint16_t arg) {
+		if(!Trace::running) return;
+
+		//if anything preempts us the STREX fails, and we retry with a fresh (later) timestamp
+		uint32_t index, timestamp;
+		do {
+			index = __LDREXW(&Trace::head);
+			timestamp = Timestamp::now_ticks32();
+		} while(__STREXW(index + 1, &Trace::head));
+
+		trace_record_t &rec = Trace::ring[index & (TRACE_DEPTH - 1)];
+		rec.timestamp = timestamp;
+		rec.id = id;
+		rec.arg = arg;
+	}
+
+private:
+	//shouldn't be able to instantiate this class
+	Trace(){};
+
+	static trace_record_t ring[TRACE_DEPTH];
+	static volatile uint32_t head; //total records ever written since `start()`
+	static volatile bool running;
+};
+
+#if TRACING
+#define TRACE(id, arg)	Trace::record((uint16_t)(id), (uint16_t)(arg))
+#else
+#define TRACE(id, arg)
+#endif
+
+#endif /* BOARD_HAL_INC_APP_HAL_TRACE_H_ */
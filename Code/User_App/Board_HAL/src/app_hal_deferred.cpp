@@ -0,0 +1,80 @@
+/*
+ * app_hal_deferred.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "app_hal_deferred.h"
+#include "app_hal_stack_monitor.h"
+
+#define DEFERRED_WORK_PRIORITY 15 //lowest NVIC priority with 4 preemption bits, below everything in `int_priority_t`
+
+//=========================== INITIALIZING STATIC MEMBERS HERE ==========================
+Deferred_Work * volatile Deferred_Work::head = NULL;
+
+Deferred_Work::Deferred_Work(callback_function_t _func): func(_func), next(NULL), queued(0) {}
+
+void Deferred_Work::set_func(callback_function_t _func) {
+	func = _func;
+}
+
+void Deferred_Work::init() {
+	HAL_NVIC_SetPriority(PendSV_IRQn, DEFERRED_WORK_PRIORITY, 0);
+}
+
+bool RAMFUNC __attribute__((optimize("O3"))) Deferred_Work::queue() {
+	//claim the item; if it's already on the list, the pending run will take care of it
+	do {
+		if(__LDREXW(&queued)) {
+			__CLREX();
+			return false;
+		}
+	} while(__STREXW(1, &queued));
+
+	//push onto the front of the list
+	//a failed STREX means another ISR pushed on top of us, go again
+	Deferred_Work *old_head;
+	do {
+		old_head = (Deferred_Work*)(uintptr_t)__LDREXW((volatile uint32_t*)&Deferred_Work::head);
+		next = old_head;
+	} while(__STREXW((uint32_t)(uintptr_t)this, (volatile uint32_t*)&Deferred_Work::head));
+
+	//kick PendSV, it'll run as soon as every higher priority ISR is done
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+	return true;
+}
+
+void Deferred_Work::run_pending() {
+	//keep going until nothing got queued while we were running stuff
+	while(true) {
+		//take the whole list in one shot
+		Deferred_Work *list;
+		do {
+			list = (Deferred_Work*)(uintptr_t)__LDREXW((volatile uint32_t*)&Deferred_Work::head);
+		} while(__STREXW((uint32_t)NULL, (volatile uint32_t*)&Deferred_Work::head));
+		if(list == NULL) return;
+
+		//the list is newest first, flip it so things run in the order they were queued
+		Deferred_Work *ordered = NULL;
+		while(list != NULL) {
+			Deferred_Work *item = list;
+			list = list->next;
+			item->next = ordered;
+			ordered = item;
+		}
+
+		//release each item before running it, so it can re-queue itself
+		while(ordered != NULL) {
+			Deferred_Work *item = ordered;
+			ordered = ordered->next;
+			item->queued = 0;
+			item->func();
+		}
+	}
+}
+
+//================================= PENDSV HANDLER HOOK ===================================
+void deferred_work_handler(void) {
+	NESTING_SAMPLE();
+	Deferred_Work::run_pending();
+}
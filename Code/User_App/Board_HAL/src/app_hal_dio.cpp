@@ -10,8 +10,6 @@ extern "C" {
 	#include "gpio.h"
 }
 
-#define BSRR_BASE_REG		0x40020018UL
-#define IDR_BASE_REG		0x40020010UL
 #define CLEAR_DATA_OFFSET 	16
 #define SET_DATA_OFFSET 	0
 
@@ -20,10 +18,10 @@ DIO::DIO(const dio_pin_t &pin_name):
 		DRIVE_HIGH_MASK(1 << (pin_name.pin + SET_DATA_OFFSET)),
 		DRIVE_LOW_MASK(1 << (pin_name.pin + CLEAR_DATA_OFFSET)),
 		READ_MASK(1 << pin_name.pin),
-		port_BSRR((volatile uint32_t*) (BSRR_BASE_REG + (uint32_t)pin_name.port)),
-		port_IDR((volatile uint32_t*) (IDR_BASE_REG + (uint32_t)pin_name.port))
+		port_BSRR(&DIO::port_regs(pin_name.port)->BSRR),
+		port_IDR(&DIO::port_regs(pin_name.port)->IDR)
 {
-	//the bit set/reset register corresponds to the BSRR base register plus the port offset
+	//the bit set/reset register lives in the register block of the pin's port
 	//encode the port offset into the port enumeration
 	//same thing goes with the input data register
 }
@@ -32,16 +30,16 @@ void DIO::init() {
 	MX_GPIO_Init();
 }
 
-void DIO::set() const {
-	*port_BSRR = DRIVE_HIGH_MASK;
+GPIO_TypeDef *DIO::port_regs(const gpio_port_t port) {
+	//port enum values are offsets from GPIOA
+	//going through the CMSIS `GPIOA` definition (rather than hardcoding addresses) means an off-target build
+	//only has to point `GPIOA` at its own register model for all of the DIO to follow
+	return (GPIO_TypeDef*)((uintptr_t)GPIOA + (uintptr_t)port);
 }
 
-void DIO::clear() const {
-	*port_BSRR = DRIVE_LOW_MASK;
-}
-
-uint32_t DIO::read() const {
-	return ( (*port_IDR) & READ_MASK );
+uint32_t DIO::read_port(const gpio_port_t port) {
+	//same register as the per-pin IDR pointer, just without masking anything off
+	return DIO::port_regs(port)->IDR;
 }
 
 
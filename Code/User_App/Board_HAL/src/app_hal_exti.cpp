@@ -0,0 +1,137 @@
+/*
+ * app_hal_exti.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "app_hal_exti.h"
+#include "app_hal_stack_monitor.h"
+
+#define EXTICR_BITS_PER_LINE	4
+#define EXTICR_LINES_PER_REG	4
+#define GPIO_PORT_SPACING		0x400 //port enum values are offsets, EXTICR wants port indices
+
+//=========================== INITIALIZING STATIC MEMBERS HERE ==========================
+void empty_exti_handler(uint32_t line);
+
+exti_callback_function_t Ext_Int::callbacks[NUM_EXTI_LINES] = {
+		empty_exti_handler, empty_exti_handler, empty_exti_handler, empty_exti_handler,
+		empty_exti_handler, empty_exti_handler, empty_exti_handler, empty_exti_handler,
+		empty_exti_handler, empty_exti_handler, empty_exti_handler, empty_exti_handler,
+		empty_exti_handler, empty_exti_handler, empty_exti_handler, empty_exti_handler
+};
+
+//======================= PUBLIC FUNCTION DEFINITIONS =========================
+uint32_t Ext_Int::attach(const dio_pin_t &pin, exti_edge_t edges, int_priority_t prio, exti_callback_function_t cb) {
+	uint32_t line = pin.pin;
+	uint32_t line_mask = 1UL << line;
+
+	//keep the line quiet while we reconfigure it
+	EXTI->IMR &= ~line_mask;
+	Ext_Int::callbacks[line] = cb;
+
+	//route the line to the port the pin lives on
+	__HAL_RCC_SYSCFG_CLK_ENABLE();
+	uint32_t exticr_shift = (line % EXTICR_LINES_PER_REG) * EXTICR_BITS_PER_LINE;
+	uint32_t exticr = SYSCFG->EXTICR[line / EXTICR_LINES_PER_REG];
+	exticr &= ~(0xFUL << exticr_shift);
+	exticr |= ((uint32_t)pin.port / GPIO_PORT_SPACING) << exticr_shift;
+	SYSCFG->EXTICR[line / EXTICR_LINES_PER_REG] = exticr;
+
+	//select the edges
+	if(edges & EDGE_RISING) EXTI->RTSR |= line_mask;
+	else EXTI->RTSR &= ~line_mask;
+	if(edges & EDGE_FALLING) EXTI->FTSR |= line_mask;
+	else EXTI->FTSR &= ~line_mask;
+
+	//configure the NVIC, then unmask the line
+	IRQn_Type irq = Ext_Int::line_to_irq(line);
+	HAL_NVIC_SetPriority(irq, (uint32_t)prio, 0);
+	HAL_NVIC_ClearPendingIRQ(irq);
+	HAL_NVIC_EnableIRQ(irq);
+	Ext_Int::enable(line);
+
+	return line;
+}
+
+void Ext_Int::detach(uint32_t line) {
+	if(line >= NUM_EXTI_LINES) return;
+
+	//don't disable the NVIC channel since other lines might be sharing it
+	Ext_Int::disable(line);
+	EXTI->RTSR &= ~(1UL << line);
+	EXTI->FTSR &= ~(1UL << line);
+	Ext_Int::callbacks[line] = empty_exti_handler;
+}
+
+void Ext_Int::enable(uint32_t line) {
+	//throw away anything that got latched while we weren't listening, then unmask
+	EXTI->PR = 1UL << line;
+	EXTI->IMR |= 1UL << line;
+}
+
+void RAMFUNC Ext_Int::disable(uint32_t line) {
+	EXTI->IMR &= ~(1UL << line);
+}
+
+//================================== EXTI CLASS INTERRUPT SERVICE ROUTINE ===================================
+void RAMFUNC __attribute__((optimize("O3"))) Ext_Int::ISR_func(uint32_t first_line, uint32_t last_line) {
+	NESTING_SAMPLE();
+
+	//only service the lines this vector covers, and only the ones we're actually listening to
+	uint32_t range_mask = ((2UL << last_line) - 1) & ~((1UL << first_line) - 1);
+	uint32_t pending = EXTI->PR & EXTI->IMR & range_mask;
+	EXTI->PR = pending; //write 1 to clear
+
+	//walk the pending lines lowest first
+	while(pending) {
+		uint32_t line = __CLZ(__RBIT(pending));
+		pending &= pending - 1;
+		Ext_Int::callbacks[line](line);
+	}
+}
+
+//=============================== PRIVATE FUNCTION DEFS ==========================
+IRQn_Type Ext_Int::line_to_irq(uint32_t line) {
+	switch(line) {
+		case 0: return EXTI0_IRQn;
+		case 1: return EXTI1_IRQn;
+		case 2: return EXTI2_IRQn;
+		case 3: return EXTI3_IRQn;
+		case 4: return EXTI4_IRQn;
+		default: break;
+	}
+	if(line <= 9) return EXTI9_5_IRQn;
+	return EXTI15_10_IRQn;
+}
+
+//======================================= EXTI ISRs MAPPED TO VECTOR TABLE ===================================
+void RAMFUNC EXTI0_IRQHandler(void) {
+	Ext_Int::ISR_func(0, 0);
+}
+
+void RAMFUNC EXTI1_IRQHandler(void) {
+	Ext_Int::ISR_func(1, 1);
+}
+
+void RAMFUNC EXTI2_IRQHandler(void) {
+	Ext_Int::ISR_func(2, 2);
+}
+
+void RAMFUNC EXTI3_IRQHandler(void) {
+	Ext_Int::ISR_func(3, 3);
+}
+
+void RAMFUNC EXTI4_IRQHandler(void) {
+	Ext_Int::ISR_func(4, 4);
+}
+
+void RAMFUNC EXTI9_5_IRQHandler(void) {
+	Ext_Int::ISR_func(5, 9);
+}
+
+void RAMFUNC EXTI15_10_IRQHandler(void) {
+	Ext_Int::ISR_func(10, 15);
+}
+
+void empty_exti_handler(uint32_t line) {}
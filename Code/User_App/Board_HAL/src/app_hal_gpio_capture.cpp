@@ -0,0 +1,205 @@
+/*
+ * app_hal_gpio_capture.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "app_hal_gpio_capture.h"
+#include "stdio.h"
+
+#define DUMP_LINE_LENGTH 64
+#define DUMP_TIMEOUT_MS 100
+#define VCD_FIRST_ID '!' //VCD identifiers are printable ASCII starting here
+
+//=========================== INITIALIZING STATIC MEMBERS HERE ==========================
+gpio_capture_record_t GPIO_Capture::buffer[GPIO_CAPTURE_DEPTH];
+volatile uint32_t GPIO_Capture::write_index = 0;
+volatile bool GPIO_Capture::running = false;
+
+void GPIO_Capture::start() {
+	GPIO_Capture::running = false;
+	GPIO_Capture::write_index = 0;
+	__DMB(); //make sure nobody sees the old index with the new run flag
+	GPIO_Capture::running = true;
+}
+
+void GPIO_Capture::stop() {
+	GPIO_Capture::running = false;
+
+	//anything from `record_at()` is only a little out of place, so an insertion sort is about one pass
+	//compare as signed deltas so a wrap of the timestamp counter mid-capture still sorts right
+	uint32_t count = GPIO_Capture::get_count();
+	for(uint32_t i = 1; i < count; i++) {
+		gpio_capture_record_t rec = GPIO_Capture::buffer[i];
+		uint32_t j = i;
+		while(j > 0 && (int32_t)(rec.timestamp - GPIO_Capture::buffer[j - 1].timestamp) < 0) {
+			GPIO_Capture::buffer[j] = GPIO_Capture::buffer[j - 1];
+			j--;
+		}
+		GPIO_Capture::buffer[j] = rec;
+	}
+}
+
+bool GPIO_Capture::is_running() {
+	return GPIO_Capture::running;
+}
+
+uint32_t GPIO_Capture::get_count() {
+	uint32_t count = GPIO_Capture::write_index;
+	return (count > GPIO_CAPTURE_DEPTH) ? GPIO_CAPTURE_DEPTH : count;
+}
+
+gpio_capture_metrics_t GPIO_Capture::analyze(const dio_pin_t &pin) {
+	gpio_capture_metrics_t metrics = {0, 0, 0, 0, 0, 0, 0, 0};
+	uint8_t line = GPIO_Capture::line_of(pin);
+
+	bool have_level = false, level = false;
+	bool have_rise = false, have_fall = false, fell_this_period = false;
+	uint32_t last_rise = 0, last_fall = 0;
+	uint32_t period_min = 0xFFFFFFFF, period_max = 0, min_pulse = 0xFFFFFFFF;
+	uint64_t period_total = 0, high_total = 0;
+
+	uint32_t count = GPIO_Capture::get_count();
+	for(uint32_t i = 0; i < count; i++) {
+		gpio_capture_record_t &rec = GPIO_Capture::buffer[i];
+		if(rec.line != line) continue;
+
+		//only care about actual level changes
+		bool new_level = rec.level;
+		if(have_level && new_level == level) continue;
+		bool first_write = !have_level;
+		have_level = true;
+		level = new_level;
+		if(first_write) continue; //don't know what the pin was doing before, not an edge
+		metrics.edges++;
+
+		//timestamp deltas wrap cleanly as long as the capture is under ~47s
+		if(level) {
+			if(have_rise) {
+				uint32_t period = rec.timestamp - last_rise;
+				period_total += period;
+				high_total += fell_this_period ? (last_fall - last_rise) : period;
+				if(period < period_min) period_min = period;
+				if(period > period_max) period_max = period;
+				metrics.periods++;
+			}
+			if(have_fall && (rec.timestamp - last_fall) < min_pulse) min_pulse = rec.timestamp - last_fall;
+			last_rise = rec.timestamp;
+			have_rise = true;
+			fell_this_period = false;
+		}
+		else {
+			if(have_rise && (rec.timestamp - last_rise) < min_pulse) min_pulse = rec.timestamp - last_rise;
+			last_fall = rec.timestamp;
+			have_fall = true;
+			fell_this_period = have_rise;
+		}
+	}
+
+	if(metrics.periods > 0) {
+		metrics.frequency_hz = (float)Timestamp::get_tick_freq() * metrics.periods / (float)period_total;
+		metrics.duty = (float)high_total / (float)period_total;
+		metrics.period_min_ns = (uint32_t)Timestamp::ticks_to_ns(period_min);
+		metrics.period_max_ns = (uint32_t)Timestamp::ticks_to_ns(period_max);
+		metrics.jitter_ns = metrics.period_max_ns - metrics.period_min_ns;
+	}
+	if(min_pulse != 0xFFFFFFFF) metrics.min_pulse_ns = (uint32_t)Timestamp::ticks_to_ns(min_pulse);
+	return metrics;
+}
+
+gpio_capture_skew_t GPIO_Capture::skew(const dio_pin_t &from, const dio_pin_t &to) {
+	gpio_capture_skew_t result = {0, 0, 0x7FFFFFFF, (int32_t)0x80000000};
+	uint8_t from_line = GPIO_Capture::line_of(from);
+	uint8_t to_line = GPIO_Capture::line_of(to);
+
+	//pair every rising edge on `from` with the first rising edge on `to` after it
+	//if `from` rises again before `to` does, the newer edge takes over
+	bool from_level = false, to_level = false, pending = false;
+	uint32_t from_rise = 0;
+	int64_t total = 0;
+
+	uint32_t count = GPIO_Capture::get_count();
+	for(uint32_t i = 0; i < count; i++) {
+		gpio_capture_record_t &rec = GPIO_Capture::buffer[i];
+		bool rising = false;
+		if(rec.line == from_line) {
+			rising = rec.level && !from_level;
+			from_level = rec.level;
+			if(rising) {
+				from_rise = rec.timestamp;
+				pending = true;
+			}
+		}
+		if(rec.line == to_line) {
+			rising = rec.level && !to_level;
+			to_level = rec.level;
+			if(rising && pending) {
+				int32_t delta = (int32_t)Timestamp::ticks_to_ns(rec.timestamp - from_rise);
+				total += delta;
+				if(delta < result.min_ns) result.min_ns = delta;
+				if(delta > result.max_ns) result.max_ns = delta;
+				result.pairs++;
+				pending = false;
+			}
+		}
+	}
+
+	if(result.pairs > 0) result.mean_ns = (int32_t)(total / result.pairs);
+	else result.min_ns = result.max_ns = 0;
+	return result;
+}
+
+/*
+ * Standard VCD, 1ns timescale, time 0 at the first record
+ * one 1-bit wire per pin that shows up in the capture, named like "PA5"
+ * only actual level changes are written out
+ */
+void GPIO_Capture::dump_vcd(UART_HandleTypeDef *huart) {
+	char line[DUMP_LINE_LENGTH];
+	int len;
+
+	//figure out which pins we need wires for, and give each one an identifier
+	uint8_t ids[GPIO_CAPTURE_NUM_LINES] = {0};
+	int8_t levels[GPIO_CAPTURE_NUM_LINES]; //-1 until the first write
+	uint8_t next_id = VCD_FIRST_ID;
+	uint32_t count = GPIO_Capture::get_count();
+	for(uint32_t i = 0; i < GPIO_CAPTURE_NUM_LINES; i++) levels[i] = -1;
+	for(uint32_t i = 0; i < count; i++) {
+		uint8_t l = GPIO_Capture::buffer[i].line;
+		if(ids[l] == 0) ids[l] = next_id++;
+	}
+
+	len = snprintf(line, DUMP_LINE_LENGTH, "$timescale 1ns $end\n$scope module gpio $end\n");
+	HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+	for(uint32_t l = 0; l < GPIO_CAPTURE_NUM_LINES; l++) {
+		if(ids[l] == 0) continue;
+		len = snprintf(line, DUMP_LINE_LENGTH, "$var wire 1 %c P%c%lu $end\n",
+				ids[l], (char)('A' + (l >> 4)), (unsigned long)(l & 0xF));
+		HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+	}
+	len = snprintf(line, DUMP_LINE_LENGTH, "$upscope $end\n$enddefinitions $end\n");
+	HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+	if(count == 0) return;
+
+	uint32_t start = GPIO_Capture::buffer[0].timestamp;
+	uint64_t last_time = 0xFFFFFFFFFFFFFFFF;
+	for(uint32_t i = 0; i < count; i++) {
+		gpio_capture_record_t &rec = GPIO_Capture::buffer[i];
+		if(levels[rec.line] == (int8_t)rec.level) continue;
+		levels[rec.line] = rec.level;
+
+		//changes at the same time go under one time marker
+		//printing the time in two halves since printf doesn't do 64-bit here
+		len = 0;
+		uint64_t time = Timestamp::ticks_to_ns(rec.timestamp - start);
+		if(time != last_time) {
+			uint32_t secs = (uint32_t)(time / 1000000000ULL);
+			uint32_t nanos = (uint32_t)(time % 1000000000ULL);
+			if(secs) len = snprintf(line, DUMP_LINE_LENGTH, "#%lu%09lu\n", (unsigned long)secs, (unsigned long)nanos);
+			else len = snprintf(line, DUMP_LINE_LENGTH, "#%lu\n", (unsigned long)nanos);
+			last_time = time;
+		}
+		len += snprintf(line + len, DUMP_LINE_LENGTH - len, "%c%c\n", rec.level ? '1' : '0', ids[rec.line]);
+		HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+	}
+}
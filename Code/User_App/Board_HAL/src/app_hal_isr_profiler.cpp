@@ -0,0 +1,100 @@
+/*
+ * app_hal_isr_profiler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "app_hal_isr_profiler.h"
+#include "app_hal_timestamp.h"
+#include "stdio.h"
+
+#define CPU_CYCLES_PER_TIMESTAMP_TICK 2 //180MHz core, 90MHz timestamp timer
+#define DUMP_LINE_LENGTH 160
+#define DUMP_TIMEOUT_MS 100
+
+//names that show up in the UART dump, in the same order as `isr_profile_id_t`
+static const char *isr_names[NUM_PROFILED_ISRS] = {
+		"tim_chan_0",
+		"tim_chan_1",
+		"tim_chan_2",
+		"tim_chan_3",
+		"pwm_grp_a",
+		"pwm_grp_b"
+};
+
+//=========================== INITIALIZING STATIC MEMBERS HERE ==========================
+volatile uint32_t ISR_Profiler::preempted_cycles = 0;
+isr_profile_stats_t ISR_Profiler::stats[NUM_PROFILED_ISRS];
+uint64_t ISR_Profiler::clear_time = 0;
+
+void ISR_Profiler::init() {
+	//turn on the trace block, then start the cycle counter from 0
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	ISR_Profiler::clear();
+}
+
+void ISR_Profiler::clear() {
+	//mask interrupts so nobody records into a half-cleared struct
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	for(uint32_t i = 0; i < NUM_PROFILED_ISRS; i++) {
+		ISR_Profiler::stats[i].count = 0;
+		ISR_Profiler::stats[i].min_cycles = 0xFFFFFFFF;
+		ISR_Profiler::stats[i].max_cycles = 0;
+		ISR_Profiler::stats[i].total_cycles = 0;
+		for(uint32_t j = 0; j < ISR_PROFILE_NUM_BUCKETS; j++)
+			ISR_Profiler::stats[i].histogram[j] = 0;
+	}
+	ISR_Profiler::clear_time = Timestamp::now_ticks();
+	__set_PRIMASK(primask);
+}
+
+isr_profile_stats_t ISR_Profiler::get_stats(isr_profile_id_t id) {
+	//copy with interrupts masked so we get a consistent snapshot
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	isr_profile_stats_t snapshot = ISR_Profiler::stats[id];
+	__set_PRIMASK(primask);
+	return snapshot;
+}
+
+uint32_t ISR_Profiler::get_load_centipercent(isr_profile_id_t id) {
+	uint64_t elapsed_cycles = (Timestamp::now_ticks() - ISR_Profiler::clear_time) * CPU_CYCLES_PER_TIMESTAMP_TICK;
+	if(elapsed_cycles == 0) return 0;
+	return (uint32_t)((ISR_Profiler::get_stats(id).total_cycles * 10000) / elapsed_cycles);
+}
+
+const char *ISR_Profiler::get_name(isr_profile_id_t id) {
+	return isr_names[id];
+}
+
+/*
+ * Dump format, one line per ISR:
+ * <name>,<count>,<min>,<max>,<mean>,<load in 0.01%>,<bucket>:<hits>,<bucket>:<hits>...
+ * only non-empty histogram buckets are printed to keep things compact
+ */
+void ISR_Profiler::dump(UART_HandleTypeDef *huart) {
+	char line[DUMP_LINE_LENGTH];
+
+	for(uint32_t i = 0; i < NUM_PROFILED_ISRS; i++) {
+		isr_profile_stats_t snapshot = ISR_Profiler::get_stats((isr_profile_id_t)i);
+		uint32_t mean = snapshot.count ? (uint32_t)(snapshot.total_cycles / snapshot.count) : 0;
+		uint32_t min = snapshot.count ? snapshot.min_cycles : 0;
+
+		int len = snprintf(line, DUMP_LINE_LENGTH, "%s,%lu,%lu,%lu,%lu,%lu",
+				isr_names[i], (unsigned long)snapshot.count, (unsigned long)min, (unsigned long)snapshot.max_cycles,
+				(unsigned long)mean, (unsigned long)ISR_Profiler::get_load_centipercent((isr_profile_id_t)i));
+
+		for(uint32_t j = 0; j < ISR_PROFILE_NUM_BUCKETS; j++) {
+			if(snapshot.histogram[j] == 0) continue;
+			if(len >= DUMP_LINE_LENGTH - 16) break; //ran out of room, drop the rest of the histogram
+			len += snprintf(line + len, DUMP_LINE_LENGTH - len, ",%lu:%lu", (unsigned long)j, (unsigned long)snapshot.histogram[j]);
+		}
+		len += snprintf(line + len, DUMP_LINE_LENGTH - len, "\r\n");
+
+		HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+	}
+}
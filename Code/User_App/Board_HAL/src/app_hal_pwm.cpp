@@ -6,11 +6,14 @@
  */
 
 #include "app_hal_pwm.h"
+#include "app_hal_isr_profiler.h"
+#include "app_hal_stack_monitor.h"
+#include "app_hal_trace.h"
+#include "app_hal_gpio_capture.h"
 extern "C" {
 	#include "tim.h"
 }
 
-#define CHANNEL_NOT_MAPPED 0xFF
 #define PWM_RESOLUTION	100.0f //have 100 levels of PWM granularity
 
 //========================= TIMER MAPPINGS ============================
@@ -18,23 +21,92 @@ extern "C" {
 #define PWM_A_TIM 				htim2
 #define PWM_A_IRQn				TIM2_IRQn
 #define PWM_A_IRQ_HANDLER		TIM2_IRQHandler
+#define PWM_A_AF				GPIO_AF1_TIM2
 
 #define PWM_B_INIT_FUNC			MX_TIM3_Init
 #define PWM_B_TIM 				htim3
 #define PWM_B_IRQn				TIM3_IRQn
 #define PWM_B_IRQ_HANDLER		TIM3_IRQHandler
+#define PWM_B_AF				GPIO_AF2_TIM3
+
+#define MODER_BITS_PER_PIN	2
+#define MODER_OUTPUT		1UL
+#define MODER_AF			2UL
+#define AFR_BITS_PER_PIN	4
+#define AFR_PINS_PER_REG	8
+#define CCER_BITS_PER_CHAN	4
+#define CCMR_BITS_PER_CHAN	8
+#define CCMR_CHANS_PER_REG	2
 
 #define DEASSERT(index)			Hard_PWM::channel_inverted[index] ? Hard_PWM::pwm_pins[index]->set(): Hard_PWM::pwm_pins[index]->clear()
 #define ASSERT(index)			Hard_PWM::channel_inverted[index] ? Hard_PWM::pwm_pins[index]->clear(): Hard_PWM::pwm_pins[index]->set()
 
+//============================ TIMER OUTPUT PINS ==============================
+//every pin a PWM timer channel can be muxed out to (STM32F446 datasheet, alternate function table)
+typedef struct {
+	gpio_port_t port;
+	uint32_t pin;
+	uint8_t pwm_channel; //group * 4 + (timer channel - 1)
+} pwm_output_pin_t;
+
+static const pwm_output_pin_t timer_output_pins[] = {
+		{PORT_A, 0, 0}, {PORT_A, 5, 0}, {PORT_A, 15, 0},	//TIM2_CH1
+		{PORT_A, 1, 1}, {PORT_B, 3, 1},					//TIM2_CH2
+		{PORT_A, 2, 2}, {PORT_B, 10, 2},					//TIM2_CH3
+		{PORT_A, 3, 3}, {PORT_B, 11, 3},					//TIM2_CH4
+		{PORT_A, 6, 4}, {PORT_B, 4, 4}, {PORT_C, 6, 4},	//TIM3_CH1
+		{PORT_A, 7, 5}, {PORT_B, 5, 5}, {PORT_C, 7, 5},	//TIM3_CH2
+		{PORT_B, 0, 6}, {PORT_C, 8, 6},					//TIM3_CH3
+		{PORT_B, 1, 7}, {PORT_C, 9, 7}						//TIM3_CH4
+};
+#define NUM_TIMER_OUTPUT_PINS (sizeof(timer_output_pins) / sizeof(timer_output_pins[0]))
+
+#define GROUP_OF(channel)		((channel) / PWM_CHANNELS_PER_GROUP)
+#define BIT_IN_GROUP(channel)	(1 << ((channel) % PWM_CHANNELS_PER_GROUP))
+
 //initializing static members, doing this very explicitly bc the arrays aren't huge
-bool Hard_PWM::blank_channel[8] = {false, false, false, false, false, false, false, false};
 bool Hard_PWM::channel_inverted[8] = {false, false, false, false, false, false, false, false};
 const DIO* Hard_PWM::pwm_pins[8] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+Hard_PWM* Hard_PWM::instances[8] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
 bool Hard_PWM::channel_in_use[8] = {false, false, false, false, false, false, false, false};
+bool Hard_PWM::hw_output[8] = {false, false, false, false, false, false, false, false};
+bool Hard_PWM::configured = false;
+HOT_DATA volatile uint8_t Hard_PWM::active_mask[NUM_PWM_GROUPS] = {0, 0};
+HOT_DATA pwm_port_table_t Hard_PWM::port_tables[NUM_PWM_GROUPS][PWM_CHANNELS_PER_GROUP];
+HOT_DATA uint8_t Hard_PWM::num_ports[NUM_PWM_GROUPS] = {0, 0};
+uint32_t Hard_PWM::duty_count[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+HOT_DATA uint32_t Hard_PWM::rise_count[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+HOT_DATA uint32_t Hard_PWM::fall_count[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+HOT_DATA volatile uint8_t Hard_PWM::phased_mask[NUM_PWM_GROUPS] = {0, 0};
+HOT_DATA volatile uint8_t Hard_PWM::fall_pending_mask[NUM_PWM_GROUPS] = {0, 0};
+#if GPIO_CAPTURE
+HOT_DATA pwm_capture_event_t Hard_PWM::capture_events[NUM_PWM_GROUPS][PWM_CAPTURE_DEPTH];
+HOT_DATA volatile uint32_t Hard_PWM::capture_head[NUM_PWM_GROUPS] = {0, 0};
+HOT_DATA volatile uint32_t Hard_PWM::capture_tail[NUM_PWM_GROUPS] = {0, 0};
+HOT_DATA Deferred_Work Hard_PWM::capture_work[NUM_PWM_GROUPS] = {{Hard_PWM::capture_edges_a}, {Hard_PWM::capture_edges_b}};
+#endif
 
 Hard_PWM::Hard_PWM(const DIO &_pin, const bool _inverted) {
-	//map the new instance to the next free PWM channel
+	//if the timer can drive the pin itself, grab that channel
+	//only once we're configured though--during static init the `DIO` might not be constructed yet, so we can't look at
+	//its pin here; `configure()` moves those instances onto their timer channels instead
+	if(Hard_PWM::configured) {
+		uint8_t timer_channel = Hard_PWM::timer_channel_of(_pin.get_pin());
+		if(timer_channel != CHANNEL_NOT_MAPPED && !channel_in_use[timer_channel]) {
+			channel_mapping = timer_channel;
+
+			Hard_PWM::pwm_pins[channel_mapping] = &_pin;
+			Hard_PWM::instances[channel_mapping] = this;
+			Hard_PWM::channel_inverted[channel_mapping] = _inverted;
+			Hard_PWM::channel_in_use[channel_mapping] = true;
+			Hard_PWM::hw_output[channel_mapping] = true;
+			Hard_PWM::enable_hw_output(channel_mapping);
+
+			return;
+		}
+	}
+
+	//otherwise map the new instance to the next free PWM channel and run it off the ISR
 	uint8_t free_channel_check = 0;
 	while(free_channel_check < NUM_PWM_CHANNELS) {
 
@@ -43,9 +115,18 @@ Hard_PWM::Hard_PWM(const DIO &_pin, const bool _inverted) {
 			channel_mapping = free_channel_check;
 
 			Hard_PWM::pwm_pins[channel_mapping] = &_pin; //save a pointer to the original pin
+			Hard_PWM::instances[channel_mapping] = this;
 			Hard_PWM::channel_inverted[channel_mapping] = _inverted; //save whether the channel is inverted
 			Hard_PWM::channel_in_use[channel_mapping] = true; //channel is now in use
-			Hard_PWM::enable_chan_interrupt(channel_mapping); //this is basically here for dynamically constructed objects
+			Hard_PWM::set_channel_active(channel_mapping, true);
+
+			//during static init the timer handles (and maybe the `DIO`) aren't set up yet, so `configure()` builds
+			//the ISR tables and turns the interrupts on--only dynamically constructed objects have to do it here
+			if(Hard_PWM::configured) {
+				Hard_PWM::build_port_tables(GROUP_OF(channel_mapping)); //have the ISR pick up the new pin
+				Hard_PWM::enable_chan_interrupt(channel_mapping);
+				Hard_PWM::group_timer(GROUP_OF(channel_mapping))->DIER |= TIM_DIER_UIE;
+			}
 
 			return; //done with the constructor, can leave
 		}
@@ -60,10 +141,23 @@ Hard_PWM::Hard_PWM(const DIO &_pin, const bool _inverted) {
 //should never be called, but writing this just in case
 Hard_PWM::~Hard_PWM() {
 	if(channel_mapping == CHANNEL_NOT_MAPPED) return; //if we didn't map the channel to hardware, just return
+	Hard_PWM::instances[channel_mapping] = NULL;
+	if(Hard_PWM::hw_output[channel_mapping]) {
+		Hard_PWM::disable_hw_output(channel_mapping);
+		Hard_PWM::hw_output[channel_mapping] = false;
+		Hard_PWM::channel_in_use[channel_mapping] = false;
+		return;
+	}
+
 	//disable the interrupt channel
 	Hard_PWM::disable_chan_interrupt(channel_mapping);
+	Hard_PWM::set_channel_active(channel_mapping, false);
+	//drop out of phase offset mode if we were in it
+	Hard_PWM::phased_mask[GROUP_OF(channel_mapping)] &= ~BIT_IN_GROUP(channel_mapping);
+	Hard_PWM::set_compare_preload(channel_mapping, true);
 	//mark the pin as free
 	Hard_PWM::channel_in_use[channel_mapping] = false;
+	Hard_PWM::build_port_tables(GROUP_OF(channel_mapping));
 	//and that's all we really need to do
 }
 
@@ -74,6 +168,20 @@ void Hard_PWM::set(float _pwm_val) {
 	if(_pwm_val < 0) return;
 	if(_pwm_val > 1) return;
 
+	//hardware channels just need the compare value; CCRx > ARR holds the output active the whole period
+	if(Hard_PWM::hw_output[channel_mapping]) {
+		*Hard_PWM::compare_reg(channel_mapping) = (uint32_t)(_pwm_val * PWM_RESOLUTION);
+		Hard_PWM::set_output_mode(channel_mapping, TIM_OCMODE_PWM1); //in case it was forced
+		return;
+	}
+
+	//phased channels need both of their edges worked out again
+	Hard_PWM::duty_count[channel_mapping] = (uint32_t)(_pwm_val * PWM_RESOLUTION);
+	if(Hard_PWM::phased_mask[GROUP_OF(channel_mapping)] & BIT_IN_GROUP(channel_mapping)) {
+		Hard_PWM::apply_phase(channel_mapping);
+		return;
+	}
+
 	//don't blank the channel but also don't pay attention to the compare interrupt
 	//this is because the compare interrupt flag WILL STILL GET ASSERTED IF CCRx REG IS > ARR REG
 	//page 565 of the datasheet describing the CC1IF bit
@@ -122,14 +230,22 @@ void Hard_PWM::set(float _pwm_val) {
 	}
 
 	//finally, unblank the channel (if applicable)
-	Hard_PWM::blank_channel[channel_mapping] = false;
+	Hard_PWM::set_channel_active(channel_mapping, true);
 }
 
 void Hard_PWM::operate_normally() {
 	if(channel_mapping == CHANNEL_NOT_MAPPED) return; //quick sanity check if the channel is legit
+	if(Hard_PWM::hw_output[channel_mapping]) {
+		Hard_PWM::set_output_mode(channel_mapping, TIM_OCMODE_PWM1);
+		return;
+	}
+	if(Hard_PWM::phased_mask[GROUP_OF(channel_mapping)] & BIT_IN_GROUP(channel_mapping)) {
+		Hard_PWM::apply_phase(channel_mapping);
+		return;
+	}
 
 	//un-blank the channel, and let the isr take care of setting up the pin after a single cycle
-	Hard_PWM::blank_channel[channel_mapping] = false;
+	Hard_PWM::set_channel_active(channel_mapping, true);
 
 	//re-enable the corresponding ISR channel
 	Hard_PWM::enable_chan_interrupt(channel_mapping);
@@ -137,9 +253,13 @@ void Hard_PWM::operate_normally() {
 
 void Hard_PWM::force_asserted() {
 	if(channel_mapping == CHANNEL_NOT_MAPPED) return; //quick sanity check if the channel is legit
+	if(Hard_PWM::hw_output[channel_mapping]) {
+		Hard_PWM::set_output_mode(channel_mapping, TIM_OCMODE_FORCED_ACTIVE); //polarity bit takes care of inversion
+		return;
+	}
 
 	//blank the pin first thing so we we have an ISR fire mid function, it won't update the pin
-	Hard_PWM::blank_channel[channel_mapping] = true;
+	Hard_PWM::set_channel_active(channel_mapping, false);
 
 	//drive the pin according to whether the channel is inverted
 	ASSERT(channel_mapping);
@@ -150,9 +270,13 @@ void Hard_PWM::force_asserted() {
 
 void Hard_PWM::force_deasserted() {
 	if(channel_mapping == CHANNEL_NOT_MAPPED) return; //quick sanity check if the channel is legit
+	if(Hard_PWM::hw_output[channel_mapping]) {
+		Hard_PWM::set_output_mode(channel_mapping, TIM_OCMODE_FORCED_INACTIVE);
+		return;
+	}
 
 	//blank the pin first thing so we we have an ISR fire mid function, it won't update the pin
-	Hard_PWM::blank_channel[channel_mapping] = true;
+	Hard_PWM::set_channel_active(channel_mapping, false);
 
 	//drive the pin according to whether the channel is inverted
 	DEASSERT(channel_mapping);
@@ -182,14 +306,32 @@ void Hard_PWM::configure(const float _freq, int_priority_t _priority) {
 	//clear the interrupt status registers before moving forward just in case anything is set
 	PWM_A_TIM.Instance->SR = 0;
 	PWM_B_TIM.Instance->SR = 0;
-	//start off by enabling compare interrupts for all active channels
+	//every `DIO` exists by now, so this is where pins constructed during static init find out if the timer can drive them
+	//then build the ISR tables for the rest, for the same reason
+	Hard_PWM::assign_hw_outputs();
+	Hard_PWM::build_port_tables(0);
+	Hard_PWM::build_port_tables(1);
+
+	//start off by enabling compare interrupts for all active channels, or handing the pin to the timer
+	//only need the update/overflow interrupt in a group if some channel in it runs off the ISR
 	for(uint8_t i = 0; i < NUM_PWM_CHANNELS; i++) {
-		if(Hard_PWM::channel_in_use[i])
+		if(!Hard_PWM::channel_in_use[i]) continue;
+		if(Hard_PWM::hw_output[i])
+			Hard_PWM::enable_hw_output(i);
+		else if(Hard_PWM::phased_mask[GROUP_OF(i)] & BIT_IN_GROUP(i)) {
+			//timer init just put the compare preload back on, and zeroed the compare
+			Hard_PWM::set_compare_preload(i, false);
+			Hard_PWM::apply_phase(i);
+		}
+		else {
 			Hard_PWM::enable_chan_interrupt(i);
+			Hard_PWM::group_timer(GROUP_OF(i))->DIER |= TIM_DIER_UIE;
+		}
 	}
-	//configure the update/overflow interrupt in both of the PWM channels as well
-	PWM_A_TIM.Instance->DIER |= TIM_DIER_UIE;
-	PWM_B_TIM.Instance->DIER |= TIM_DIER_UIE;
+#if HARD_PWM_SPREAD_PHASES
+	//the hardware outputs are sorted out by now, so every ISR channel gets spaced out around them
+	Hard_PWM::spread_phases();
+#endif
 
 	//reset the counters
 	PWM_A_TIM.Instance->CNT = 0;
@@ -205,6 +347,148 @@ void Hard_PWM::configure(const float _freq, int_priority_t _priority) {
 	HAL_NVIC_EnableIRQ(PWM_B_IRQn);
 	PWM_A_TIM.Instance->CR1 |= TIM_CR1_CEN;
 	PWM_B_TIM.Instance->CR1 |= TIM_CR1_CEN;
+	Hard_PWM::configured = true;
+}
+
+float Hard_PWM::get_irq_rate(const uint8_t group, const float _freq) {
+	if(group >= NUM_PWM_GROUPS) return 0;
+
+	uint32_t irqs_per_period = 0;
+	bool needs_update = false;
+	for(uint8_t i = group * PWM_CHANNELS_PER_GROUP; i < (group + 1) * PWM_CHANNELS_PER_GROUP; i++) {
+		if(!Hard_PWM::channel_in_use[i] || Hard_PWM::hw_output[i]) continue;
+		if(Hard_PWM::phased_mask[group] & BIT_IN_GROUP(i)) irqs_per_period += 2;
+		else {
+			irqs_per_period++;
+			needs_update = true;
+		}
+	}
+	if(needs_update) irqs_per_period++;
+	return irqs_per_period * _freq;
+}
+
+void Hard_PWM::set_int_priority(const uint8_t group, int_priority_t _priority) {
+	if(group >= NUM_PWM_GROUPS) return;
+	HAL_NVIC_SetPriority(Hard_PWM::group_irq(group), (uint32_t)_priority, 0);
+}
+
+bool Hard_PWM::is_hardware_output() {
+	if(channel_mapping == CHANNEL_NOT_MAPPED) return false;
+	return Hard_PWM::hw_output[channel_mapping];
+}
+
+void Hard_PWM::set_phase(float _phase) {
+	if(channel_mapping == CHANNEL_NOT_MAPPED) return; //quick sanity check if the channel is legit
+	if(Hard_PWM::hw_output[channel_mapping]) return; //the timer only does edge aligned PWM on these
+	if(_phase < 0) return;
+	if(_phase >= 1) return;
+
+	Hard_PWM::enable_phase(channel_mapping, (uint32_t)(_phase * PWM_RESOLUTION));
+}
+
+void Hard_PWM::spread_phases() {
+	//hardware output channels are stuck asserting on the rollover, so they all share the first slot
+	uint32_t isr_channels = 0;
+	bool any_hw_output = false;
+	for(uint8_t i = 0; i < NUM_PWM_CHANNELS; i++) {
+		if(!Hard_PWM::channel_in_use[i]) continue;
+		if(Hard_PWM::hw_output[i]) any_hw_output = true;
+		else isr_channels++;
+	}
+	if(isr_channels == 0) return;
+
+	//then hand out the rest of the slots in channel order
+	uint32_t slots = isr_channels + (any_hw_output ? 1 : 0);
+	uint32_t slot = any_hw_output ? 1 : 0;
+	for(uint8_t i = 0; i < NUM_PWM_CHANNELS; i++) {
+		if(!Hard_PWM::channel_in_use[i] || Hard_PWM::hw_output[i]) continue;
+		Hard_PWM::enable_phase(i, (slot * (uint32_t)PWM_RESOLUTION) / slots);
+		slot++;
+	}
+}
+
+//hand each pin that has a timer output to that channel, if nothing else has claimed it
+//whatever was sitting in the channel (if anything) swaps into the pin's old slot, so that slot gets looked at again
+//terminates since every swap claims another hardware channel
+void Hard_PWM::assign_hw_outputs() {
+	uint8_t i = 0;
+	while(i < NUM_PWM_CHANNELS) {
+		if(!Hard_PWM::channel_in_use[i] || Hard_PWM::hw_output[i]) {
+			i++;
+			continue;
+		}
+
+		uint8_t timer_channel = Hard_PWM::timer_channel_of(Hard_PWM::pwm_pins[i]->get_pin());
+		if(timer_channel == CHANNEL_NOT_MAPPED || Hard_PWM::hw_output[timer_channel]) {
+			i++; //stays on the ISR
+			continue;
+		}
+
+		if(timer_channel != i) Hard_PWM::swap_channels(i, timer_channel);
+		Hard_PWM::hw_output[timer_channel] = true;
+		Hard_PWM::set_channel_active(timer_channel, false); //the ISR never touches these
+		Hard_PWM::disable_chan_interrupt(timer_channel);
+		//and the timer only does edge aligned PWM, so a `set_phase()` from before `configure()` doesn't carry over
+		Hard_PWM::phased_mask[GROUP_OF(timer_channel)] &= ~BIT_IN_GROUP(timer_channel);
+		Hard_PWM::fall_pending_mask[GROUP_OF(timer_channel)] &= ~BIT_IN_GROUP(timer_channel);
+	}
+}
+
+//only called before the timers are running, so nothing here races the ISR
+void Hard_PWM::swap_channels(uint8_t a, uint8_t b) {
+	const DIO *pin = Hard_PWM::pwm_pins[a];
+	Hard_PWM::pwm_pins[a] = Hard_PWM::pwm_pins[b];
+	Hard_PWM::pwm_pins[b] = pin;
+
+	Hard_PWM *instance = Hard_PWM::instances[a];
+	Hard_PWM::instances[a] = Hard_PWM::instances[b];
+	Hard_PWM::instances[b] = instance;
+
+	bool inverted = Hard_PWM::channel_inverted[a];
+	Hard_PWM::channel_inverted[a] = Hard_PWM::channel_inverted[b];
+	Hard_PWM::channel_inverted[b] = inverted;
+
+	bool in_use = Hard_PWM::channel_in_use[a];
+	Hard_PWM::channel_in_use[a] = Hard_PWM::channel_in_use[b];
+	Hard_PWM::channel_in_use[b] = in_use;
+
+	uint32_t duty = Hard_PWM::duty_count[a];
+	Hard_PWM::duty_count[a] = Hard_PWM::duty_count[b];
+	Hard_PWM::duty_count[b] = duty;
+
+	//phase offset state too, since `set_phase()` works before `configure()`
+	uint32_t rise = Hard_PWM::rise_count[a];
+	Hard_PWM::rise_count[a] = Hard_PWM::rise_count[b];
+	Hard_PWM::rise_count[b] = rise;
+
+	uint32_t fall = Hard_PWM::fall_count[a];
+	Hard_PWM::fall_count[a] = Hard_PWM::fall_count[b];
+	Hard_PWM::fall_count[b] = fall;
+
+	Hard_PWM::swap_mask_bits(Hard_PWM::phased_mask, a, b);
+	Hard_PWM::swap_mask_bits(Hard_PWM::fall_pending_mask, a, b);
+
+	//and let the instances know where they ended up
+	if(Hard_PWM::instances[a]) Hard_PWM::instances[a]->channel_mapping = a;
+	if(Hard_PWM::instances[b]) Hard_PWM::instances[b]->channel_mapping = b;
+	Hard_PWM::set_channel_active(a, Hard_PWM::channel_in_use[a]);
+	Hard_PWM::set_channel_active(b, Hard_PWM::channel_in_use[b]);
+}
+
+//trade two channels' bits in a per-group mask, wherever each of them sits
+void Hard_PWM::swap_mask_bits(volatile uint8_t *masks, uint8_t a, uint8_t b) {
+	bool bit_a = (masks[GROUP_OF(a)] & BIT_IN_GROUP(a)) != 0;
+	bool bit_b = (masks[GROUP_OF(b)] & BIT_IN_GROUP(b)) != 0;
+	masks[GROUP_OF(a)] = bit_b ? (masks[GROUP_OF(a)] | BIT_IN_GROUP(a)) : (masks[GROUP_OF(a)] & ~BIT_IN_GROUP(a));
+	masks[GROUP_OF(b)] = bit_a ? (masks[GROUP_OF(b)] | BIT_IN_GROUP(b)) : (masks[GROUP_OF(b)] & ~BIT_IN_GROUP(b));
+}
+
+uint8_t Hard_PWM::timer_channel_of(const dio_pin_t &pin) {
+	for(uint32_t i = 0; i < NUM_TIMER_OUTPUT_PINS; i++) {
+		if(timer_output_pins[i].port == pin.port && timer_output_pins[i].pin == pin.pin)
+			return timer_output_pins[i].pwm_channel;
+	}
+	return CHANNEL_NOT_MAPPED;
 }
 
 //================================ ISR HANDLING FUNCTIONS (class functions) ===============================
@@ -213,83 +497,265 @@ void Hard_PWM::configure(const float _freq, int_priority_t _priority) {
 //splitting into two ISRs due to two separate channel groups of four
 //THESE FUNCTIONS WILL NEVER BE CALLED FROM THE APP, SO CAN IMPLEMENT THE ISR
 //HOWEVER YOU WANT BASED OFF OF WHAT'S BEST FOR YOUR HARDWARE
-void __attribute__((optimize("O3"))) Hard_PWM::isr_groupA() {
+void RAMFUNC __attribute__((optimize("O3"))) Hard_PWM::isr_groupA() {
+	Hard_PWM::service_group(0, PWM_A_TIM.Instance);
+}
+
+void RAMFUNC __attribute__((optimize("O3"))) Hard_PWM::isr_groupB() {
+	Hard_PWM::service_group(1, PWM_B_TIM.Instance);
+}
+
+//=============================== PRIVATE FUNCTION DEFS ==========================
+//everything the per-channel checks used to do happens up front, so the ISR is just a few mask ops and a store per port
+inline __attribute__((always_inline)) void Hard_PWM::service_group(const uint8_t group, TIM_TypeDef *tim) {
 	//read the timer interrupt flag register, checking against what interrupts were actually enabled
-	uint32_t interrupt_status = PWM_A_TIM.Instance->SR & PWM_A_TIM.Instance->DIER;
-	PWM_A_TIM.Instance->SR = 0; //clear all interrupt sources so we can pick another one up if it happens immediately
-
-	//handle channel 0; first check if the channel is being actively controlled by the timer
-	if(!Hard_PWM::blank_channel[0] && Hard_PWM::channel_in_use[0]) {
-		if((interrupt_status & TIM_SR_CC1IF))
-			DEASSERT(0); //if we hit the compare update (should also handle the case when PWM val is 0)
-		else if(interrupt_status & TIM_SR_UIF)
-			ASSERT(0); //we hit the normal update, assert the pin
+	uint32_t interrupt_status = tim->SR & tim->DIER;
+	tim->SR = 0; //clear all interrupt sources so we can pick another one up if it happens immediately
+	TRACE(TRACE_PWM_ISR_ENTER, (group << 8) | (interrupt_status & 0x1F)); //UIF and CC1IF-CC4IF are the bottom 5 bits
+
+	//CC1IF-CC4IF line up with the channels in the group once we shift UIF out
+	//hitting the compare deasserts the channel (should also handle the case when PWM val is 0)
+	//otherwise the normal update asserts it
+	uint32_t active = Hard_PWM::active_mask[group];
+	uint32_t phased = Hard_PWM::phased_mask[group] & active;
+	uint32_t compare = (interrupt_status >> 1) & active;
+	uint32_t compare_normal = compare & ~phased;
+	uint32_t deassert_set = compare_normal;
+	uint32_t assert_set = (interrupt_status & TIM_SR_UIF) ? (active & ~phased & ~compare_normal) : 0;
+
+	//phased channels ignore the update, their compare alternates between the rising and falling edge
+	uint32_t compare_phased = compare & phased;
+	if(compare_phased) {
+		uint32_t fall_pending = Hard_PWM::fall_pending_mask[group];
+		deassert_set |= compare_phased & fall_pending;
+		assert_set |= compare_phased & ~fall_pending;
+		Hard_PWM::fall_pending_mask[group] = fall_pending ^ compare_phased;
+
+		//and point the compare at the other edge
+		do {
+			uint32_t i = __builtin_ctz(compare_phased);
+			uint8_t channel = group * PWM_CHANNELS_PER_GROUP + i;
+			(&tim->CCR1)[i] = (fall_pending & (1 << i)) ? Hard_PWM::rise_count[channel] : Hard_PWM::fall_count[channel];
+			compare_phased &= compare_phased - 1;
+		} while(compare_phased);
 	}
 
-	//handle channel 1; first check if the channel is being actively controlled by the timer
-	if(!Hard_PWM::blank_channel[1] && Hard_PWM::channel_in_use[1]) {
-		if((interrupt_status & TIM_SR_CC2IF))
-			DEASSERT(1); //if we hit the compare update (should also handle the case when PWM val is 0)
-		else if(interrupt_status & TIM_SR_UIF)
-			ASSERT(1); //we hit the normal update, assert the pin
+	if(assert_set | deassert_set) {
+		//the two sets never overlap, so the set and reset halves of the BSRR word can't fight
+		const pwm_port_table_t *table = Hard_PWM::port_tables[group];
+		for(uint32_t i = 0; i < Hard_PWM::num_ports[group]; i++)
+			*table[i].bsrr = table[i].assert_word[assert_set] | table[i].deassert_word[deassert_set];
+
+#if GPIO_CAPTURE
+		//we went around `DIO`, so the edges are ours to log--timestamp them now, write them into the capture from PendSV
+		uint32_t head = Hard_PWM::capture_head[group];
+		if(head - Hard_PWM::capture_tail[group] < PWM_CAPTURE_DEPTH) {
+			pwm_capture_event_t &event = Hard_PWM::capture_events[group][head & (PWM_CAPTURE_DEPTH - 1)];
+			event.timestamp = Timestamp::now_ticks32();
+			event.assert_set = (uint8_t)assert_set;
+			event.deassert_set = (uint8_t)deassert_set;
+			__DMB(); //event lands before the head says it's there
+			Hard_PWM::capture_head[group] = head + 1;
+			Hard_PWM::capture_work[group].queue();
+		}
+#endif
 	}
+	TRACE(TRACE_PWM_ISR_EXIT, group);
+}
 
-	//handle channel 2; first check if the channel is being actively controlled by the timer
-	if(!Hard_PWM::blank_channel[2] && Hard_PWM::channel_in_use[2]) {
-		if((interrupt_status & TIM_SR_CC3IF))
-			DEASSERT(2); //if we hit the compare update (should also handle the case when PWM val is 0)
-		else if(interrupt_status & TIM_SR_UIF)
-			ASSERT(2); //we hit the normal update, assert the pin
+#if GPIO_CAPTURE
+//runs from PendSV, expands what the ISR timestamped into per-pin capture records
+void Hard_PWM::capture_edges(uint8_t group) {
+	uint32_t tail = Hard_PWM::capture_tail[group];
+	while(tail != Hard_PWM::capture_head[group]) {
+		__DMB(); //don't read the event before we've seen the head
+		const pwm_capture_event_t &event = Hard_PWM::capture_events[group][tail & (PWM_CAPTURE_DEPTH - 1)];
+		for(uint32_t i = 0; i < PWM_CHANNELS_PER_GROUP; i++) {
+			uint8_t channel = group * PWM_CHANNELS_PER_GROUP + i;
+			if(event.assert_set & (1 << i))
+				GPIO_Capture::record_at(Hard_PWM::pwm_pins[channel]->get_pin(), !Hard_PWM::channel_inverted[channel], event.timestamp);
+			else if(event.deassert_set & (1 << i))
+				GPIO_Capture::record_at(Hard_PWM::pwm_pins[channel]->get_pin(), Hard_PWM::channel_inverted[channel], event.timestamp);
+		}
+		tail++;
+		__DMB(); //done with the slot before we hand it back
+		Hard_PWM::capture_tail[group] = tail;
 	}
+}
 
-	//handle channel 3; first check if the channel is being actively controlled by the timer
-	if(!Hard_PWM::blank_channel[3] && Hard_PWM::channel_in_use[3]) {
-		if((interrupt_status & TIM_SR_CC4IF))
-			DEASSERT(3); //if we hit the compare update (should also handle the case when PWM val is 0)
-		else if(interrupt_status & TIM_SR_UIF)
-			ASSERT(3); //we hit the normal update, assert the pin
-	}
+void Hard_PWM::capture_edges_a() { Hard_PWM::capture_edges(0); }
+void Hard_PWM::capture_edges_b() { Hard_PWM::capture_edges(1); }
+#endif
+
+//only ever written from the app side, the ISR just reads the mask
+void Hard_PWM::set_channel_active(uint8_t pwm_channel, bool active) {
+	if(active) Hard_PWM::active_mask[GROUP_OF(pwm_channel)] |= BIT_IN_GROUP(pwm_channel);
+	else Hard_PWM::active_mask[GROUP_OF(pwm_channel)] &= ~BIT_IN_GROUP(pwm_channel);
 }
 
-void __attribute__((optimize("O3"))) Hard_PWM::isr_groupB() {
-	//read the timer interrupt flag register, checking against what interrupts were actually enabled
-	uint32_t interrupt_status = PWM_B_TIM.Instance->SR & PWM_B_TIM.Instance->DIER;
-	PWM_B_TIM.Instance->SR = 0; //clear all interrupt sources so we can pick another one up if it happens immediately
-
-	//handle channel 4; first check if the channel is being actively controlled by the timer
-	if(!Hard_PWM::blank_channel[4] && Hard_PWM::channel_in_use[4]) {
-		if((interrupt_status & TIM_SR_CC1IF))
-			DEASSERT(4); //if we hit the compare update (should also handle the case when PWM val is 0)
-		else if(interrupt_status & TIM_SR_UIF)
-			ASSERT(4); //we hit the normal update, assert the pin
+//work out the BSRR words for every combination of channels in the group, merging channels that share a port
+void Hard_PWM::build_port_tables(uint8_t group) {
+	pwm_port_table_t tables[PWM_CHANNELS_PER_GROUP] = {};
+	uint8_t ports = 0;
+
+	for(uint8_t i = 0; i < PWM_CHANNELS_PER_GROUP; i++) {
+		uint8_t channel = group * PWM_CHANNELS_PER_GROUP + i;
+		if(!Hard_PWM::channel_in_use[channel] || Hard_PWM::hw_output[channel]) continue; //ISR doesn't drive these
+
+		//find the table for this channel's port, or start a new one
+		const dio_pin_t &pin = Hard_PWM::pwm_pins[channel]->get_pin();
+		volatile uint32_t *bsrr = &DIO::port_regs(pin.port)->BSRR;
+		uint8_t port = 0;
+		while(port < ports && tables[port].bsrr != bsrr) port++;
+		if(port == ports) tables[ports++].bsrr = bsrr;
+
+		//bottom half of BSRR sets the pin, top half resets it; swap them if the channel is inverted
+		uint32_t set_bit = 1 << pin.pin;
+		uint32_t reset_bit = 1 << (pin.pin + 16);
+		uint32_t assert_bit = Hard_PWM::channel_inverted[channel] ? reset_bit : set_bit;
+		uint32_t deassert_bit = Hard_PWM::channel_inverted[channel] ? set_bit : reset_bit;
+
+		for(uint32_t set = 0; set < PWM_CHANNEL_SETS; set++) {
+			if(!(set & (1 << i))) continue;
+			tables[port].assert_word[set] |= assert_bit;
+			tables[port].deassert_word[set] |= deassert_bit;
+		}
 	}
 
-	//handle channel 5; first check if the channel is being actively controlled by the timer
-	if(!Hard_PWM::blank_channel[5] && Hard_PWM::channel_in_use[5]) {
-		if((interrupt_status & TIM_SR_CC2IF))
-			DEASSERT(5); //if we hit the compare update (should also handle the case when PWM val is 0)
-		else if(interrupt_status & TIM_SR_UIF)
-			ASSERT(5); //we hit the normal update, assert the pin
-	}
+	//swap the new tables in without the ISR seeing half of them
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	for(uint8_t i = 0; i < PWM_CHANNELS_PER_GROUP; i++)
+		Hard_PWM::port_tables[group][i] = tables[i];
+	Hard_PWM::num_ports[group] = ports;
+	__set_PRIMASK(primask);
+}
+
+TIM_TypeDef *Hard_PWM::group_timer(uint8_t group) {
+	return group ? PWM_B_TIM.Instance : PWM_A_TIM.Instance;
+}
+
+IRQn_Type Hard_PWM::group_irq(uint8_t group) {
+	return group ? PWM_B_IRQn : PWM_A_IRQn;
+}
+
+//CCR1-CCR4 sit right next to each other in the register map
+volatile uint32_t *Hard_PWM::compare_reg(uint8_t pwm_channel) {
+	return &Hard_PWM::group_timer(GROUP_OF(pwm_channel))->CCR1 + (pwm_channel % PWM_CHANNELS_PER_GROUP);
+}
+
+//TIM_OCMODE_xxx values are in the OC1M position; CCMR1 holds channels 1/2, CCMR2 holds 3/4
+void Hard_PWM::set_output_mode(uint8_t pwm_channel, uint32_t oc_mode) {
+	uint32_t index = pwm_channel % PWM_CHANNELS_PER_GROUP;
+	volatile uint32_t *ccmr = &Hard_PWM::group_timer(GROUP_OF(pwm_channel))->CCMR1 + (index / CCMR_CHANS_PER_REG);
+	uint32_t shift = (index % CCMR_CHANS_PER_REG) * CCMR_BITS_PER_CHAN;
+	*ccmr = (*ccmr & ~(TIM_CCMR1_OC1M << shift)) | (oc_mode << shift);
+}
+
+void Hard_PWM::enable_hw_output(uint8_t pwm_channel) {
+	TIM_TypeDef *tim = Hard_PWM::group_timer(GROUP_OF(pwm_channel));
+	uint32_t index = pwm_channel % PWM_CHANNELS_PER_GROUP;
+
+	//PWM mode 1: active while CNT < CCRx, polarity bit flips what "active" means
+	Hard_PWM::set_output_mode(pwm_channel, TIM_OCMODE_PWM1);
+	uint32_t ccer_shift = index * CCER_BITS_PER_CHAN;
+	if(Hard_PWM::channel_inverted[pwm_channel]) tim->CCER |= (TIM_CCER_CC1P << ccer_shift);
+	else tim->CCER &= ~(TIM_CCER_CC1P << ccer_shift);
+	tim->CCER |= (TIM_CCER_CC1E << ccer_shift);
+
+	//and mux the pin over to the timer
+	//MODER/AFR are shared with every other pin on the port, so don't let an ISR reconfigure one of those mid-write
+	const dio_pin_t &pin = Hard_PWM::pwm_pins[pwm_channel]->get_pin();
+	GPIO_TypeDef *port = DIO::port_regs(pin.port);
+	uint32_t af = GROUP_OF(pwm_channel) ? PWM_B_AF : PWM_A_AF;
+	uint32_t afr_shift = (pin.pin % AFR_PINS_PER_REG) * AFR_BITS_PER_PIN;
+	uint32_t moder_shift = pin.pin * MODER_BITS_PER_PIN;
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	port->AFR[pin.pin / AFR_PINS_PER_REG] = (port->AFR[pin.pin / AFR_PINS_PER_REG] & ~(0xFUL << afr_shift)) | (af << afr_shift);
+	port->MODER = (port->MODER & ~(3UL << moder_shift)) | (MODER_AF << moder_shift);
+	__set_PRIMASK(primask);
+}
 
-	//handle channel 6; first check if the channel is being actively controlled by the timer
-	if(!Hard_PWM::blank_channel[6] && Hard_PWM::channel_in_use[6]) {
-		if((interrupt_status & TIM_SR_CC3IF))
-			DEASSERT(6); //if we hit the compare update (should also handle the case when PWM val is 0)
-		else if(interrupt_status & TIM_SR_UIF)
-			ASSERT(6); //we hit the normal update, assert the pin
+void Hard_PWM::disable_hw_output(uint8_t pwm_channel) {
+	//put the pin back on its output driver, deasserted
+	const dio_pin_t &pin = Hard_PWM::pwm_pins[pwm_channel]->get_pin();
+	GPIO_TypeDef *port = DIO::port_regs(pin.port);
+	DEASSERT(pwm_channel);
+	uint32_t moder_shift = pin.pin * MODER_BITS_PER_PIN;
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	port->MODER = (port->MODER & ~(3UL << moder_shift)) | (MODER_OUTPUT << moder_shift);
+	__set_PRIMASK(primask);
+
+	uint32_t ccer_shift = (pwm_channel % PWM_CHANNELS_PER_GROUP) * CCER_BITS_PER_CHAN;
+	Hard_PWM::group_timer(GROUP_OF(pwm_channel))->CCER &= ~(TIM_CCER_CC1E << ccer_shift);
+	Hard_PWM::set_output_mode(pwm_channel, TIM_OCMODE_TIMING);
+}
+
+void Hard_PWM::set_compare_preload(uint8_t pwm_channel, bool preload) {
+	uint32_t index = pwm_channel % PWM_CHANNELS_PER_GROUP;
+	volatile uint32_t *ccmr = &Hard_PWM::group_timer(GROUP_OF(pwm_channel))->CCMR1 + (index / CCMR_CHANS_PER_REG);
+	uint32_t shift = (index % CCMR_CHANS_PER_REG) * CCMR_BITS_PER_CHAN;
+	if(preload) *ccmr |= (TIM_CCMR1_OC1PE << shift);
+	else *ccmr &= ~(TIM_CCMR1_OC1PE << shift);
+}
+
+void Hard_PWM::enable_phase(uint8_t pwm_channel, uint32_t phase_count) {
+	uint8_t group = GROUP_OF(pwm_channel);
+	Hard_PWM::rise_count[pwm_channel] = phase_count;
+
+	if(!(Hard_PWM::phased_mask[group] & BIT_IN_GROUP(pwm_channel))) {
+		//the ISR moves the compare mid-period, so those writes can't wait for the rollover
+		Hard_PWM::set_compare_preload(pwm_channel, false);
+
+		//pick up from whatever state the pin's in now
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		bool asserted = (Hard_PWM::pwm_pins[pwm_channel]->read() != 0) != Hard_PWM::channel_inverted[pwm_channel];
+		if(asserted) Hard_PWM::fall_pending_mask[group] |= BIT_IN_GROUP(pwm_channel);
+		else Hard_PWM::fall_pending_mask[group] &= ~BIT_IN_GROUP(pwm_channel);
+		Hard_PWM::phased_mask[group] |= BIT_IN_GROUP(pwm_channel);
+		__set_PRIMASK(primask);
 	}
 
-	//handle channel 7; first check if the channel is being actively controlled by the timer
-	if(!Hard_PWM::blank_channel[7] && Hard_PWM::channel_in_use[7]) {
-		if((interrupt_status & TIM_SR_CC4IF))
-			DEASSERT(7); //if we hit the compare update (should also handle the case when PWM val is 0)
-		else if(interrupt_status & TIM_SR_UIF)
-			ASSERT(7); //we hit the normal update, assert the pin
+	Hard_PWM::apply_phase(pwm_channel);
+}
+
+void Hard_PWM::apply_phase(uint8_t pwm_channel) {
+	uint8_t group = GROUP_OF(pwm_channel);
+	uint32_t duty = Hard_PWM::duty_count[pwm_channel];
+
+	//the ISR rewrites `fall_pending_mask` for the rest of the group, so none of this can straddle one of its runs
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	//rise and fall would land on the same count at 0 and 100%, so just hold the pin there with no interrupts
+	if(duty == 0 || duty >= PWM_RESOLUTION) {
+		Hard_PWM::set_channel_active(pwm_channel, false);
+		Hard_PWM::disable_chan_interrupt(pwm_channel);
+		if(duty == 0) {
+			DEASSERT(pwm_channel);
+			Hard_PWM::fall_pending_mask[group] &= ~BIT_IN_GROUP(pwm_channel);
+		}
+		else {
+			ASSERT(pwm_channel);
+			Hard_PWM::fall_pending_mask[group] |= BIT_IN_GROUP(pwm_channel);
+		}
+		__set_PRIMASK(primask);
+		return;
 	}
+
+	//point the compare at whichever edge is coming up next
+	//if that count already went by this period, we lose an edge and the pulse stretches for a period
+	Hard_PWM::fall_count[pwm_channel] = (Hard_PWM::rise_count[pwm_channel] + duty) % (uint32_t)PWM_RESOLUTION;
+	bool fall_pending = Hard_PWM::fall_pending_mask[group] & BIT_IN_GROUP(pwm_channel);
+	*Hard_PWM::compare_reg(pwm_channel) = fall_pending ? Hard_PWM::fall_count[pwm_channel] : Hard_PWM::rise_count[pwm_channel];
+	Hard_PWM::set_channel_active(pwm_channel, true);
+	Hard_PWM::enable_chan_interrupt(pwm_channel);
+	__set_PRIMASK(primask);
 }
 
-//=============================== PRIVATE FUNCTION DEFS ==========================
 //enable the interrupt source by setting the corresponding bit in the approrpriate interrupt control reg
 void Hard_PWM::enable_chan_interrupt(uint8_t pwm_channel) {
 	switch(pwm_channel) {
@@ -355,12 +821,18 @@ void Hard_PWM::disable_chan_interrupt(uint8_t pwm_channel) {
 }
 
 //============================== ISRs (CALLED BY VECTOR TABLE) ================================
-void PWM_A_IRQ_HANDLER(void) {
+void RAMFUNC PWM_A_IRQ_HANDLER(void) {
 	//handle the ISR through the class function
+	NESTING_SAMPLE();
+	ISR_PROFILE_ENTER(PROFILE_PWM_GROUP_A);
 	Hard_PWM::isr_groupA();
+	ISR_PROFILE_EXIT(PROFILE_PWM_GROUP_A);
 }
 
-void PWM_B_IRQ_HANDLER(void) {
+void RAMFUNC PWM_B_IRQ_HANDLER(void) {
 	//handle the ISR through the class function
+	NESTING_SAMPLE();
+	ISR_PROFILE_ENTER(PROFILE_PWM_GROUP_B);
 	Hard_PWM::isr_groupB();
+	ISR_PROFILE_EXIT(PROFILE_PWM_GROUP_B);
 }
@@ -0,0 +1,37 @@
+/*
+ * app_hal_ramfunc.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "app_hal_ramfunc.h"
+
+#define NUM_VECTORS (16 + (uint32_t)FMPI2C1_ER_IRQn + 1) //core exceptions + every F446 IRQ
+#define VECTOR_TABLE_ALIGN 512 //VTOR wants the table aligned to the next power of two above its size
+
+#if USE_RAMFUNC
+//NOLOAD section (see the linker script), we fill it in ourselves
+static uint32_t ram_vectors[NUM_VECTORS] __attribute__((section(".ram_vector"), aligned(VECTOR_TABLE_ALIGN)));
+#endif
+
+void Vector_Table::relocate() {
+#if USE_RAMFUNC
+	//copy whatever table we're running off of right now
+	const uint32_t *flash_vectors = (const uint32_t*)(uintptr_t)SCB->VTOR;
+
+	//don't let anything fire while the table is half copied
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	for(uint32_t i = 0; i < NUM_VECTORS; i++)
+		ram_vectors[i] = flash_vectors[i];
+
+	//make sure the copy lands before any exception can fetch from the new table
+	__DSB();
+	SCB->VTOR = (uint32_t)(uintptr_t)ram_vectors;
+	__DSB();
+	__ISB();
+
+	__set_PRIMASK(primask);
+#endif
+}
@@ -0,0 +1,113 @@
+/*
+ * app_hal_stack_monitor.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "app_hal_stack_monitor.h"
+#include "stdio.h"
+
+#define DUMP_LINE_LENGTH 48
+#define DUMP_TIMEOUT_MS 100
+
+//defined in the linker script
+extern "C" {
+	extern uint32_t _estack;
+	extern uint32_t _Min_Stack_Size;
+}
+
+#define STACK_TOP		((uint32_t*)&_estack)
+#define STACK_BOTTOM	((uint32_t*)((uintptr_t)&_estack - (uintptr_t)&_Min_Stack_Size))
+
+//lowest word we've seen overwritten so far--the scan never has to look above this again
+static uint32_t *high_water = STACK_TOP;
+
+//the system handlers with an active bit in SHCSR
+static const struct {
+	uint32_t active_mask;
+	IRQn_Type irq;
+} system_handlers[] = {
+		{SCB_SHCSR_MEMFAULTACT_Msk, MemoryManagement_IRQn},
+		{SCB_SHCSR_BUSFAULTACT_Msk, BusFault_IRQn},
+		{SCB_SHCSR_USGFAULTACT_Msk, UsageFault_IRQn},
+		{SCB_SHCSR_SVCALLACT_Msk, SVCall_IRQn},
+		{SCB_SHCSR_MONITORACT_Msk, DebugMonitor_IRQn},
+		{SCB_SHCSR_PENDSVACT_Msk, PendSV_IRQn},
+		{SCB_SHCSR_SYSTICKACT_Msk, SysTick_IRQn}
+};
+
+//=========================== INITIALIZING STATIC MEMBERS HERE ==========================
+volatile uint32_t Stack_Monitor::nesting_record = 0;
+
+void stack_paint(void) {
+	//everything from the bottom of the region up to a little below where we are right now
+	uint32_t *end = (uint32_t*)(uintptr_t)__get_MSP() - STACK_PAINT_MARGIN_WORDS;
+	for(uint32_t *word = STACK_BOTTOM; word < end; word++)
+		*word = STACK_PAINT_PATTERN;
+	high_water = end;
+}
+
+uint32_t Stack_Monitor::get_size() {
+	return (uint32_t)(uintptr_t)&_Min_Stack_Size;
+}
+
+uint32_t Stack_Monitor::get_high_water() {
+	//walk up until we hit something that isn't paint
+	uint32_t *word = STACK_BOTTOM;
+	while(word < high_water && *word == STACK_PAINT_PATTERN) word++;
+	high_water = word;
+	return (uint32_t)((uintptr_t)STACK_TOP - (uintptr_t)word);
+}
+
+void Stack_Monitor::report(UART_HandleTypeDef *huart) {
+	char line[DUMP_LINE_LENGTH];
+	int len;
+
+	len = snprintf(line, DUMP_LINE_LENGTH, "stack,%lu,%lu\r\n",
+			(unsigned long)Stack_Monitor::get_high_water(), (unsigned long)Stack_Monitor::get_size());
+	HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+
+	uint32_t priority_mask;
+	uint32_t depth = Stack_Monitor::get_max_nesting(&priority_mask);
+	len = snprintf(line, DUMP_LINE_LENGTH, "nesting,%lu,0x%04lx\r\n", (unsigned long)depth, (unsigned long)priority_mask);
+	HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+}
+
+uint32_t Stack_Monitor::get_max_nesting(uint32_t *priority_mask) {
+	uint32_t record = Stack_Monitor::nesting_record;
+	if(priority_mask != NULL) *priority_mask = record & ((1UL << NESTING_DEPTH_SHIFT) - 1);
+	return record >> NESTING_DEPTH_SHIFT;
+}
+
+void Stack_Monitor::clear_nesting() {
+	Stack_Monitor::nesting_record = 0;
+}
+
+void RAMFUNC Stack_Monitor::record_nesting(uint32_t depth) {
+	//look up the priority of everything that's active
+	uint32_t priorities = 0;
+	for(uint32_t i = 0; i < NVIC_ACTIVE_WORDS; i++) {
+		for(uint32_t active = NVIC->IABR[i]; active; active &= active - 1) {
+			uint32_t irq = i * 32 + (31 - __CLZ(active & -active));
+			priorities |= 1UL << (NVIC->IP[irq] >> (8 - __NVIC_PRIO_BITS));
+		}
+	}
+	//SHCSR active bits are scattered, so check each one against its handler's priority (SHP[0] is exception 4, MemManage)
+	//straight register reads rather than NVIC_GetPriority(), which might not get inlined into SRAM
+	uint32_t shcsr = SCB->SHCSR;
+	for(uint32_t i = 0; i < sizeof(system_handlers) / sizeof(system_handlers[0]); i++) {
+		if(shcsr & system_handlers[i].active_mask)
+			priorities |= 1UL << (SCB->SHP[(((uint32_t)system_handlers[i].irq) & 0xF) - 4] >> (8 - __NVIC_PRIO_BITS));
+	}
+
+	//anything that preempted us since the sample has already finished, but it may have put in a deeper record
+	//a failed STREX means something preempted us, just check again
+	uint32_t record;
+	do {
+		record = __LDREXW(&Stack_Monitor::nesting_record);
+		if(depth <= (record >> NESTING_DEPTH_SHIFT)) {
+			__CLREX();
+			return;
+		}
+	} while(__STREXW((depth << NESTING_DEPTH_SHIFT) | priorities, &Stack_Monitor::nesting_record));
+}
@@ -0,0 +1,103 @@
+/*
+ * app_hal_timestamp.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *	TIMER MAPPINGS:
+ *	TIM5 (32-bit, APB1) free-running at the full 90MHz timer clock
+ */
+
+#include "app_hal_timestamp.h"
+#include "app_hal_stack_monitor.h"
+
+//========================= TIMER MAPPINGS ============================
+#define TIMESTAMP_TIM				TIM5
+#define TIMESTAMP_TIM_CLK_ENABLE	__HAL_RCC_TIM5_CLK_ENABLE
+#define TIMESTAMP_TICK_FREQ			90000000UL //90MHz--APB1 timer clock, no prescaler
+#define TICKS_PER_US				(TIMESTAMP_TICK_FREQ / 1000000UL)
+
+//=========================== INITIALIZING STATIC MEMBERS HERE ==========================
+volatile uint32_t Timestamp::extension_state = 0;
+bool Timestamp::initialized = false;
+
+void Timestamp::init() {
+	TIMESTAMP_TIM_CLK_ENABLE();
+
+	//stop the timer while we configure it
+	TIMESTAMP_TIM->CR1 = 0;
+
+	//count every timer clock, all the way up to the 32-bit limit
+	TIMESTAMP_TIM->PSC = 0;
+	TIMESTAMP_TIM->ARR = 0xFFFFFFFF;
+	TIMESTAMP_TIM->DIER = 0; //no interrupts, we just read the counter
+
+	//force an update so the prescaler gets loaded, then start from 0
+	TIMESTAMP_TIM->EGR = TIM_EGR_UG;
+	TIMESTAMP_TIM->SR = 0;
+	TIMESTAMP_TIM->CNT = 0;
+	Timestamp::extension_state = 0;
+
+	TIMESTAMP_TIM->CR1 = TIM_CR1_CEN;
+	Timestamp::initialized = true;
+}
+
+//aggressively optimize here since this will be called from ISRs
+uint64_t RAMFUNC __attribute__((optimize("O3"))) Timestamp::now_ticks() {
+	//ORDER MATTERS HERE: snapshot the extension state BEFORE reading the counter
+	//that way the state can only ever be older than the counter value, never newer
+	uint32_t state = Timestamp::extension_state;
+	uint32_t count = TIMESTAMP_TIM->CNT;
+
+	//if the counter MSB was set last time we looked and is clear now, we wrapped
+	uint32_t msb = count >> 31;
+	uint32_t wraps = state >> 1;
+	if((state & 1) && !msb) wraps++;
+
+	//publish what we learned if it's new, but never fight over it
+	//a failed STREX means someone preempted us and published the same (or newer) information
+	uint32_t new_state = (wraps << 1) | msb;
+	if(new_state != state) {
+		if(__LDREXW(&Timestamp::extension_state) == state)
+			__STREXW(new_state, &Timestamp::extension_state);
+		else
+			__CLREX();
+	}
+
+	return ((uint64_t)wraps << 32) | count;
+}
+
+uint32_t RAMFUNC __attribute__((optimize("O3"))) Timestamp::now_ticks32() {
+	return TIMESTAMP_TIM->CNT;
+}
+
+uint64_t Timestamp::now_us() {
+	return Timestamp::ticks_to_us(Timestamp::now_ticks());
+}
+
+uint64_t Timestamp::now_ns() {
+	return Timestamp::ticks_to_ns(Timestamp::now_ticks());
+}
+
+uint64_t Timestamp::ticks_to_us(uint64_t ticks) {
+	return ticks / TICKS_PER_US;
+}
+
+uint64_t Timestamp::ticks_to_ns(uint64_t ticks) {
+	//90MHz -> 100/9 ns per tick; won't overflow for a couple decades of uptime
+	return (ticks * 100) / 9;
+}
+
+uint32_t Timestamp::get_tick_freq() {
+	return TIMESTAMP_TICK_FREQ;
+}
+
+void Timestamp::keepalive() {
+	//reading the timestamp is all it takes to keep the overflow extension current
+	if(Timestamp::initialized) Timestamp::now_ticks();
+}
+
+//================================= KEEPALIVE (CALLED FROM SYSTICK) ===================================
+void timestamp_keepalive(void) {
+	NESTING_SAMPLE();
+	Timestamp::keepalive();
+}
@@ -9,6 +9,10 @@
  */
 
 #include "app_hal_timing.h"
+#include "app_hal_isr_profiler.h"
+#include "app_hal_stack_monitor.h"
+#include "app_hal_deferred.h"
+#include "app_hal_trace.h"
 extern "C" {
 	#include "tim.h"
 }
@@ -17,9 +21,11 @@ extern "C" {
 #define CHAN_0_IRQ_HANDLER		TIM1_BRK_TIM9_IRQHandler //tim9
 #define CHAN_1_IRQ_HANDLER		TIM1_TRG_COM_TIM11_IRQHandler //tim11
 #define CHAN_2_IRQ_HANDLER		TIM8_TRG_COM_TIM14_IRQHandler //tim14
+#define CHAN_3_IRQ_HANDLER		TIM8_UP_TIM13_IRQHandler //tim13
 
 #define TIM_F_CLK 90000000.0f //90MHz--just so other parts of the program can use this for whatever reason
 #define TIM_MAX_CNT ((uint16_t)65536) //the maximum value (plus 1) that we can shove into the ARR registers
+#define CPU_CYCLES_PER_TIM_CLK 2 //180MHz core clock, 90MHz timer clock
 
 //=========================== INITIALIZING STAIC MEMBERS HERE ==========================
 //initializing these empty callbacks for now, associate them with the proper callback funcs in the initializers
@@ -29,16 +35,54 @@ void empty_handler();
 const timer_config_struct_t Timer::timer_chan_configs[] = {
 		{MX_TIM9_Init, htim9, TIM1_BRK_TIM9_IRQn}, //channel 0 on timer 9
 		{MX_TIM11_Init, htim11, TIM1_TRG_COM_TIM11_IRQn}, //channel 1 on timer 11
-		{MX_TIM14_Init, htim14, TIM8_TRG_COM_TIM14_IRQn} //channel 2 on timer 14
+		{MX_TIM14_Init, htim14, TIM8_TRG_COM_TIM14_IRQn}, //channel 2 on timer 14
+		{MX_TIM13_Init, htim13, TIM8_UP_TIM13_IRQn} //channel 3 on timer 13
 };
 
 //initialize the callback function array to just be emtpy handlers at the start
-callback_function_t Timer::callbacks[] = {
+HOT_DATA callback_function_t Timer::callbacks[] = {
+		empty_handler,
+		empty_handler,
+		empty_handler,
+		empty_handler
+};
+
+//no overrun handling by default, just count them
+//overrun handlers run straight from the ISR unless a channel opts into running them from PendSV
+HOT_DATA callback_function_t Timer::overrun_callbacks[] = {
+		empty_handler,
 		empty_handler,
 		empty_handler,
 		empty_handler
 };
 
+HOT_DATA Deferred_Work Timer::overrun_work[] = {
+		{empty_handler},
+		{empty_handler},
+		{empty_handler},
+		{empty_handler}
+};
+
+HOT_DATA volatile bool Timer::overrun_deferred[] = {false, false, false, false};
+
+volatile timer_overrun_stats_t Timer::overrun_stats[] = {
+		{0, 0, 0, 0},
+		{0, 0, 0, 0},
+		{0, 0, 0, 0},
+		{0, 0, 0, 0}
+};
+
+//the ISR just drops its numbers in here, the maxima get worked out from PendSV
+HOT_DATA timer_deadline_sample_t Timer::stats_samples[4][TIMER_STATS_DEPTH];
+HOT_DATA volatile uint32_t Timer::stats_head[] = {0, 0, 0, 0};
+HOT_DATA volatile uint32_t Timer::stats_tail[] = {0, 0, 0, 0};
+HOT_DATA Deferred_Work Timer::stats_work[] = {
+		{Timer::tally_chan_0},
+		{Timer::tally_chan_1},
+		{Timer::tally_chan_2},
+		{Timer::tally_chan_3}
+};
+
 //=================== section here just to defining frequency presets ======================
 //first number is prescaler value, second is auto-reload value
 //make sure to subtract 1 from the values!
@@ -76,6 +120,9 @@ void Timer::init() {
 	Timer::timer_chan_configs[channel].htim.Instance->DIER = TIM_DIER_CC1IE;
 	//don't want the update interrupt just yet though
 
+	//compare right at the counter rollover so the phase seeded into the counter is the phase the callback runs at
+	Timer::timer_chan_configs[channel].htim.Instance->CCR1 = 0;
+
 	//and configure the NVIC with the corresponding priority
 	//start it off with medium priority, adjust the priority with the appropriate function
 	set_int_priority(Priorities::MED);
@@ -93,6 +140,9 @@ void Timer::set_phase(float phase) {
 	if(phase < 0) return;
 	if(phase >= 1) return;
 
+	//save the phase so a TimerGroup can re-seed the counter when it starts everything together
+	this->phase = phase;
+
 	//phase the counter by seeding the count value to a fraction of the ARR register
 	uint16_t max_count = Timer::timer_chan_configs[channel].htim.Instance->ARR;
 	Timer::timer_chan_configs[channel].htim.Instance->CNT = (uint16_t)(max_count * phase);
@@ -103,6 +153,15 @@ void Timer::set_callback_func(callback_function_t cb) {
 	Timer::callbacks[channel] = cb;
 }
 
+void Timer::set_overrun_func(callback_function_t cb, bool deferred) {
+	//same deal as the normal callback, just store the pointer in the array
+	//and hand it to the deferred work item for this channel, in case it asked to run from PendSV
+	Timer::overrun_deferred[channel] = false;
+	Timer::overrun_callbacks[channel] = cb;
+	Timer::overrun_work[channel].set_func(cb);
+	Timer::overrun_deferred[channel] = deferred;
+}
+
 void Timer::set_int_priority(int_priority_t prio) {
 	//start with disabling the IRQ as we adjust the priority
 	HAL_NVIC_DisableIRQ(Timer::timer_chan_configs[channel].irq_type);
@@ -122,15 +181,16 @@ void Timer::enable_int() {
 	Timer::timer_chan_configs[channel].htim.Instance->DIER = TIM_DIER_CC1IE;
 }
 
-void Timer::disable_int() {
+void RAMFUNC Timer::disable_int() {
 	//kill the interrupt source in the timer control register
 	Timer::timer_chan_configs[channel].htim.Instance->DIER = 0;
 
 	//clear any looming interrupts from the NVIC so we don't trigger immediately on timer restart
 	//theoretically might not be the best thing to do in the event that the timer shares an interrupt source with something else
 	//but want to avoid that situation entirely for performance reasons
-	HAL_NVIC_DisableIRQ(Timer::timer_chan_configs[channel].irq_type);
-	HAL_NVIC_ClearPendingIRQ(Timer::timer_chan_configs[channel].irq_type);
+	//straight to CMSIS rather than the HAL wrappers, hard stops call this from SRAM and the HAL lives in flash
+	NVIC_DisableIRQ(Timer::timer_chan_configs[channel].irq_type);
+	NVIC_ClearPendingIRQ(Timer::timer_chan_configs[channel].irq_type);
 }
 
 void Timer::enable_tim() {
@@ -138,7 +198,7 @@ void Timer::enable_tim() {
 	Timer::timer_chan_configs[channel].htim.Instance->CR1 |= TIM_CR1_CEN;
 }
 
-void Timer::disable_tim() {
+void RAMFUNC Timer::disable_tim() {
 	//just clear the enable flag in the timer control register and let the hardware do its thing
 	Timer::timer_chan_configs[channel].htim.Instance->CR1 &= ~(TIM_CR1_CEN);
 }
@@ -156,6 +216,23 @@ float Timer::get_tim_fclk() {
 	return TIM_F_CLK;
 }
 
+timer_overrun_stats_t Timer::get_overrun_stats() {
+	//copy field by field out of the volatile struct
+	timer_overrun_stats_t stats;
+	stats.overruns = Timer::overrun_stats[channel].overruns;
+	stats.worst_latency = Timer::overrun_stats[channel].worst_latency;
+	stats.worst_completion = Timer::overrun_stats[channel].worst_completion;
+	stats.dropped_samples = Timer::overrun_stats[channel].dropped_samples;
+	return stats;
+}
+
+void Timer::clear_overrun_stats() {
+	Timer::overrun_stats[channel].overruns = 0;
+	Timer::overrun_stats[channel].worst_latency = 0;
+	Timer::overrun_stats[channel].worst_completion = 0;
+	Timer::overrun_stats[channel].dropped_samples = 0;
+}
+
 //utility delay function
 //should really never be called in the program if we write stuff well
 //but useful for debugging
@@ -169,31 +246,183 @@ uint32_t Timer::get_ms(){
 	return HAL_GetTick();
 }
 
+//========================================= TIMER GROUP ========================================
+TimerGroup::TimerGroup(Timer *_timers[], const uint32_t _num_timers) {
+	//clamp to the number of timer channels we actually have
+	num_timers = (_num_timers > TIMER_GROUP_MAX_TIMERS) ? TIMER_GROUP_MAX_TIMERS : _num_timers;
+	for(uint32_t i = 0; i < num_timers; i++)
+		timers[i] = _timers[i];
+}
+
+//the CR1 write loop, shared by the timed dry run and the real start so both take the same number of cycles
+static inline __attribute__((always_inline)) void write_all(volatile uint32_t *regs[], const uint32_t vals[], const uint32_t n) {
+	for(uint32_t i = 0; i < n; i++)
+		*regs[i] = vals[i];
+}
+
+void TimerGroup::start() {
+	//precompute everything here so the actual start sequence is just stores
+	volatile uint32_t *cr1_regs[TIMER_GROUP_MAX_TIMERS];
+	uint32_t cr1_stopped[TIMER_GROUP_MAX_TIMERS];
+	uint32_t cr1_vals[TIMER_GROUP_MAX_TIMERS];
+
+	for(uint32_t i = 0; i < num_timers; i++) {
+		TIM_TypeDef *tim = Timer::timer_chan_configs[timers[i]->channel].htim.Instance;
+
+		//stop the timer, then force an update event
+		//this latches any buffered PSC/ARR values and resets the prescaler counter so all the prescalers start aligned
+		tim->CR1 &= ~(TIM_CR1_CEN);
+		tim->EGR = TIM_EGR_UG;
+		tim->SR = 0; //the update event sets UIF, clear it out along with anything else pending
+
+		cr1_regs[i] = &tim->CR1;
+		cr1_stopped[i] = tim->CR1;
+		cr1_vals[i] = tim->CR1 | TIM_CR1_CEN;
+	}
+
+	//need the cycle counter to time the write loop
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	//timers later in the sequence start late by however long the writes ahead of them take
+	//time a dry run of the exact same loop (rewriting the stopped CR1 values changes nothing) to find out how long that is
+	uint32_t start = DWT->CYCCNT;
+	write_all(cr1_regs, cr1_stopped, num_timers);
+	uint32_t loop_cycles = DWT->CYCCNT - start;
+
+	//seed each counter with its phase offset, advanced by the ticks it'll miss waiting for its write
+	for(uint32_t i = 0; i < num_timers; i++) {
+		TIM_TypeDef *tim = Timer::timer_chan_configs[timers[i]->channel].htim.Instance;
+		uint32_t lag_cycles = (i * loop_cycles) / num_timers;
+		tim->CNT = TimerGroup::phase_seed(timers[i]->phase, tim->ARR, tim->PSC, lag_cycles);
+	}
+
+	//fire off all the CR1 writes back-to-back without anything getting in between
+	write_all(cr1_regs, cr1_vals, num_timers);
+	__set_PRIMASK(primask);
+}
+
+uint32_t TimerGroup::phase_seed(const float phase, const uint32_t arr, const uint32_t psc, const uint32_t lag_cycles) {
+	uint32_t period = arr + 1;
+	uint32_t phase_ticks = (uint32_t)(phase * (float)period + 0.5f);
+
+	//round the lag to the nearest prescaled tick--anything under half a tick can't be corrected with the counter anyway
+	uint32_t cycles_per_tick = CPU_CYCLES_PER_TIM_CLK * (psc + 1);
+	uint32_t lag_ticks = (lag_cycles + cycles_per_tick / 2) / cycles_per_tick;
+
+	return (phase_ticks + lag_ticks) % period;
+}
+
+void TimerGroup::stop() {
+	for(uint32_t i = 0; i < num_timers; i++)
+		timers[i]->disable_tim();
+}
+
 //================================== TIMING CLASS INTERRUPT SERVICE ROUTINE ===================================
 
-void Timer::ISR_func(int channel) {
+void RAMFUNC Timer::ISR_func(int channel) {
+	TIM_TypeDef *tim = Timer::timer_chan_configs[channel].htim.Instance;
+	TRACE(TRACE_TIMER_ISR_ENTER, channel);
+
+	//compare happens right at rollover, so the counter is how long it took us to get here
+	uint32_t latency = tim->CNT;
+
 	//clear the flag in the corresponding timer register
-	Timer::timer_chan_configs[channel].htim.Instance->SR = 0;
+	tim->SR = 0;
 
 	//run the callback function of the corresponding timer channel
 	Timer::callbacks[channel]();
+
+	//if the compare flag came back while the callback was running, we missed our deadline
+	//leave the flag set so we come right back in, but let the app know it should shed some work
+	//do that right here by default--deferring it would leave PendSV starved behind the very overrun it's meant to fix
+	uint32_t completion = tim->CNT;
+	bool overran = (tim->SR & TIM_SR_CC1IF) != 0;
+	if(overran) {
+		completion += tim->ARR + 1; //we're at least a whole period late
+		Timer::count(Timer::overrun_stats[channel].overruns); //counted here--PendSV never runs while this keeps happening
+		TRACE(TRACE_TIMER_OVERRUN, channel);
+		if(Timer::overrun_deferred[channel]) Timer::overrun_work[channel].queue();
+		else Timer::overrun_callbacks[channel]();
+	}
+
+	//hand the raw numbers off and let PendSV work out the maxima
+	uint32_t head = Timer::stats_head[channel];
+	if(head - Timer::stats_tail[channel] < TIMER_STATS_DEPTH) {
+		timer_deadline_sample_t &sample = Timer::stats_samples[channel][head & (TIMER_STATS_DEPTH - 1)];
+		sample.latency = latency;
+		sample.completion = completion;
+		__DMB(); //sample lands before the head says it's there
+		Timer::stats_head[channel] = head + 1;
+		Timer::stats_work[channel].queue();
+	}
+	else Timer::count(Timer::overrun_stats[channel].dropped_samples);
+	TRACE(TRACE_TIMER_ISR_EXIT, channel);
+}
+
+//the app can clear the stats from anywhere, so bumping a count has to be atomic
+void RAMFUNC Timer::count(volatile uint32_t &counter) {
+	uint32_t old_val;
+	do {
+		old_val = __LDREXW(&counter);
+	} while(__STREXW(old_val + 1, &counter));
 }
 
+//runs from PendSV, folds the maxima the ISR handed off into the stats
+void Timer::tally_stats(int channel) {
+	volatile timer_overrun_stats_t &stats = Timer::overrun_stats[channel];
+	uint32_t tail = Timer::stats_tail[channel];
+	while(tail != Timer::stats_head[channel]) {
+		__DMB(); //don't read the sample before we've seen the head
+		const timer_deadline_sample_t &sample = Timer::stats_samples[channel][tail & (TIMER_STATS_DEPTH - 1)];
+		if(sample.latency > stats.worst_latency) stats.worst_latency = sample.latency;
+		if(sample.completion > stats.worst_completion) stats.worst_completion = sample.completion;
+		tail++;
+		__DMB(); //done with the slot before we hand it back
+		Timer::stats_tail[channel] = tail;
+	}
+}
+
+void Timer::tally_chan_0() { Timer::tally_stats(0); }
+void Timer::tally_chan_1() { Timer::tally_stats(1); }
+void Timer::tally_chan_2() { Timer::tally_stats(2); }
+void Timer::tally_chan_3() { Timer::tally_stats(3); }
+
 //======================================= TIMER ISRs MAPPED TO VECTOR TABLE ===================================
 
-void CHAN_0_IRQ_HANDLER(void) {
+void RAMFUNC CHAN_0_IRQ_HANDLER(void) {
 	//service the ISR with the class on channel 1
+	NESTING_SAMPLE();
+	ISR_PROFILE_ENTER(PROFILE_TIMER_CHAN_0);
 	Timer::ISR_func(0);
+	ISR_PROFILE_EXIT(PROFILE_TIMER_CHAN_0);
 }
 
-void CHAN_1_IRQ_HANDLER(void) {
+void RAMFUNC CHAN_1_IRQ_HANDLER(void) {
 	//service the ISR with the class on channel 2
+	NESTING_SAMPLE();
+	ISR_PROFILE_ENTER(PROFILE_TIMER_CHAN_1);
 	Timer::ISR_func(1);
+	ISR_PROFILE_EXIT(PROFILE_TIMER_CHAN_1);
 }
 
-void CHAN_2_IRQ_HANDLER(void) {
+void RAMFUNC CHAN_2_IRQ_HANDLER(void) {
 	//service the ISR with the class on channel 3
+	NESTING_SAMPLE();
+	ISR_PROFILE_ENTER(PROFILE_TIMER_CHAN_2);
 	Timer::ISR_func(2);
+	ISR_PROFILE_EXIT(PROFILE_TIMER_CHAN_2);
+}
+
+void RAMFUNC CHAN_3_IRQ_HANDLER(void) {
+	//service the ISR with the class on channel 4
+	NESTING_SAMPLE();
+	ISR_PROFILE_ENTER(PROFILE_TIMER_CHAN_3);
+	Timer::ISR_func(3);
+	ISR_PROFILE_EXIT(PROFILE_TIMER_CHAN_3);
 }
 
 void empty_handler() {}
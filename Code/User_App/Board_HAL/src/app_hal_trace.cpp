@@ -0,0 +1,55 @@
+/*
+ * app_hal_trace.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "app_hal_trace.h"
+
+#define TRACE_FORMAT_VERSION 1
+#define DUMP_TIMEOUT_MS 2000 //a full ring is ~0.7s at 115200 baud
+
+//=========================== INITIALIZING STATIC MEMBERS HERE ==========================
+trace_record_t Trace::ring[TRACE_DEPTH];
+volatile uint32_t Trace::head = 0;
+volatile bool Trace::running = false;
+
+void Trace::start() {
+	Trace::running = false;
+	Trace::head = 0;
+	__DMB(); //make sure nobody sees the old head with the new run flag
+	Trace::running = true;
+}
+
+void Trace::stop() {
+	Trace::running = false;
+}
+
+void Trace::dump(UART_HandleTypeDef *huart) {
+	//hold off writers so the ring doesn't move under us
+	bool was_running = Trace::running;
+	Trace::running = false;
+	__DMB();
+
+	uint32_t head = Trace::head;
+	uint32_t count = (head > TRACE_DEPTH) ? TRACE_DEPTH : head;
+	uint32_t tick_freq = Timestamp::get_tick_freq();
+
+	uint8_t header[16] = {'Q', 'S', 'T', 'R',
+			(uint8_t)TRACE_FORMAT_VERSION, (uint8_t)(TRACE_FORMAT_VERSION >> 8),
+			(uint8_t)sizeof(trace_record_t), 0,
+			(uint8_t)tick_freq, (uint8_t)(tick_freq >> 8), (uint8_t)(tick_freq >> 16), (uint8_t)(tick_freq >> 24),
+			(uint8_t)count, (uint8_t)(count >> 8), (uint8_t)(count >> 16), (uint8_t)(count >> 24)};
+	HAL_UART_Transmit(huart, header, sizeof(header), DUMP_TIMEOUT_MS);
+
+	//oldest record first; it's a little endian core, so the records go out as they sit in memory
+	//the ring might wrap partway through, so send it in up to two pieces
+	uint32_t first = (head - count) & (TRACE_DEPTH - 1);
+	uint32_t first_len = (first + count > TRACE_DEPTH) ? TRACE_DEPTH - first : count;
+	if(first_len)
+		HAL_UART_Transmit(huart, (uint8_t*)&Trace::ring[first], first_len * sizeof(trace_record_t), DUMP_TIMEOUT_MS);
+	if(count > first_len)
+		HAL_UART_Transmit(huart, (uint8_t*)&Trace::ring[0], (count - first_len) * sizeof(trace_record_t), DUMP_TIMEOUT_MS);
+
+	Trace::running = was_running;
+}
@@ -0,0 +1,94 @@
+/*
+ * benchmark.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Opt-in on-target micro-benchmarks for the hot paths, timed with the DWT cycle counter
+ *  Every benchmark runs one operation at a time with interrupts masked, so the numbers don't move between runs:
+ *   - DIO::set()/clear(), and set() again with GPIO_Capture recording (only when built with GPIO_CAPTURE)
+ *   - Soft_PWM::update() across a bank of channels
+ *   - the Hard_PWM ISRs driving 1, 4 and 8 channels (8 is both groups back to back)
+ *   - Debouncer::sample_and_update(), and PortDebouncer::sample_and_update() across all 16 pins of a port
+ *   - Timer ISR dispatch (straight through the IRQ handler)
+ *   - Timestamp::now_ticks()/now_ticks32()
+ *   - Deferred_Work::queue(), onto an empty list and onto a list that already holds the item
+ *   - Scheduler: a post through to its (empty) task having run, and `run_once()` dispatching a task that's already ready
+ *   - ISR_Profiler::enter() and exit() together, i.e. what profiling adds to every ISR
+ *   - Input_Event_Queue: a push, and draining a batch of 8
+ *   - Soft_Timer arm and cancel (expiry and `tick()` with lots of timers armed are host-only, see host_bench.cpp)
+ *  The cost of the measurement itself is taken out by timing an empty operation first
+ *  Run them after `Hard_PWM::configure()` but before the other timers are started--the Hard_PWM timers get stopped for the run
+ *  and put back afterwards, along with the ISR tables the benchmarks load their own channels into
+ *
+ *  Results come out over the UART as a single JSON object, so runs can be diffed against a stored baseline:
+ *  {"cpu_hz":180000000,"benchmarks":[{"name":"dio_set","iterations":1024,"cycles_min":..,"cycles_mean":..,
+ *    "ns_per_op":..,"ops_per_s":..,"instructions":..}, ...]}
+ *  "instructions" comes from the DWT event counters, which are only 8 bits wide--
+ *  it's null for anything that takes longer than 255 cycles, since those counters may have wrapped
+ *
+ *  The host build runs the same table through Code/Host/bench/host_bench.cpp, timed with the host's clock instead,
+ *  and checks it against the baseline stored next to it (`cmake --build <dir> --target bench`)
+ *
+ *  To enable, set BENCHMARKS to 1 here (or pass -DBENCHMARKS=1)
+ */
+
+#ifndef INC_BENCHMARK_H_
+#define INC_BENCHMARK_H_
+
+#ifndef BENCHMARKS
+#define BENCHMARKS 0
+#endif
+
+#define BENCHMARK_ITERATIONS 1024
+#define BENCHMARK_SOFT_PWM_CHANNELS 8
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "app_hal_int_utils.h"
+
+typedef struct {
+	const char *name;
+	callback_function_t op; //does exactly one operation
+	callback_function_t setup; //untimed, puts things back the way `op` expects them before every run--NULL if there's nothing to do
+} benchmark_t;
+
+typedef struct {
+	uint32_t cycles_min;
+	uint32_t cycles_mean;
+	int32_t instructions; //-1 if the event counters could have wrapped
+} benchmark_result_t;
+
+class Benchmark {
+public:
+	//runs every benchmark and dumps the JSON--blocking, with interrupts masked the whole way through (the UART is polled)
+	//call this from main context after `Hard_PWM::configure()`, but BEFORE any of the other timers are started
+	//this pokes the real ISRs and the scratch pin, so expect a small glitch on the red LED while it runs
+	static void run_all(UART_HandleTypeDef *huart);
+
+	static benchmark_result_t run(callback_function_t op, callback_function_t setup = NULL);
+
+	//the table `run_all()` goes through, for runners that time it some other way (the host build)
+	//call `drop_hard_pwm_edges()` after each one like `run_all()` does, or PendSV goes looking for pins the Hard_PWM ones don't have
+	static const benchmark_t *get_benchmarks(uint32_t *count);
+	static void drop_hard_pwm_edges();
+
+private:
+	//shouldn't be able to instantiate this class
+	Benchmark(){};
+
+	static void enable_counters();
+
+	//everything that needs at Hard_PWM's insides, see the .cpp
+	static const benchmark_t benchmarks[];
+	static void save_hard_pwm();
+	static void restore_hard_pwm();
+	static void load_hard_pwm(uint8_t group, uint8_t channels);
+	static void hard_pwm_1ch();
+	static void hard_pwm_4ch();
+	static void hard_pwm_8ch();
+	static void bench_hard_pwm_a();
+	static void bench_hard_pwm_ab();
+};
+
+#endif /* INC_BENCHMARK_H_ */
@@ -0,0 +1,85 @@
+/*
+ * cpu_load.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  CPU load and headroom accounting
+ *  The scheduler sleeps in WFI whenever nothing is ready, so idle time is just the time spent in that WFI:
+ *   - `Scheduler::run_once()` reports every sleep (and every task run) here, timed off the timestamp counter
+ *     (the DWT cycle counter stops while the core is asleep, the timestamp timer doesn't)
+ *   - `sample()` runs every 10ms and turns that into busy/total samples, which feed sliding windows:
+ *     10ms (1 sample), 1s (the last 100 samples) and 10s (the last 10 one-second windows, updated once a second)
+ *   - per-task time is collected over the same 1s window (includes any ISRs that preempted the task)
+ *   - time spent blocked on a polled UART transmit isn't load, just waiting on the wire, so telemetry brackets it with
+ *     `begin_blocking()`/`end_blocking()` and it drops out of busy AND total (and out of the task's time)
+ *     the load is then over the time we weren't blocked--ISRs that land while blocked drop out along with it
+ *   - per-ISR load comes from `ISR_Profiler` when ISR_PROFILING is on
+ *
+ *  Loads are all in 0.01% units
+ */
+
+#ifndef INC_CPU_LOAD_H_
+#define INC_CPU_LOAD_H_
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "load_window.h"
+#include "scheduler.h" //for SCHEDULER_MAX_TASKS
+
+#define CPU_LOAD_SAMPLE_MS		10
+#define CPU_LOAD_1S_SLOTS		(1000 / CPU_LOAD_SAMPLE_MS)
+#define CPU_LOAD_10S_SLOTS		10
+
+class CPU_Load {
+public:
+	//called from the scheduler
+	static void add_idle(const uint32_t ticks); //call with interrupts masked
+	static void add_task(const uint32_t priority, const uint32_t ticks);
+
+	//bracket a wait that shouldn't count as load (i.e. a blocking UART transmit)--main context only, don't nest
+	static void begin_blocking();
+	static void end_blocking();
+
+	//call every CPU_LOAD_SAMPLE_MS from a single context (i.e. a soft timer)
+	static void sample();
+
+	static uint32_t get_load_10ms();
+	static uint32_t get_load_1s();
+	static uint32_t get_load_10s();
+	static uint32_t get_task_load(const uint32_t priority); //over the last full second
+
+	//how fast an event (i.e. a step) could run before we're out of idle time, given the last second of load
+	//this is an upper bound--it doesn't account for deadlines, that's `Priority_Registry`'s job
+	static uint32_t max_event_rate(const uint32_t current_rate_hz, const uint32_t cycles_per_event);
+
+	/*
+	 * blocking telemetry dump--call this from main context
+	 * cpu,<10ms load>,<1s load>,<10s load>,<max step rate Hz>
+	 * task,<priority>,<load>		(one per task that ran in the last second)
+	 * isr,<name>,<load>			(one per profiled ISR, only with ISR_PROFILING on)
+	 */
+	static void report(UART_HandleTypeDef *huart, const uint32_t step_rate_hz, const uint32_t cycles_per_step);
+
+private:
+	//shouldn't be able to instantiate this class
+	CPU_Load(){};
+
+	static volatile uint32_t idle_ticks; //since the last sample
+	static volatile uint32_t blocked_ticks; //since the last sample
+	static volatile uint32_t blocked_since; //start of the blocked time the sampler hasn't seen yet
+	static volatile bool blocking;
+	static uint32_t blocking_start; //start of the whole blocking stretch
+	static uint32_t task_blocked_ticks; //not yet taken out of the running task's time
+	static volatile uint32_t task_ticks[SCHEDULER_MAX_TASKS]; //since the last full second
+	static uint32_t task_ticks_1s[SCHEDULER_MAX_TASKS];
+	static uint32_t task_total_1s;
+	static uint32_t last_sample;
+	static bool started;
+
+	static Load_Window window_10ms;
+	static Load_Window window_1s;
+	static Load_Window window_10s;
+};
+
+#endif /* INC_CPU_LOAD_H_ */
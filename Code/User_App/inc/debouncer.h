@@ -6,6 +6,15 @@
  *
  *  This thread was very useful:
  *  https://stackoverflow.com/questions/69811934/would-it-be-possible-to-call-a-function-in-every-instance-of-a-class-in-c
+ *
+ *  INTERRUPT MODE:
+ *  Instead of calling `sample_and_update()` at 1kHz forever, a debouncer can sit on its EXTI line and cost nothing while idle
+ *   - an edge on the pin masks its EXTI line and arms the debouncer on a shared 1kHz sampling timer
+ *   - the sampling timer runs the normal `sample_and_update()` on every armed debouncer
+ *   - once an armed debouncer's input is stable it goes back to EXTI-only
+ *   - when nothing is armed, the sampling timer interrupt gets shut off completely
+ *  Call `configure_interrupt_sampling()` once with the shared timer, then `enable_interrupt_mode()` on each debouncer
+ *  Don't call `sample_and_update()` yourself on a debouncer in interrupt mode
  */
 
 #ifndef INC_DEBOUNCER_H_
@@ -15,8 +24,18 @@ extern "C" {
 	#include "stm32f4xx_hal.h"
 }
 #include "app_hal_dio.h"
+#include "app_hal_ramfunc.h"
+#include "app_hal_timing.h"
+#include "app_hal_exti.h"
+#include "input_events.h"
 #include "stdbool.h"
 
+//bits of the packed flag word returned by `get_flags_db()`
+#define DEBOUNCE_FLAG_RISING	(1UL << 0)
+#define DEBOUNCE_FLAG_FALLING	(1UL << 1)
+#define DEBOUNCE_FLAG_CHANGE	(1UL << 2)
+#define DEBOUNCE_FLAG_STATE		(1UL << 3) //current debounced state, not an edge
+
 class Debouncer {
 public:
 	Debouncer(const DIO &_pin, const uint32_t _bounce_time_ms, const bool _inverted);
@@ -26,21 +45,63 @@ public:
 	uint8_t get_falling_edge_db(bool clear_flag = true);
 	uint8_t get_change_db(bool clear_flag = true);
 	uint8_t read_db();
+	uint32_t get_flags_db(bool clear_edges = false); //every flag at once, from a single load (or a single atomic fetch-and-clear)
 
 
 	//aggressively optimize here since this will likely be called from ISR
 	//call this function at 1kHz
-	void __attribute__((optimize("O3"))) sample_and_update();
+	void RAMFUNC __attribute__((optimize("O3"))) sample_and_update();
+
+	//switch between the default counter debouncing and an integrating filter with hysteresis (better on noisy, long cable runs)
+	//thresholds are in samples, and the integrator runs from 0 to the bounce time
+	void set_integrator_mode(const uint32_t _high_threshold, const uint32_t _low_threshold);
+	void set_counter_mode();
+
+	//jump straight to a debounced state without flagging an edge, and throw away any debounce in progress
+	//safe to call from an ISR that preempts `sample_and_update()`--the flags update is atomic, though a sample we preempted may still count from the old state
+	void RAMFUNC __attribute__((optimize("O3"))) force_state(bool state);
+
+	//push every debounced edge into a queue as well as setting the flags
+	void set_event_queue(Input_Event_Queue *_queue, uint8_t _pin_id);
+
+	//interrupt mode--pass a timer that's been init'd and set to 1kHz, we'll take care of its callback and interrupts
+	static void configure_interrupt_sampling(Timer &_sample_timer);
+	void enable_interrupt_mode(int_priority_t edge_priority);
+	void disable_interrupt_mode();
 
 private:
-	//storing all these flags as their own bools, rather than a single structure
-	//allows for greater read/write atomicity (i.e. can clear rising flag while asserting falling flag)
-	volatile bool rising_db;
-	volatile bool falling_db;
-	volatile bool change_db;
-	volatile bool state_db;
+	bool RAMFUNC __attribute__((optimize("O3"))) read_input();
+	void RAMFUNC __attribute__((optimize("O3"))) record_edge(bool input);
+	void RAMFUNC __attribute__((optimize("O3"))) update_integrator(bool input);
+	bool is_settled(bool input);
+
+	//interrupt mode handlers
+	static void __attribute__((optimize("O3"))) edge_isr(uint32_t line);
+	static void __attribute__((optimize("O3"))) sample_armed();
+	static void arm_line(uint32_t line);
+
+	static Timer *sample_timer; //shared timer that samples armed debouncers
+	static Debouncer *line_owners[NUM_EXTI_LINES]; //which debouncer sits on each EXTI line
+	static volatile uint32_t armed_lines; //bitmask of EXTI lines currently being sampled
+
+
+	uint8_t fetch_and_clear(uint32_t flag_mask);
+
+	//all flags are packed into a single word (DEBOUNCE_FLAG_xxx bits)
+	//every read-modify-write goes through LDREX/STREX, so setting and clearing flags from different contexts never loses an edge
+	volatile uint32_t flags;
 	volatile uint32_t bounce_counter; //counter that gets decremented when we bounce
 
+	//integrating mode
+	volatile bool integrating;
+	uint32_t integrator; //saturating count of HIGH vs LOW samples
+	uint32_t integrator_max;
+	uint32_t high_threshold;
+	uint32_t low_threshold;
+
+	Input_Event_Queue *event_queue = NULL; //where to push edges, if anywhere
+	uint8_t pin_id = 0; //ID that identifies our edges in the queue
+
 	const DIO PIN; //pin that we're reading/debouncing
 	const uint32_t BOUNCE_TIME; //time for which to debounce in ms
 	const bool INVERTED; //if input HIGH means it's deasserted
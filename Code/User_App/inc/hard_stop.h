@@ -0,0 +1,86 @@
+/*
+ * hard_stop.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Fast path for limit switches and e-stops
+ *  Polled debouncing takes milliseconds to react, which is way too slow to stop a 20kHz step train
+ *  Instead, the input sits on its own EXTI line at REALTIME priority and trips on the very first assert edge:
+ *   - the step pin gets switched from output to input (with a pull-down) so NOTHING can drive it, even a step ISR we preempted mid-pulse
+ *   - the step timer is stopped and its interrupt killed
+ *   - the current position and a timestamp get latched
+ *  Debouncing only matters for re-arming:
+ *   - the trip forces the re-arm debouncer to asserted, so whatever it had seen before the trip doesn't count
+ *   - `rearm()` refuses to do anything until the debounced AND raw input have both read deasserted on every sample
+ *     for the full re-arm bounce time, all of it sampled after the trip
+ *  Every MODER/PUPDR read-modify-write on the step port outside of the trip happens with interrupts masked,
+ *  so a trip can't land in the middle of one and get its MODER write undone
+ *  NOTE: that only covers this class--anything else that RMWs the step port's MODER should mask interrupts too
+ *
+ *  NOTE: since EXTI lines 5-9 and 10-15 share an NVIC channel (and a priority), avoid putting a hard stop
+ *  on the same group as lower priority EXTI users
+ */
+
+#ifndef INC_HARD_STOP_H_
+#define INC_HARD_STOP_H_
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "app_hal_dio.h"
+#include "app_hal_timing.h"
+#include "app_hal_exti.h"
+#include "debouncer.h"
+#include "stdbool.h"
+
+class Hard_Stop {
+public:
+	Hard_Stop(const DIO &_input, const bool _inverted, const uint32_t _rearm_bounce_time_ms);
+
+	//what to shut down when we trip, and where to latch the position from
+	void attach_step_output(Timer &_step_timer, const DIO &_step_pin);
+	void attach_position(volatile int32_t *_position);
+
+	//start listening for the input
+	void arm();
+
+	//clear the trip and give the step pin back; fails if the input is still (or not yet stably) asserted since the trip
+	//restarting the step timer is up to the app
+	bool rearm();
+
+	bool is_tripped();
+	int32_t get_latched_position();
+	uint64_t get_trip_time(); //`Timestamp` ticks
+
+	//call this at 1kHz to keep the re-arm debouncer up to date
+	void sample_and_update();
+
+private:
+	//don't allow one of these to be copied, the EXTI handler holds a pointer to the original
+	Hard_Stop(Hard_Stop &other);
+
+	static void RAMFUNC __attribute__((optimize("O3"))) trip_isr(uint32_t line);
+	void RAMFUNC __attribute__((optimize("O3"))) trip();
+	bool release_step_pin();
+	bool input_asserted();
+
+	static Hard_Stop *line_owners[NUM_EXTI_LINES]; //which hard stop sits on each EXTI line
+
+	volatile bool tripped;
+	volatile int32_t latched_position;
+	volatile uint64_t trip_time;
+	volatile uint32_t trip_count; //bumped by every trip, so a sample we preempted knows not to count
+	volatile uint32_t deasserted_samples; //how many samples in a row (since the trip) the input has read deasserted
+
+	Timer *step_timer;
+	GPIO_TypeDef *step_port; //port registers for the step pin, so we can take it away from the output driver
+	uint32_t step_pin_num;
+	volatile int32_t *position;
+
+	const DIO INPUT;
+	const bool INVERTED;
+	const uint32_t REARM_SAMPLES; //how long the input has to stay deasserted before we'll re-arm
+	Debouncer rearm_debouncer;
+};
+
+#endif /* INC_HARD_STOP_H_ */
@@ -0,0 +1,69 @@
+/*
+ * input_events.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Lock-free queue of timestamped, debounced input edges
+ *  Debouncers push an event for every edge they accept, so bursts of edges between polls don't get collapsed into one sticky flag
+ *  The main loop then drains everything in one go
+ *
+ *  Any number of ISRs (at any priorities) can push, but only ONE context should ever pop/drain
+ *  Each slot carries a sequence number (bounded MPMC queue a la Dmitry Vyukov):
+ *   - producers claim a slot by bumping the enqueue position with LDREX/STREX, fill it, then publish it by updating its sequence
+ *   - the timestamp is taken inside the claim, so events come out in timestamp order even across preempting producers
+ *   - the consumer only reads a slot once its sequence says it has been published
+ *  If the queue is full, new events get dropped and counted
+ */
+
+#ifndef INC_INPUT_EVENTS_H_
+#define INC_INPUT_EVENTS_H_
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "stdbool.h"
+#include "app_hal_ramfunc.h"
+
+#define INPUT_EVENT_QUEUE_SIZE 64 //MUST be a power of 2
+
+typedef enum Input_Edges {
+	INPUT_EDGE_FALLING = 0,
+	INPUT_EDGE_RISING = 1
+} input_edge_t;
+
+typedef struct {
+	uint64_t timestamp; //`Timestamp` ticks when the debounced edge was accepted
+	uint8_t pin_id; //whatever ID the debouncer was registered with
+	uint8_t edge; //input_edge_t
+} input_event_t;
+
+class Input_Event_Queue {
+public:
+	Input_Event_Queue();
+
+	//aggressively optimize here since this will be called from ISRs
+	//returns false (and counts a drop) if the queue is full
+	bool RAMFUNC __attribute__((optimize("O3"))) push(uint8_t pin_id, input_edge_t edge);
+
+	//consumer side--only call these from one context
+	bool pop(input_event_t &event);
+	uint32_t drain(input_event_t events[], const uint32_t max_events); //returns number of events copied out
+
+	uint32_t get_dropped(bool clear = true);
+
+private:
+	//don't allow one of these to be copied, producers hold pointers to the original
+	Input_Event_Queue(Input_Event_Queue &other){}
+
+	typedef struct {
+		volatile uint32_t sequence;
+		input_event_t event;
+	} slot_t;
+
+	slot_t slots[INPUT_EVENT_QUEUE_SIZE];
+	volatile uint32_t enqueue_pos;
+	uint32_t dequeue_pos;
+	volatile uint32_t dropped;
+};
+
+#endif /* INC_INPUT_EVENTS_H_ */
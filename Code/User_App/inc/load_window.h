@@ -0,0 +1,49 @@
+/*
+ * load_window.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Sliding window of busy/total time samples, for CPU load figures
+ *  Every `push()` drops the oldest sample and adds the newest, keeping running sums so reading the load is O(1)
+ *  Windows cascade: push the window's own totals into a longer window every time it wraps (see `CPU_Load`)
+ *
+ *  Slot storage is handed in by the owner, so there's no heap and windows of any length cost only what they use
+ *  Pure arithmetic, no hardware access, so this builds and runs anywhere
+ */
+
+#ifndef INC_LOAD_WINDOW_H_
+#define INC_LOAD_WINDOW_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+class Load_Window {
+public:
+	//`_busy_slots` and `_total_slots` both need room for `_num_slots` samples
+	Load_Window(uint32_t *_busy_slots, uint32_t *_total_slots, const uint32_t _num_slots);
+
+	//returns true every time the window wraps around (i.e. every `num_slots` pushes)
+	bool push(const uint32_t busy, const uint32_t total);
+	void clear();
+
+	//load over however many samples we've got (up to a full window), in 0.01% units
+	uint32_t get_load_centipercent();
+	uint64_t get_busy();
+	uint64_t get_total();
+	bool is_full(); //whether we have a full window worth of samples yet
+
+private:
+	//don't allow one of these to be copied, they'd share the slot storage
+	Load_Window(Load_Window &other);
+
+	uint32_t *busy_slots;
+	uint32_t *total_slots;
+	const uint32_t NUM_SLOTS;
+
+	uint32_t index = 0; //next slot to overwrite
+	uint32_t filled = 0;
+	uint64_t busy_sum = 0;
+	uint64_t total_sum = 0;
+};
+
+#endif /* INC_LOAD_WINDOW_H_ */
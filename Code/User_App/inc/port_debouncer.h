@@ -0,0 +1,73 @@
+/*
+ * port_debouncer.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Debounces up to 16 pins on the same GPIO port in parallel
+ *  Reads the whole input data register once per sample, then runs a 2-bit vertical (bit-sliced) counter on every pin at once:
+ *   - bit N of `count_lo`/`count_hi` together form a 2-bit counter for pin N
+ *   - a pin's counter runs while its input disagrees with its debounced state, and resets the moment they agree
+ *   - when the counter rolls over (4 consecutive disagreeing samples) the debounced state flips
+ *  So the debounced state changes after 4 stable sample periods, and each sample period is `bounce_time_ms / 4`
+ *
+ *  Compared to a `Debouncer` with the same bounce time, on an input whose bounces die out within one sample period:
+ *  the same edges, each within one sample period of the `Debouncer`'s (test_port_debouncer checks this on seeded traces)
+ *   - usually up to a period EARLIER--`Debouncer` looks again a full bounce time after the first edge, we flip on our
+ *     4th sample, which can come as soon as 3 periods after it
+ *   - up to a period LATER if one of our samples lands on a bounce, since that restarts the count
+ *  Bounces longer than that can each cost another period, since we only look every `bounce_time_ms / 4`
+ *
+ *  Edge flags are bitmasks with bit N corresponding to pin N of the port
+ */
+
+#ifndef INC_PORT_DEBOUNCER_H_
+#define INC_PORT_DEBOUNCER_H_
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "app_hal_dio.h"
+#include "app_pin_mapping.h"
+#include "input_events.h"
+
+class PortDebouncer {
+public:
+	//pin mask selects which pins on the port we debounce, inverted mask flags pins where input HIGH means deasserted
+	PortDebouncer(const gpio_port_t _port, const uint16_t _pin_mask, const uint32_t _bounce_time_ms, const uint16_t _inverted_mask);
+
+	//quick functions to read (and clear) flags for every pin at once
+	uint16_t get_rising_edges_db(bool clear_flags = true);
+	uint16_t get_falling_edges_db(bool clear_flags = true);
+	uint16_t get_changes_db(bool clear_flags = true);
+	uint16_t read_db();
+
+	//aggressively optimize here since this will likely be called from ISR
+	//call this function at 1kHz
+	void __attribute__((optimize("O3"))) sample_and_update();
+
+	//push every debounced edge into a queue as well, pin N of the port shows up as ID `_first_pin_id + N`
+	void set_event_queue(Input_Event_Queue *_queue, uint8_t _first_pin_id);
+
+private:
+	static uint16_t fetch_and_clear(volatile uint16_t *mask);
+	static void atomic_or(volatile uint16_t *mask, uint16_t bits);
+
+	volatile uint16_t rising_db;
+	volatile uint16_t falling_db;
+	volatile uint16_t change_db;
+	volatile uint16_t state_db;
+
+	uint16_t count_lo; //low bit of every pin's vertical counter
+	uint16_t count_hi; //high bit of every pin's vertical counter
+	uint32_t sample_countdown; //ms until we take the next sample
+
+	Input_Event_Queue *event_queue; //where to push edges, if anywhere
+	uint8_t first_pin_id; //ID of pin 0 on the port in the queue
+
+	const gpio_port_t PORT;
+	const uint16_t PIN_MASK;
+	const uint16_t INVERTED_MASK;
+	const uint32_t SAMPLE_PERIOD; //ms between samples fed to the vertical counters
+};
+
+#endif /* INC_PORT_DEBOUNCER_H_ */
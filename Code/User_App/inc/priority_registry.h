@@ -0,0 +1,74 @@
+/*
+ * priority_registry.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Automatic interrupt priority assignment with a schedulability check
+ *  Every periodic interrupt source declares how often it fires, its deadline, and its worst case execution time (WCET)
+ *  `assign()` then:
+ *   - hands out `int_priority_t` levels deadline-monotonically (shortest deadline most urgent)
+ *     with deadlines left at the period this is plain rate-monotonic
+ *   - sources with the same deadline share a level; if we run out of levels, the slowest sources all share the lowest one
+ *   - runs a response-time analysis on every source: R = C + B + sum(ceil(R/Tj) * Cj) over all sources at the same or higher priority
+ *     same-level sources are counted as interference, which is pessimistic but safe for NVIC sub-priority ordering
+ *   - rejects the whole set if any source's worst case response overruns its deadline
+ *
+ *  All times are in CPU cycles--start from budgets, then feed in `ISR_Profiler` max cycles (with some margin on top)
+ *  through `set_wcet()` once there are measurements, and `check()` the set again with the priorities it already has
+ *  Pure arithmetic, no hardware access, so this builds and runs anywhere
+ */
+
+#ifndef INC_PRIORITY_REGISTRY_H_
+#define INC_PRIORITY_REGISTRY_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "app_hal_int_utils.h"
+
+#define PRIORITY_REGISTRY_MAX_SOURCES 8
+#define PRIORITY_REGISTRY_INVALID 0xFF //returned when there's no more room for sources
+
+typedef uint8_t isr_source_t;
+
+class Priority_Registry {
+public:
+	//declare a periodic interrupt source, deadline of 0 means the deadline is the period
+	//returns a handle to look up the assigned priority with, or PRIORITY_REGISTRY_INVALID
+	static isr_source_t add_source(const float rate_hz, const uint32_t wcet_cycles, const uint32_t deadline_cycles = 0);
+
+	//worst case time a source can be held off by something the registry doesn't know about
+	//i.e. the longest interrupts-masked critical section, or unmanaged REALTIME ISRs (hard stops, etc.)
+	static void set_blocking_cycles(const uint32_t cycles);
+
+	//assign levels between `highest` and `lowest` (inclusive) and check every deadline
+	//returns false if the set isn't schedulable--don't start the interrupts if so!
+	static bool assign(const int_priority_t highest = Priorities::HIGH, const int_priority_t lowest = Priorities::LOW);
+
+	//swap in a new WCET (e.g. a measured max), then re-run the response-time analysis without moving any priorities
+	static void set_wcet(const isr_source_t source, const uint32_t wcet_cycles);
+	static bool check();
+
+	static int_priority_t get_priority(const isr_source_t source);
+	static uint32_t get_response_cycles(const isr_source_t source); //worst case response from the last `assign()` or `check()`
+	static uint32_t get_wcet_cycles(const isr_source_t source); //including the ISR entry/exit overhead
+	static uint32_t get_deadline_cycles(const isr_source_t source);
+	static bool meets_deadline(const isr_source_t source);
+
+	static void clear(); //forget every source, mostly for running different task sets through
+
+private:
+	//shouldn't be able to instantiate this class
+	Priority_Registry(){};
+
+	static uint32_t response_time(const isr_source_t source);
+
+	static uint32_t period_cycles[PRIORITY_REGISTRY_MAX_SOURCES];
+	static uint32_t deadline_cycles[PRIORITY_REGISTRY_MAX_SOURCES];
+	static uint32_t wcet_cycles[PRIORITY_REGISTRY_MAX_SOURCES];
+	static int_priority_t priorities[PRIORITY_REGISTRY_MAX_SOURCES];
+	static uint32_t responses[PRIORITY_REGISTRY_MAX_SOURCES];
+	static uint8_t num_sources;
+	static uint32_t blocking_cycles;
+};
+
+#endif /* INC_PRIORITY_REGISTRY_H_ */
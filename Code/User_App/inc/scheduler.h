@@ -0,0 +1,50 @@
+/*
+ * scheduler.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Static, priority-ordered, run-to-completion task scheduler for the main context
+ *  Tasks never block--ISRs (or other tasks) post event bits to a task, and the main loop runs whatever is ready
+ *   - every priority level holds exactly one task, priority 0 being the most urgent
+ *   - a ready bitmap keeps priority 0 in the MSB, so a single CLZ picks the next task to run
+ *   - posting is an LDREX/STREX OR into the task's event word and the ready bitmap, so it's safe from any ISR
+ *   - with nothing ready, the main loop sleeps in WFI until the next interrupt
+ *
+ *  Tasks get handed (and atomically clear) every event bit posted to them since they last ran
+ */
+
+#ifndef INC_SCHEDULER_H_
+#define INC_SCHEDULER_H_
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "stdbool.h"
+
+#define SCHEDULER_MAX_TASKS 32 //one per bit of the ready bitmap
+
+typedef void (*task_function_t)(uint32_t events);
+
+class Scheduler {
+public:
+	//returns false if the priority is out of range or already taken
+	static bool add_task(const uint32_t priority, task_function_t func);
+
+	//mark the task ready and OR in the event bits; safe from any ISR priority
+	//posting no event bits, or to a priority past SCHEDULER_MAX_TASKS, does nothing
+	static void __attribute__((optimize("O3"))) post(const uint32_t priority, const uint32_t events = 1);
+
+	//run the most urgent ready task to completion, or sleep until an interrupt if nothing is ready
+	//call this over and over from the main loop
+	static void __attribute__((optimize("O3"))) run_once();
+
+private:
+	//shouldn't be able to instantiate this class
+	Scheduler(){};
+
+	static task_function_t tasks[SCHEDULER_MAX_TASKS];
+	static volatile uint32_t events[SCHEDULER_MAX_TASKS];
+	static volatile uint32_t ready; //bit (31 - priority) set when a task has events waiting
+};
+
+#endif /* INC_SCHEDULER_H_ */
@@ -17,6 +17,7 @@ extern "C" {
 }
 #include "stdbool.h"
 #include "app_hal_dio.h"
+#include "app_hal_ramfunc.h"
 
 class Soft_PWM {
 public:
@@ -33,7 +34,7 @@ public:
 
 	//aggressively optimize here since this will likely be called from ISR
 	//soft PWM frequency is frequency this function is called at divided by soft pwm resolution
-	void __attribute__((optimize("O3"))) update();
+	void RAMFUNC __attribute__((optimize("O3"))) update();
 
 private:
 	static bool __allow_updates__; //a little semaphore type thing to ensure atomic writes across all of our PWM channels
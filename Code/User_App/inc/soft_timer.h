@@ -0,0 +1,72 @@
+/*
+ * soft_timer.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Software one-shot and periodic timers kept in a hierarchical timing wheel
+ *  The whole wheel is driven by a single call to `Soft_Timer::tick()` from one hardware timer callback
+ *
+ *  Arming, cancelling and expiring a timer are all O(1) regardless of how many timers are active:
+ *   - level 0 has one slot per tick for the next 64 ticks
+ *   - each level above covers 64x the span of the level below it
+ *   - timers are cascaded down a level whenever the level below wraps
+ *  All timer nodes live inside the Soft_Timer objects themselves, so nothing is ever heap allocated
+ *
+ *  Callbacks run from whatever context calls `tick()`, so keep them short
+ */
+
+#ifndef INC_SOFT_TIMER_H_
+#define INC_SOFT_TIMER_H_
+
+extern "C" {
+	#include "stm32f4xx_hal.h"
+}
+#include "stdbool.h"
+#include "app_hal_int_utils.h"
+#include "app_hal_ramfunc.h"
+
+#define SOFT_TIMER_LEVEL_BITS	6
+#define SOFT_TIMER_LEVEL_SLOTS	(1 << SOFT_TIMER_LEVEL_BITS) //64 slots per wheel level
+#define SOFT_TIMER_NUM_LEVELS	4
+#define SOFT_TIMER_MAX_TICKS	((1UL << (SOFT_TIMER_LEVEL_BITS * SOFT_TIMER_NUM_LEVELS)) - 1) //~4.6 hours at a 1kHz tick
+
+//doubly linked list node, used both as the slot heads of the wheel and as the links inside each timer
+typedef struct soft_timer_link {
+	struct soft_timer_link *next;
+	struct soft_timer_link *prev;
+} soft_timer_link_t;
+
+class Soft_Timer : private soft_timer_link_t {
+public:
+	Soft_Timer(callback_function_t _cb);
+	~Soft_Timer(); //cancels the timer so the wheel never points at a dead object
+
+	//delays are in wheel ticks, and get clamped to [1, SOFT_TIMER_MAX_TICKS]
+	//re-arming an armed timer just moves it to its new expiry
+	void arm_oneshot(uint32_t delay_ticks);
+	void arm_periodic(uint32_t period_ticks);
+	void cancel();
+	bool is_armed();
+
+	//call this from a single hardware timer callback at the wheel tick rate
+	static void RAMFUNC __attribute__((optimize("O3"))) tick();
+	static uint32_t get_ticks(); //number of ticks the wheel has processed
+
+private:
+	//don't allow one of these to be copied, the wheel holds pointers to the original
+	Soft_Timer(Soft_Timer &other){}
+
+	void arm(uint32_t delay_ticks, uint32_t period_ticks);
+	void RAMFUNC insert(); //place the timer in the wheel based off of its expiry (call with interrupts masked)
+	void RAMFUNC unlink(); //remove the timer from whatever slot it's sitting in (call with interrupts masked)
+	static void RAMFUNC cascade(uint32_t level, uint32_t index);
+
+	callback_function_t callback;
+	uint32_t expires; //absolute tick the timer expires on
+	uint32_t period; //0 for one-shot timers
+
+	static uint32_t current_tick; //next tick to be processed by the wheel
+	static soft_timer_link_t wheel[SOFT_TIMER_NUM_LEVELS][SOFT_TIMER_LEVEL_SLOTS];
+};
+
+#endif /* INC_SOFT_TIMER_H_ */
@@ -6,14 +6,58 @@
  */
 
 #include "app_main.h"
+extern "C" {
+	#include "main.h" //for Error_Handler()
+	#include "usart.h"
+}
 #include "app_hal_timing.h"
 #include "app_hal_dio.h"
 #include "app_pin_mapping.h"
 #include "app_hal_int_utils.h"
 #include "app_hal_pwm.h"
+#include "app_hal_timestamp.h"
+#include "app_hal_isr_profiler.h"
+#include "app_hal_deferred.h"
+#include "app_hal_ramfunc.h"
+#include "app_hal_trace.h"
+#include "app_hal_stack_monitor.h"
 
 #include "debouncer.h"
 #include "soft_pwm.h"
+#include "soft_timer.h"
+#include "scheduler.h"
+#include "priority_registry.h"
+#include "benchmark.h"
+#include "cpu_load.h"
+#include "stdio.h"
+
+//task priorities for the main context scheduler, most urgent first
+typedef enum App_Tasks {
+	TASK_HOUSEKEEPING = 0,
+	TASK_TELEMETRY
+} app_task_t;
+
+#define DIR_TOGGLE_PERIOD_MS 5000
+#define TELEMETRY_PERIOD_MS 1000
+
+//interrupt rates, and worst case cycles per ISR for the priority registry
+//WCETs are budgets with margin to start with--with ISR_PROFILING on, the telemetry swaps in the measured max and re-checks
+#define SOFT_PWM_RATE_HZ	10000
+#define SOFT_PWM_WCET		600
+#define STEPPER_RATE_HZ		20000
+#define STEPPER_WCET		150
+#define STEP_RATE_HZ		(STEPPER_RATE_HZ / 2) //stepper ISR toggles, so two interrupts per step
+#define SUPERVISOR_RATE_HZ	1
+#define SUPERVISOR_WCET		400
+#define WHEEL_TICK_RATE_HZ	1000
+#define WHEEL_TICK_WCET		500
+#define HARD_PWM_FREQ		1000 //interrupt rate per group comes from the channels mapped to it, see `Hard_PWM::get_irq_rate()`
+#define HARD_PWM_WCET		200
+#define HARD_PWM_DEADLINE	(180000000 / (HARD_PWM_FREQ * 100)) //edges have to land within one PWM count (resolution of 100)
+#define MAX_BLOCKING_CYCLES	200 //longest interrupts-masked section, plus a hard stop trip
+#define WCET_MARGIN_PERCENT	125 //headroom on top of the measured max
+#define TELEMETRY_LINE_LENGTH 64
+#define TELEMETRY_TIMEOUT_MS 100
 
 const DIO led_red(PinMap::red_led);
 const DIO led_yellow(PinMap::yellow_led);
@@ -35,6 +79,11 @@ Timer soft_pwm(Timer_Channels::CHANNEL_0);
 Timer stepper(Timer_Channels::CHANNEL_1); //step the motor driven by a timer (takes the spot of the debouncer in these tests
 
 Timer supervisor(Timer_Channels::CHANNEL_2);
+Timer wheel_tick(Timer_Channels::CHANNEL_3); //drives all the software timers at 1kHz
+
+//start all the timers together so their phase offsets actually hold
+Timer *app_timers[] = {&soft_pwm, &stepper, &supervisor, &wheel_tick};
+TimerGroup app_timer_group(app_timers, 4);
 
 float pwm_val = 0;
 uint32_t counter = 0;
@@ -42,7 +91,7 @@ uint32_t counter = 0;
 bool step_high = false;
 
 //toggle the step pin basically
-void stepper_func() {
+void RAMFUNC stepper_func() {
 	if(step_high) {
 		step_pin.clear();
 		step_high = false;
@@ -54,7 +103,7 @@ void stepper_func() {
 	}
 }
 
-void run_pwm() {
+void RAMFUNC run_pwm() {
 	red_pwm.update();
 	yellow_pwm.update();
 	green_pwm.update();
@@ -70,8 +119,116 @@ void inc_pwm() {
 	green_pwm.set(pwm_val);
 }
 
+//flip the motor direction every time the soft timer posts to us
+void housekeeping_task(uint32_t events) {
+	static bool dir_high = true;
+	dir_high = !dir_high;
+	if(dir_high) dir_pin.set();
+	else dir_pin.clear();
+}
+
+void post_housekeeping() {
+	Scheduler::post(TASK_HOUSEKEEPING);
+}
+
+//every interrupt source the priority registry knows about, and the profiler entry that measures it
+typedef struct {
+	isr_source_t source;
+	isr_profile_id_t profile_id;
+} rta_source_t;
+
+rta_source_t rta_sources[] = {
+		{PRIORITY_REGISTRY_INVALID, PROFILE_TIMER_CHAN_0}, //soft PWM
+		{PRIORITY_REGISTRY_INVALID, PROFILE_TIMER_CHAN_1}, //stepper
+		{PRIORITY_REGISTRY_INVALID, PROFILE_TIMER_CHAN_2}, //supervisor
+		{PRIORITY_REGISTRY_INVALID, PROFILE_TIMER_CHAN_3}, //wheel tick
+		{PRIORITY_REGISTRY_INVALID, PROFILE_PWM_GROUP_A},
+		{PRIORITY_REGISTRY_INVALID, PROFILE_PWM_GROUP_B}
+};
+#define NUM_RTA_SOURCES (sizeof(rta_sources) / sizeof(rta_sources[0]))
+enum {RTA_SOFT_PWM = 0, RTA_STEPPER, RTA_SUPERVISOR, RTA_WHEEL_TICK, RTA_PWM_A, RTA_PWM_B};
+
+#if ISR_PROFILING
+//re-run the response-time analysis with the worst case we've actually measured, and send it out
+void report_rta(UART_HandleTypeDef *huart) {
+	for(uint32_t i = 0; i < NUM_RTA_SOURCES; i++) {
+		isr_profile_stats_t stats = ISR_Profiler::get_stats(rta_sources[i].profile_id);
+		if(stats.count) Priority_Registry::set_wcet(rta_sources[i].source, (uint32_t)(((uint64_t)stats.max_cycles * WCET_MARGIN_PERCENT) / 100));
+	}
+	bool schedulable = Priority_Registry::check();
+
+	char line[TELEMETRY_LINE_LENGTH];
+	int len = snprintf(line, TELEMETRY_LINE_LENGTH, "rta,%u\r\n", schedulable ? 1 : 0);
+	HAL_UART_Transmit(huart, (uint8_t*)line, len, TELEMETRY_TIMEOUT_MS);
+	for(uint32_t i = 0; i < NUM_RTA_SOURCES; i++) {
+		isr_source_t src = rta_sources[i].source;
+		if(src == PRIORITY_REGISTRY_INVALID) continue;
+		len = snprintf(line, TELEMETRY_LINE_LENGTH, "rta_src,%s,%lu,%lu,%lu\r\n", ISR_Profiler::get_name(rta_sources[i].profile_id),
+				(unsigned long)Priority_Registry::get_wcet_cycles(src), (unsigned long)Priority_Registry::get_response_cycles(src),
+				(unsigned long)Priority_Registry::get_deadline_cycles(src));
+		HAL_UART_Transmit(huart, (uint8_t*)line, len, TELEMETRY_TIMEOUT_MS);
+	}
+}
+#endif
+
+//send the CPU load figures out every so often
+void telemetry_task(uint32_t events) {
+#if ISR_PROFILING
+	uint32_t cycles_per_isr = 0;
+	isr_profile_stats_t stats = ISR_Profiler::get_stats(PROFILE_TIMER_CHAN_1); //stepper
+	if(stats.count) cycles_per_isr = (uint32_t)(stats.total_cycles / stats.count);
+#else
+	uint32_t cycles_per_isr = STEPPER_WCET; //no measurements, go off the budget
+#endif
+
+	//the UART is polled, so nearly all of this is waiting on the wire--keep it out of the load figures
+	//(the formatting in between gets left out too, but that's microseconds against tens of milliseconds of transmit)
+	CPU_Load::begin_blocking();
+	CPU_Load::report(&huart2, STEP_RATE_HZ, cycles_per_isr * 2);
+	Stack_Monitor::report(&huart2);
+#if ISR_PROFILING
+	report_rta(&huart2);
+#endif
+	CPU_Load::end_blocking();
+}
+
+void post_telemetry() {
+	Scheduler::post(TASK_TELEMETRY);
+}
+
+Soft_Timer dir_toggle_timer(&post_housekeeping);
+Soft_Timer load_sample_timer(&CPU_Load::sample);
+Soft_Timer telemetry_timer(&post_telemetry);
+
 void app_init() {
+	Vector_Table::relocate(); //fetch vectors from SRAM, before any of our interrupts get turned on
 	DIO::init();
+	Timestamp::init();
+	Deferred_Work::init();
+#if ISR_PROFILING
+	ISR_Profiler::init();
+#endif
+#if TRACING
+	Trace::start();
+#endif
+
+	//Hard_PWM only works out which of its pins the timers drive directly (and so never interrupt) once it's configured,
+	//so bring it up before asking for its rates--at the bottom priority until the registry picks the real ones
+	Hard_PWM::configure(HARD_PWM_FREQ, Priorities::LOW);
+
+	//pick interrupt priorities from the rates, and refuse to run if anything could miss a deadline
+	//REALTIME is left free for the hard stops
+	//the two Hard_PWM timers interrupt separately, each as often as the channels mapped to it need (no source if it never interrupts)
+	rta_sources[RTA_SOFT_PWM].source = Priority_Registry::add_source(SOFT_PWM_RATE_HZ, SOFT_PWM_WCET);
+	rta_sources[RTA_STEPPER].source = Priority_Registry::add_source(STEPPER_RATE_HZ, STEPPER_WCET);
+	rta_sources[RTA_SUPERVISOR].source = Priority_Registry::add_source(SUPERVISOR_RATE_HZ, SUPERVISOR_WCET);
+	rta_sources[RTA_WHEEL_TICK].source = Priority_Registry::add_source(WHEEL_TICK_RATE_HZ, WHEEL_TICK_WCET);
+	rta_sources[RTA_PWM_A].source = Priority_Registry::add_source(Hard_PWM::get_irq_rate(0, HARD_PWM_FREQ), HARD_PWM_WCET, HARD_PWM_DEADLINE);
+	rta_sources[RTA_PWM_B].source = Priority_Registry::add_source(Hard_PWM::get_irq_rate(1, HARD_PWM_FREQ), HARD_PWM_WCET, HARD_PWM_DEADLINE);
+	Priority_Registry::set_blocking_cycles(MAX_BLOCKING_CYCLES);
+	if(!Priority_Registry::assign(Priorities::HIGH, Priorities::LOW)) Error_Handler();
+	Hard_PWM::set_int_priority(0, Priority_Registry::get_priority(rta_sources[RTA_PWM_A].source));
+	Hard_PWM::set_int_priority(1, Priority_Registry::get_priority(rta_sources[RTA_PWM_B].source));
 
 	en_pin.clear();
 	dir_pin.set();
@@ -79,40 +236,49 @@ void app_init() {
 	soft_pwm.init();
 	soft_pwm.set_phase(0);
 	soft_pwm.set_freq(Timer::FREQ_10kHz);
-	soft_pwm.set_int_priority(Priorities::MED);
+	soft_pwm.set_int_priority(Priority_Registry::get_priority(rta_sources[RTA_SOFT_PWM].source));
 	soft_pwm.set_callback_func(&run_pwm);
 
 	stepper.init();
 	stepper.set_phase(0.1);
 	stepper.set_freq(Timer::FREQ_20kHz);
-	stepper.set_int_priority(Priorities::MED_HIGH);
+	stepper.set_int_priority(Priority_Registry::get_priority(rta_sources[RTA_STEPPER].source));
 	stepper.set_callback_func(&stepper_func);
 
 
 	supervisor.init();
 	supervisor.set_phase(0.5);
 	supervisor.set_freq(Timer::FREQ_1Hz);
-	supervisor.set_int_priority(Priorities::LOW);
+	supervisor.set_int_priority(Priority_Registry::get_priority(rta_sources[RTA_SUPERVISOR].source));
 	supervisor.set_callback_func(&inc_pwm);
 
-	soft_pwm.enable_int();
-	soft_pwm.enable_tim();
+	wheel_tick.init();
+	wheel_tick.set_phase(0);
+	wheel_tick.set_freq(Timer::FREQ_1kHz);
+	wheel_tick.set_int_priority(Priority_Registry::get_priority(rta_sources[RTA_WHEEL_TICK].source));
+	wheel_tick.set_callback_func(&Soft_Timer::tick);
 
-	stepper.enable_int();
-	stepper.enable_tim();
+	Scheduler::add_task(TASK_HOUSEKEEPING, &housekeeping_task);
+	dir_toggle_timer.arm_periodic(DIR_TOGGLE_PERIOD_MS);
+	Scheduler::add_task(TASK_TELEMETRY, &telemetry_task);
+	telemetry_timer.arm_periodic(TELEMETRY_PERIOD_MS);
+	load_sample_timer.arm_periodic(CPU_LOAD_SAMPLE_MS);
 
-	supervisor.enable_int();
-	supervisor.enable_tim();
+#if BENCHMARKS
+	//every callback is hooked up but only Hard_PWM is running yet, and the benchmarks mask it (and put its timers back after)
+	Benchmark::run_all(&huart2);
+#endif
 
-	Hard_PWM::configure(1000, Priorities::MED_HIGH);
+	soft_pwm.enable_int();
+	stepper.enable_int();
+	supervisor.enable_int();
+	wheel_tick.enable_int();
+	app_timer_group.start();
 }
 
+//everything in the main context runs as a scheduler task, we sleep when there's nothing to do
 void app_loop() {
-	Timer::delay_ms(5000);
-	dir_pin.clear();
-	Timer::delay_ms(5000);
-	dir_pin.set();
-
+	Scheduler::run_once();
 }
 
 
@@ -0,0 +1,333 @@
+/*
+ * benchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "benchmark.h"
+
+#if BENCHMARKS
+#include "app_hal_dio.h"
+#include "app_hal_pwm.h"
+#include "app_hal_timestamp.h"
+#include "app_hal_deferred.h"
+#include "app_hal_isr_profiler.h"
+#include "app_pin_mapping.h"
+#include "soft_pwm.h"
+#include "debouncer.h"
+#include "port_debouncer.h"
+#include "scheduler.h"
+#include "soft_timer.h"
+#include "input_events.h"
+#include "stdio.h"
+
+#define CPU_F_CLK 180000000UL //180MHz core clock
+#define EVENT_COUNTER_MAX 0xFF //the DWT event counters are only 8 bits
+#define DUMP_LINE_LENGTH 192
+#define DUMP_TIMEOUT_MS 100
+#define BENCH_TASK_PRIORITY (SCHEDULER_MAX_TASKS - 1) //least urgent slot, well clear of the app's tasks
+#define BENCH_SOFT_TIMER_DELAY 1000 //wheel ticks; the wheel isn't ticking while the benchmarks run anyway
+#define BENCH_DRAIN_EVENTS 8
+
+//=========================== THINGS WE'RE BENCHMARKING ==========================
+//using the red LED as a scratch output, and the user button as a scratch input
+static const DIO bench_out(PinMap::red_led);
+static const DIO bench_in(PinMap::user_button);
+
+static Soft_PWM bench_pwm[BENCHMARK_SOFT_PWM_CHANNELS] = {
+		{bench_out, 0, false}, {bench_out, 0, false}, {bench_out, 0, false}, {bench_out, 0, false},
+		{bench_out, 0, false}, {bench_out, 0, false}, {bench_out, 0, false}, {bench_out, 0, false}
+};
+
+static Debouncer bench_debouncer(bench_in, 10, false);
+//every pin on the button's port, with a 4ms bounce time so every call takes a sample (1ms between them)
+static PortDebouncer bench_port_debouncer(PinMap::user_button.port, 0xFFFF, 4, 0);
+
+static void bench_empty() {}
+static Deferred_Work bench_work(bench_empty);
+static void bench_dio_set() { bench_out.set(); }
+static void bench_dio_clear() { bench_out.clear(); }
+static void bench_soft_pwm() {
+	for(uint32_t i = 0; i < BENCHMARK_SOFT_PWM_CHANNELS; i++)
+		bench_pwm[i].update();
+}
+static void bench_debounce() { bench_debouncer.sample_and_update(); }
+static void bench_port_debounce() { bench_port_debouncer.sample_and_update(); }
+static void bench_timer_dispatch() { TIM1_BRK_TIM9_IRQHandler(); }
+static void bench_timestamp() { Timestamp::now_ticks(); }
+static void bench_timestamp32() { Timestamp::now_ticks32(); }
+static void bench_deferred_queue() { bench_work.queue(); }
+
+//take the item back off the list (and drop the PendSV request) so the next queue starts from empty
+static void bench_deferred_drain() {
+	Deferred_Work::run_pending();
+	SCB->ICSR = SCB_ICSR_PENDSVCLR_Msk;
+}
+static void bench_deferred_prequeue() {
+	bench_deferred_drain();
+	bench_work.queue();
+}
+
+//nothing else has posted to the scheduler yet when the benchmarks run, so `run_once()` always picks the benchmark's task
+static void bench_task(uint32_t events) { (void)events; }
+static void bench_scheduler_post_run() {
+	Scheduler::post(BENCH_TASK_PRIORITY);
+	Scheduler::run_once();
+}
+static void bench_scheduler_dispatch() { Scheduler::run_once(); }
+static void bench_scheduler_add_task() { Scheduler::add_task(BENCH_TASK_PRIORITY, bench_task); } //refused (harmlessly) after the first time
+static void bench_scheduler_prepost() {
+	bench_scheduler_add_task();
+	Scheduler::post(BENCH_TASK_PRIORITY);
+}
+
+//arming never expires anything (that would run app callbacks), so expiry and the tick itself are only timed on the host,
+//where the wheel can be loaded with more timers than fit in SRAM here--see Code/Host/bench/host_bench.cpp
+static Soft_Timer bench_soft_timer(bench_empty);
+static void bench_soft_timer_arm() { bench_soft_timer.arm_oneshot(BENCH_SOFT_TIMER_DELAY); }
+static void bench_soft_timer_cancel() { bench_soft_timer.cancel(); }
+
+//push onto an empty queue, and drain a batch back off it
+static Input_Event_Queue bench_queue;
+static input_event_t bench_events[BENCH_DRAIN_EVENTS];
+static void bench_event_push() { bench_queue.push(0, INPUT_EDGE_RISING); }
+static void bench_event_drain() { bench_queue.drain(bench_events, BENCH_DRAIN_EVENTS); }
+static void bench_event_fill() {
+	bench_event_drain();
+	for(uint32_t i = 0; i < BENCH_DRAIN_EVENTS; i++) bench_queue.push(i, INPUT_EDGE_RISING);
+}
+
+//records into timer channel 0's stats, which `run_all()` clears back out when it's done
+static void bench_isr_profiler() {
+	isr_profile_ctx_t ctx = ISR_Profiler::enter();
+	ISR_Profiler::exit(PROFILE_TIMER_CHAN_0, ctx);
+}
+
+//the Hard_PWM ISR costs scale with how many channels (and ports) it drives, so don't just time whatever the app mapped
+//every channel gets its own port table (the worst case), all of them pointing at the scratch output's BSRR
+//the timers are stopped, so the flags get raised through the event generation register before every run
+static uint8_t saved_active_mask[NUM_PWM_GROUPS];
+static uint8_t saved_phased_mask[NUM_PWM_GROUPS];
+static uint8_t saved_fall_pending_mask[NUM_PWM_GROUPS];
+static uint8_t saved_num_ports[NUM_PWM_GROUPS];
+static pwm_port_table_t saved_port_tables[NUM_PWM_GROUPS][PWM_CHANNELS_PER_GROUP];
+static uint32_t saved_dier[NUM_PWM_GROUPS];
+static uint32_t saved_cr1[NUM_PWM_GROUPS];
+
+void Benchmark::save_hard_pwm() {
+	for(uint8_t group = 0; group < NUM_PWM_GROUPS; group++) {
+		saved_active_mask[group] = Hard_PWM::active_mask[group];
+		saved_phased_mask[group] = Hard_PWM::phased_mask[group];
+		saved_fall_pending_mask[group] = Hard_PWM::fall_pending_mask[group];
+		saved_num_ports[group] = Hard_PWM::num_ports[group];
+		for(uint8_t i = 0; i < PWM_CHANNELS_PER_GROUP; i++)
+			saved_port_tables[group][i] = Hard_PWM::port_tables[group][i];
+		saved_dier[group] = Hard_PWM::group_timer(group)->DIER;
+		saved_cr1[group] = Hard_PWM::group_timer(group)->CR1;
+	}
+}
+
+//the PWM timers are already running by the time the benchmarks are, so put them back the way they were going
+//and drop the IRQs the benchmark flags left pending in the NVIC (interrupts are still masked, so none of them got taken)
+void Benchmark::restore_hard_pwm() {
+	for(uint8_t group = 0; group < NUM_PWM_GROUPS; group++) {
+		Hard_PWM::active_mask[group] = saved_active_mask[group];
+		Hard_PWM::phased_mask[group] = saved_phased_mask[group];
+		Hard_PWM::fall_pending_mask[group] = saved_fall_pending_mask[group];
+		Hard_PWM::num_ports[group] = saved_num_ports[group];
+		for(uint8_t i = 0; i < PWM_CHANNELS_PER_GROUP; i++)
+			Hard_PWM::port_tables[group][i] = saved_port_tables[group][i];
+		TIM_TypeDef *tim = Hard_PWM::group_timer(group);
+		tim->DIER = saved_dier[group];
+		tim->SR = 0;
+		HAL_NVIC_ClearPendingIRQ(Hard_PWM::group_irq(group));
+		tim->CR1 = saved_cr1[group];
+	}
+}
+
+//map the first `channels` channels of the group onto the scratch pin, then raise the update and all their compare flags
+//so the ISR takes the full path: every channel deasserts, with the assert words looked up alongside
+void Benchmark::load_hard_pwm(uint8_t group, uint8_t channels) {
+	volatile uint32_t *bsrr = &DIO::port_regs(bench_out.get_pin().port)->BSRR;
+	uint32_t set_bit = 1UL << bench_out.get_pin().pin;
+	uint32_t reset_bit = set_bit << 16;
+	for(uint8_t i = 0; i < channels; i++) {
+		pwm_port_table_t &table = Hard_PWM::port_tables[group][i];
+		table.bsrr = bsrr;
+		for(uint32_t set = 0; set < PWM_CHANNEL_SETS; set++) {
+			table.assert_word[set] = (set & (1 << i)) ? set_bit : 0;
+			table.deassert_word[set] = (set & (1 << i)) ? reset_bit : 0;
+		}
+	}
+	Hard_PWM::num_ports[group] = channels;
+
+	uint8_t mask = (1 << channels) - 1;
+	Hard_PWM::active_mask[group] = mask;
+	Hard_PWM::phased_mask[group] = 0;
+	Hard_PWM::fall_pending_mask[group] = 0;
+
+	//CC1IE-CC4IE and CC1G-CC4G both sit right above the update bit
+	TIM_TypeDef *tim = Hard_PWM::group_timer(group);
+	tim->CR1 &= ~(TIM_CR1_CEN);
+	tim->DIER = channels ? (TIM_DIER_UIE | ((uint32_t)mask << 1)) : 0;
+	tim->SR = 0;
+	if(channels) tim->EGR = TIM_EGR_UG | ((uint32_t)mask << 1);
+}
+
+//the synthetic channels don't have pins behind them, so don't let PendSV try to log their edges into the capture
+void Benchmark::drop_hard_pwm_edges() {
+#if GPIO_CAPTURE
+	for(uint8_t group = 0; group < NUM_PWM_GROUPS; group++)
+		Hard_PWM::capture_tail[group] = Hard_PWM::capture_head[group];
+#endif
+}
+
+void Benchmark::hard_pwm_1ch() {
+	Benchmark::load_hard_pwm(0, 1);
+	Benchmark::load_hard_pwm(1, 0);
+}
+
+void Benchmark::hard_pwm_4ch() {
+	Benchmark::load_hard_pwm(0, PWM_CHANNELS_PER_GROUP);
+	Benchmark::load_hard_pwm(1, 0);
+}
+
+void Benchmark::hard_pwm_8ch() {
+	Benchmark::load_hard_pwm(0, PWM_CHANNELS_PER_GROUP);
+	Benchmark::load_hard_pwm(1, PWM_CHANNELS_PER_GROUP);
+}
+
+void Benchmark::bench_hard_pwm_a() { Hard_PWM::isr_groupA(); }
+void Benchmark::bench_hard_pwm_ab() {
+	Hard_PWM::isr_groupA();
+	Hard_PWM::isr_groupB();
+}
+
+const benchmark_t Benchmark::benchmarks[] = {
+		{"dio_set", bench_dio_set, NULL},
+		{"dio_clear", bench_dio_clear, NULL},
+#if GPIO_CAPTURE
+		{"dio_set_captured", bench_dio_set, GPIO_Capture::start}, //less `dio_set` is what capture adds to every pin write
+#endif
+		{"soft_pwm_update_x8", bench_soft_pwm, NULL},
+		{"hard_pwm_isr_1ch", Benchmark::bench_hard_pwm_a, Benchmark::hard_pwm_1ch},
+		{"hard_pwm_isr_4ch", Benchmark::bench_hard_pwm_a, Benchmark::hard_pwm_4ch},
+		{"hard_pwm_isr_8ch", Benchmark::bench_hard_pwm_ab, Benchmark::hard_pwm_8ch},
+		{"debouncer_sample", bench_debounce, NULL},
+		{"port_debouncer_sample_x16", bench_port_debounce, NULL},
+		{"timer_isr_dispatch", bench_timer_dispatch, bench_deferred_drain},
+		{"timestamp_read", bench_timestamp, NULL},
+		{"timestamp_read32", bench_timestamp32, NULL},
+		{"deferred_queue", bench_deferred_queue, bench_deferred_drain},
+		{"deferred_queue_already_queued", bench_deferred_queue, bench_deferred_prequeue},
+		{"scheduler_post_to_run", bench_scheduler_post_run, bench_scheduler_add_task},
+		{"scheduler_dispatch", bench_scheduler_dispatch, bench_scheduler_prepost},
+		{"isr_profiler_enter_exit", bench_isr_profiler, NULL},
+		{"soft_timer_arm", bench_soft_timer_arm, bench_soft_timer_cancel},
+		{"soft_timer_cancel", bench_soft_timer_cancel, bench_soft_timer_arm},
+		{"input_event_push", bench_event_push, bench_event_drain},
+		{"input_event_drain_x8", bench_event_drain, bench_event_fill}
+};
+#define NUM_BENCHMARKS (sizeof(Benchmark::benchmarks) / sizeof(Benchmark::benchmarks[0]))
+
+const benchmark_t *Benchmark::get_benchmarks(uint32_t *count) {
+	*count = NUM_BENCHMARKS;
+	return Benchmark::benchmarks;
+}
+
+//============================== BENCHMARK RUNNER =================================
+
+void Benchmark::enable_counters() {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk | DWT_CTRL_CPIEVTENA_Msk | DWT_CTRL_EXCEVTENA_Msk |
+				 DWT_CTRL_SLEEPEVTENA_Msk | DWT_CTRL_LSUEVTENA_Msk | DWT_CTRL_FOLDEVTENA_Msk;
+}
+
+benchmark_result_t Benchmark::run(callback_function_t op, callback_function_t setup) {
+	uint32_t cycles_min = 0xFFFFFFFF;
+	uint64_t cycles_total = 0, instructions_total = 0;
+	bool instructions_valid = true;
+
+	for(uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		if(setup != NULL) setup();
+
+		uint32_t cpi = DWT->CPICNT, exc = DWT->EXCCNT, sleep = DWT->SLEEPCNT, lsu = DWT->LSUCNT, fold = DWT->FOLDCNT;
+		uint32_t start = DWT->CYCCNT;
+		op();
+		uint32_t cycles = DWT->CYCCNT - start;
+		cpi = (DWT->CPICNT - cpi) & EVENT_COUNTER_MAX;
+		exc = (DWT->EXCCNT - exc) & EVENT_COUNTER_MAX;
+		sleep = (DWT->SLEEPCNT - sleep) & EVENT_COUNTER_MAX;
+		lsu = (DWT->LSUCNT - lsu) & EVENT_COUNTER_MAX;
+		fold = (DWT->FOLDCNT - fold) & EVENT_COUNTER_MAX;
+
+		__set_PRIMASK(primask);
+
+		//every cycle is either an instruction, or a stall one of the counters picked up; folded instructions took no cycle at all
+		if(cycles > EVENT_COUNTER_MAX) instructions_valid = false;
+		instructions_total += cycles - cpi - exc - sleep - lsu + fold;
+		cycles_total += cycles;
+		if(cycles < cycles_min) cycles_min = cycles;
+	}
+
+	benchmark_result_t result;
+	result.cycles_min = cycles_min;
+	result.cycles_mean = (uint32_t)(cycles_total / BENCHMARK_ITERATIONS);
+	result.instructions = instructions_valid ? (int32_t)(instructions_total / BENCHMARK_ITERATIONS) : -1;
+	return result;
+}
+
+void Benchmark::run_all(UART_HandleTypeDef *huart) {
+	char line[DUMP_LINE_LENGTH];
+	int len;
+
+	//nothing else gets to run (or move the timers and tables) until we're done
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	Benchmark::enable_counters();
+	Benchmark::save_hard_pwm();
+
+	//this is what the measurement itself costs, take it out of everything else
+	benchmark_result_t overhead = Benchmark::run(bench_empty);
+
+	len = snprintf(line, DUMP_LINE_LENGTH, "{\"cpu_hz\":%lu,\"benchmarks\":[", (unsigned long)CPU_F_CLK);
+	HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+
+	for(uint32_t i = 0; i < NUM_BENCHMARKS; i++) {
+		benchmark_result_t result = Benchmark::run(benchmarks[i].op, benchmarks[i].setup);
+		Benchmark::drop_hard_pwm_edges();
+		uint32_t min = (result.cycles_min > overhead.cycles_min) ? result.cycles_min - overhead.cycles_min : 0;
+		uint32_t mean = (result.cycles_mean > overhead.cycles_mean) ? result.cycles_mean - overhead.cycles_mean : 0;
+
+		//ns to three decimal places (i.e. in ps), since printf doesn't do floats here
+		uint32_t ps_per_op = (uint32_t)((uint64_t)mean * 1000000000000ULL / CPU_F_CLK);
+		uint32_t ops_per_s = mean ? CPU_F_CLK / mean : 0;
+
+		len = snprintf(line, DUMP_LINE_LENGTH,
+				"%s{\"name\":\"%s\",\"iterations\":%lu,\"cycles_min\":%lu,\"cycles_mean\":%lu,"
+				"\"ns_per_op\":%lu.%03lu,\"ops_per_s\":%lu,\"instructions\":",
+				(i == 0) ? "" : ",", benchmarks[i].name, (unsigned long)BENCHMARK_ITERATIONS,
+				(unsigned long)min, (unsigned long)mean,
+				(unsigned long)(ps_per_op / 1000), (unsigned long)(ps_per_op % 1000), (unsigned long)ops_per_s);
+		if(result.instructions >= 0 && overhead.instructions >= 0) {
+			int32_t instructions = result.instructions - overhead.instructions;
+			len += snprintf(line + len, DUMP_LINE_LENGTH - len, "%ld}", (long)((instructions > 0) ? instructions : 0));
+		}
+		else len += snprintf(line + len, DUMP_LINE_LENGTH - len, "null}");
+		HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+	}
+
+	len = snprintf(line, DUMP_LINE_LENGTH, "]}\r\n");
+	HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+
+	Benchmark::restore_hard_pwm();
+	ISR_Profiler::clear(); //what the profiler benchmark recorded isn't a real ISR
+#if GPIO_CAPTURE
+	GPIO_Capture::stop(); //same for the capture, it's only got the scratch pin in it
+#endif
+	__set_PRIMASK(primask);
+}
+
+#endif
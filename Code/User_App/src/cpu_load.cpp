@@ -0,0 +1,173 @@
+/*
+ * cpu_load.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "cpu_load.h"
+#include "app_hal_timestamp.h"
+#include "app_hal_isr_profiler.h"
+#include "stdio.h"
+
+#define CPU_F_CLK 180000000UL //180MHz core clock
+#define DUMP_LINE_LENGTH 64
+#define DUMP_TIMEOUT_MS 100
+
+//======================= DEFINING CLASS VARIABLES ====================
+static uint32_t busy_10ms[1], total_10ms[1];
+static uint32_t busy_1s[CPU_LOAD_1S_SLOTS], total_1s[CPU_LOAD_1S_SLOTS];
+static uint32_t busy_10s[CPU_LOAD_10S_SLOTS], total_10s[CPU_LOAD_10S_SLOTS];
+
+Load_Window CPU_Load::window_10ms(busy_10ms, total_10ms, 1);
+Load_Window CPU_Load::window_1s(busy_1s, total_1s, CPU_LOAD_1S_SLOTS);
+Load_Window CPU_Load::window_10s(busy_10s, total_10s, CPU_LOAD_10S_SLOTS);
+
+volatile uint32_t CPU_Load::idle_ticks = 0;
+volatile uint32_t CPU_Load::blocked_ticks = 0;
+volatile uint32_t CPU_Load::blocked_since = 0;
+volatile bool CPU_Load::blocking = false;
+uint32_t CPU_Load::blocking_start = 0;
+uint32_t CPU_Load::task_blocked_ticks = 0;
+volatile uint32_t CPU_Load::task_ticks[SCHEDULER_MAX_TASKS] = {0};
+uint32_t CPU_Load::task_ticks_1s[SCHEDULER_MAX_TASKS] = {0};
+uint32_t CPU_Load::task_total_1s = 0;
+uint32_t CPU_Load::last_sample = 0;
+bool CPU_Load::started = false;
+
+void CPU_Load::add_idle(const uint32_t ticks) {
+	//interrupts are masked, so nothing can get between the load and the store
+	CPU_Load::idle_ticks += ticks;
+}
+
+void CPU_Load::add_task(const uint32_t priority, const uint32_t ticks) {
+	//whatever the task spent blocked doesn't count
+	uint32_t task_ticks = (ticks > CPU_Load::task_blocked_ticks) ? ticks - CPU_Load::task_blocked_ticks : 0;
+	CPU_Load::task_blocked_ticks = 0;
+	if(priority >= SCHEDULER_MAX_TASKS) return;
+
+	//the sampler zeroes this out from an ISR, so the add has to be atomic
+	uint32_t old_val;
+	do {
+		old_val = __LDREXW(&CPU_Load::task_ticks[priority]);
+	} while(__STREXW(old_val + task_ticks, &CPU_Load::task_ticks[priority]));
+}
+
+void CPU_Load::begin_blocking() {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint32_t now = Timestamp::now_ticks32();
+	CPU_Load::blocking_start = now;
+	CPU_Load::blocked_since = now;
+	CPU_Load::blocking = true;
+	__set_PRIMASK(primask);
+}
+
+//the sampler takes whatever piece of a long block fell in its sample as it goes, we just add the rest
+void CPU_Load::end_blocking() {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(CPU_Load::blocking) {
+		uint32_t now = Timestamp::now_ticks32();
+		CPU_Load::blocked_ticks += now - CPU_Load::blocked_since;
+		CPU_Load::task_blocked_ticks += now - CPU_Load::blocking_start;
+		CPU_Load::blocking = false;
+	}
+	__set_PRIMASK(primask);
+}
+
+void CPU_Load::sample() {
+	uint32_t now = Timestamp::now_ticks32();
+
+	//first call just sets the reference point
+	if(!CPU_Load::started) {
+		CPU_Load::last_sample = now;
+		CPU_Load::idle_ticks = 0;
+		CPU_Load::blocked_ticks = 0;
+		CPU_Load::blocked_since = now;
+		CPU_Load::started = true;
+		return;
+	}
+
+	uint32_t total = now - CPU_Load::last_sample;
+	CPU_Load::last_sample = now;
+
+	//main context only touches these with interrupts masked
+	uint32_t idle = CPU_Load::idle_ticks;
+	CPU_Load::idle_ticks = 0;
+	if(CPU_Load::blocking) {
+		CPU_Load::blocked_ticks += now - CPU_Load::blocked_since;
+		CPU_Load::blocked_since = now;
+	}
+	uint32_t blocked = CPU_Load::blocked_ticks;
+	CPU_Load::blocked_ticks = 0;
+
+	//blocked time comes out of the sample altogether, it's neither busy nor idle
+	total = (blocked < total) ? total - blocked : 0;
+	uint32_t busy = (idle < total) ? total - idle : 0;
+
+	CPU_Load::window_10ms.push(busy, total);
+	if(!CPU_Load::window_1s.push(busy, total)) return;
+
+	//a whole second went by--cascade it into the 10s window, and snapshot the per-task time
+	CPU_Load::window_10s.push((uint32_t)CPU_Load::window_1s.get_busy(), (uint32_t)CPU_Load::window_1s.get_total());
+	CPU_Load::task_total_1s = (uint32_t)CPU_Load::window_1s.get_total();
+	for(uint32_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+		uint32_t ticks;
+		do {
+			ticks = __LDREXW(&CPU_Load::task_ticks[i]);
+		} while(__STREXW(0, &CPU_Load::task_ticks[i]));
+		CPU_Load::task_ticks_1s[i] = ticks;
+	}
+}
+
+uint32_t CPU_Load::get_load_10ms() {
+	return CPU_Load::window_10ms.get_load_centipercent();
+}
+
+uint32_t CPU_Load::get_load_1s() {
+	return CPU_Load::window_1s.get_load_centipercent();
+}
+
+uint32_t CPU_Load::get_load_10s() {
+	return CPU_Load::window_10s.get_load_centipercent();
+}
+
+uint32_t CPU_Load::get_task_load(const uint32_t priority) {
+	if(priority >= SCHEDULER_MAX_TASKS) return 0;
+	if(CPU_Load::task_total_1s == 0) return 0;
+	return (uint32_t)(((uint64_t)CPU_Load::task_ticks_1s[priority] * 10000) / CPU_Load::task_total_1s);
+}
+
+uint32_t CPU_Load::max_event_rate(const uint32_t current_rate_hz, const uint32_t cycles_per_event) {
+	if(cycles_per_event == 0) return current_rate_hz;
+	uint32_t load = CPU_Load::get_load_1s();
+	if(load >= 10000) return current_rate_hz;
+
+	//every idle cycle could go to more events
+	uint64_t idle_cycles_per_sec = ((uint64_t)(10000 - load) * CPU_F_CLK) / 10000;
+	return current_rate_hz + (uint32_t)(idle_cycles_per_sec / cycles_per_event);
+}
+
+void CPU_Load::report(UART_HandleTypeDef *huart, const uint32_t step_rate_hz, const uint32_t cycles_per_step) {
+	char line[DUMP_LINE_LENGTH];
+	int len;
+
+	len = snprintf(line, DUMP_LINE_LENGTH, "cpu,%lu,%lu,%lu,%lu\r\n",
+			(unsigned long)CPU_Load::get_load_10ms(), (unsigned long)CPU_Load::get_load_1s(),
+			(unsigned long)CPU_Load::get_load_10s(), (unsigned long)CPU_Load::max_event_rate(step_rate_hz, cycles_per_step));
+	HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+
+	for(uint32_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+		if(CPU_Load::task_ticks_1s[i] == 0) continue;
+		len = snprintf(line, DUMP_LINE_LENGTH, "task,%lu,%lu\r\n", (unsigned long)i, (unsigned long)CPU_Load::get_task_load(i));
+		HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+	}
+
+#if ISR_PROFILING
+	for(uint32_t i = 0; i < NUM_PROFILED_ISRS; i++) {
+		len = snprintf(line, DUMP_LINE_LENGTH, "isr,%s,%lu\r\n", ISR_Profiler::get_name((isr_profile_id_t)i),
+				(unsigned long)ISR_Profiler::get_load_centipercent((isr_profile_id_t)i));
+		HAL_UART_Transmit(huart, (uint8_t*)line, len, DUMP_TIMEOUT_MS);
+	}
+#endif
+}
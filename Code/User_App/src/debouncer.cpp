@@ -6,52 +6,69 @@
  */
 
 #include "debouncer.h"
+#include "app_hal_trace.h"
+
+//======================= DEFINING CLASS VARIABLES ====================
+Timer *Debouncer::sample_timer = NULL;
+Debouncer *Debouncer::line_owners[NUM_EXTI_LINES] = {NULL};
+volatile uint32_t Debouncer::armed_lines = 0;
 
 Debouncer::Debouncer(const DIO &_pin, const uint32_t _bounce_time_ms, const bool _inverted):
 	PIN(_pin), BOUNCE_TIME(_bounce_time_ms), INVERTED(_inverted)
 {
+	flags = 0;
 	bounce_counter = 0;
+	integrating = false;
+	integrator = 0;
+	integrator_max = 0;
+	high_threshold = 0;
+	low_threshold = 0;
 }
 
 /*
- * NOTE: FOR ALL THESE GETTER METHODS, THERE IS TECHNICALLY POSSIBILITIES OF RACE CONDITIONS
- * specifically, when we are clearing the flags;
- * Severity is very low, as race condition will only exist when flag is asserted and a corresponding event happens
- * in between reading the flag and clearing the flag
- *
- * HOWEVER, this can be considered acceptable behavior, as the function returns the status of the flags
- * as of the exit cycle of the function (i.e. even if we see a rising edge between reading the flag and clearing it,
- * we return that we saw a rising edge as the function exits)
+ * All the getters that clear flags do an atomic fetch-and-clear with LDREX/STREX
+ * If `sample_and_update()` sets a flag between our load and store, the STREX fails and we retry,
+ * so an edge is either returned by this call or left set for the next one--never lost
+ * No interrupt masking needed
  */
 uint8_t Debouncer::get_rising_edge_db(bool clear_flag) {
-	bool retval = rising_db;
-	if(clear_flag && retval) //ANDing with `retval` prevents us from unnecessarily doing a register write
-		rising_db = false;
-	return retval;
+	if(!clear_flag) return (flags & DEBOUNCE_FLAG_RISING) != 0;
+	return fetch_and_clear(DEBOUNCE_FLAG_RISING);
 }
 
 uint8_t Debouncer::get_falling_edge_db(bool clear_flag) {
-	bool retval = falling_db;
-	if(clear_flag && retval) //ANDing with `retval` prevents us from unnecessarily doing a register write
-		falling_db = false;
-	return retval;
+	if(!clear_flag) return (flags & DEBOUNCE_FLAG_FALLING) != 0;
+	return fetch_and_clear(DEBOUNCE_FLAG_FALLING);
 }
 
 uint8_t Debouncer::get_change_db(bool clear_flag) {
-	bool retval = change_db;
-	if(clear_flag && retval) //ANDing with `retval` prevents us from unnecessarily doing a register write
-		change_db = false;
-	return retval;
+	if(!clear_flag) return (flags & DEBOUNCE_FLAG_CHANGE) != 0;
+	return fetch_and_clear(DEBOUNCE_FLAG_CHANGE);
 }
 
 uint8_t Debouncer::read_db() {
-	return state_db;
+	return (flags & DEBOUNCE_FLAG_STATE) != 0;
+}
+
+uint32_t Debouncer::get_flags_db(bool clear_edges) {
+	if(!clear_edges) return flags; //single load, consistent snapshot of everything
+
+	uint32_t old_flags;
+	do {
+		old_flags = __LDREXW(&flags);
+	} while(__STREXW(old_flags & DEBOUNCE_FLAG_STATE, &flags));
+	return old_flags;
 }
 
 //call this function from ISR context
-void Debouncer::sample_and_update() {
+void RAMFUNC Debouncer::sample_and_update() {
 	//read the input pin, invert if necessary
-	bool input = INVERTED ? !(PIN.read() > 0) : (PIN.read() > 0);
+	bool input = read_input();
+
+	if(integrating) {
+		update_integrator(input);
+		return;
+	}
 
 	//if we're bouncing, just chill for a little; don't update any internal state vars
 	if(bounce_counter > 0)
@@ -60,20 +77,196 @@ void Debouncer::sample_and_update() {
 	//if we aren't waiting for a debounce read
 	//check to see if the state changed
 	//then start a debounce cycle
-	else if(input != state_db)
+	else if(input != read_db())
 		bounce_counter = BOUNCE_TIME;
 
 	//check the bounce counter now
 	//checking it outside of the first 'bounce_counter > 0' conditional in case
 	//BOUNCE_TIME is set to 0 (we'd want to check it in the same cycle
 	//also check for state change so we don't constantly run this section when just sampling normally
-	if((bounce_counter == 0) && (input != state_db)) {
-		if(input) //input went high, rising edge
-			rising_db = true;
-		else  //input went low, falling edge
-			falling_db = true;
-
-		change_db = true; //record a debounce state change
-		state_db = input;
+	if((bounce_counter == 0) && (input != read_db()))
+		record_edge(input);
+}
+
+/*
+ * Integrating mode:
+ * a saturating counter runs from 0 to BOUNCE_TIME, counting up on every HIGH sample and down on every LOW sample
+ * the debounced state only goes HIGH once the count climbs to `high_threshold`, and only goes LOW once it drops to `low_threshold`
+ * so isolated noise spikes just nudge the count around instead of restarting a debounce cycle
+ * thresholds are in samples (i.e. ms at 1kHz); everything stays integer so there's no FPU work in the ISR
+ */
+void Debouncer::set_integrator_mode(const uint32_t _high_threshold, const uint32_t _low_threshold) {
+	//sanity check the thresholds--need a bit of hysteresis and they have to fit inside the integrator range
+	uint32_t max = (BOUNCE_TIME > 0) ? BOUNCE_TIME : 1;
+	if(_high_threshold > max) return;
+	if(_low_threshold >= _high_threshold) return;
+
+	//start the integrator on the rail matching the current state, so switching modes doesn't fake an edge
+	integrator = read_db() ? max : 0;
+	integrator_max = max;
+	high_threshold = _high_threshold;
+	low_threshold = _low_threshold;
+	integrating = true;
+}
+
+void Debouncer::set_counter_mode() {
+	bounce_counter = 0;
+	integrating = false;
+}
+
+void RAMFUNC __attribute__((optimize("O3"))) Debouncer::force_state(bool state) {
+	bounce_counter = 0;
+	integrator = state ? integrator_max : 0;
+
+	uint32_t old_flags;
+	do {
+		old_flags = __LDREXW(&flags);
+	} while(__STREXW(state ? (old_flags | DEBOUNCE_FLAG_STATE) : (old_flags & ~DEBOUNCE_FLAG_STATE), &flags));
+}
+
+void RAMFUNC __attribute__((optimize("O3"))) Debouncer::update_integrator(bool input) {
+	//saturate at both ends
+	if(input) {
+		if(integrator < integrator_max) integrator++;
+	}
+	else if(integrator > 0) integrator--;
+
+	bool state = read_db();
+	if(!state && (integrator >= high_threshold))
+		record_edge(true);
+	else if(state && (integrator <= low_threshold))
+		record_edge(false);
+}
+
+//whether the debouncer has nothing left to work through for the current input
+bool Debouncer::is_settled(bool input) {
+	if(integrating) return integrator == (input ? integrator_max : 0);
+	return (bounce_counter == 0) && (input == read_db());
+}
+
+//rising edge if the input went high, falling edge if it went low
+void RAMFUNC __attribute__((optimize("O3"))) Debouncer::record_edge(bool input) {
+	//record the edge, the debounce state change and the new state all in one atomic update
+	uint32_t set_flags = input ? (DEBOUNCE_FLAG_RISING | DEBOUNCE_FLAG_CHANGE | DEBOUNCE_FLAG_STATE) :
+								 (DEBOUNCE_FLAG_FALLING | DEBOUNCE_FLAG_CHANGE);
+	uint32_t old_flags;
+	do {
+		old_flags = __LDREXW(&flags);
+	} while(__STREXW((old_flags & ~DEBOUNCE_FLAG_STATE) | set_flags, &flags));
+
+	if(event_queue != NULL)
+		event_queue->push(pin_id, input ? INPUT_EDGE_RISING : INPUT_EDGE_FALLING);
+
+	//port enum values are 0x400 apart
+	TRACE(TRACE_DEBOUNCE_EDGE, (((uint32_t)PIN.get_pin().port >> 10) << 5) | (PIN.get_pin().pin << 1) | input);
+}
+
+//atomically clear the flag, returning whether it was set
+uint8_t Debouncer::fetch_and_clear(uint32_t flag_mask) {
+	uint32_t old_flags;
+	do {
+		old_flags = __LDREXW(&flags);
+		if(!(old_flags & flag_mask)) { //nothing to clear, don't bother with the store
+			__CLREX();
+			return 0;
+		}
+	} while(__STREXW(old_flags & ~flag_mask, &flags));
+	return 1;
+}
+
+void Debouncer::set_event_queue(Input_Event_Queue *_queue, uint8_t _pin_id) {
+	pin_id = _pin_id;
+	event_queue = _queue;
+}
+
+//================================== INTERRUPT MODE ===================================
+void Debouncer::configure_interrupt_sampling(Timer &_sample_timer) {
+	Debouncer::sample_timer = &_sample_timer;
+	Debouncer::sample_timer->set_callback_func(&Debouncer::sample_armed);
+
+	//only run the sampling interrupt when something is armed
+	Debouncer::sample_timer->disable_int();
+	Debouncer::sample_timer->enable_tim();
+}
+
+void Debouncer::enable_interrupt_mode(int_priority_t edge_priority) {
+	if(Debouncer::sample_timer == NULL) return; //need somewhere to sample from first
+
+	uint32_t line = PIN.get_pin().pin;
+	Debouncer::line_owners[line] = this;
+	Ext_Int::attach(PIN.get_pin(), EDGE_BOTH, edge_priority, &Debouncer::edge_isr);
+
+	//the input may not match our state right now, so take a look straight away
+	Debouncer::arm_line(line);
+}
+
+void Debouncer::disable_interrupt_mode() {
+	uint32_t line = PIN.get_pin().pin;
+	if(Debouncer::line_owners[line] != this) return;
+
+	Ext_Int::detach(line);
+
+	//stop sampling the line, then forget about it
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	Debouncer::armed_lines &= ~(1UL << line);
+	Debouncer::line_owners[line] = NULL;
+	__set_PRIMASK(primask);
+}
+
+bool RAMFUNC __attribute__((optimize("O3"))) Debouncer::read_input() {
+	return INVERTED ? !(PIN.read() > 0) : (PIN.read() > 0);
+}
+
+//an edge showed up on the line, stop listening to EXTI and start sampling
+void Debouncer::edge_isr(uint32_t line) {
+	Ext_Int::disable(line);
+	Debouncer::arm_line(line);
+}
+
+//sampling timer callback, only runs while at least one line is armed
+void Debouncer::sample_armed() {
+	uint32_t pending = Debouncer::armed_lines;
+
+	while(pending) {
+		uint32_t line = __CLZ(__RBIT(pending));
+		pending &= pending - 1;
+		Debouncer *db = Debouncer::line_owners[line];
+		if(db == NULL) continue;
+
+		db->sample_and_update();
+
+		//keep sampling until we're not mid-bounce and the input agrees with the debounced state
+		if(!db->is_settled(db->read_input())) continue;
+
+		//stable, go back to waiting on an edge
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		Debouncer::armed_lines &= ~(1UL << line);
+		__set_PRIMASK(primask);
+		Ext_Int::enable(line);
+
+		//an edge could have slipped in between our last sample and unmasking the line, catch it here
+		if(db->read_input() != db->read_db()) {
+			Ext_Int::disable(line);
+			Debouncer::arm_line(line);
+		}
 	}
+
+	//nothing left to sample, shut the sampling interrupt off
+	//check and disable with interrupts masked so an edge can't arm a line in between
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(Debouncer::armed_lines == 0) Debouncer::sample_timer->disable_int();
+	__set_PRIMASK(primask);
+}
+
+//start sampling a line on the shared timer
+void Debouncer::arm_line(uint32_t line) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	bool was_idle = (Debouncer::armed_lines == 0);
+	Debouncer::armed_lines |= 1UL << line;
+	if(was_idle) Debouncer::sample_timer->enable_int();
+	__set_PRIMASK(primask);
 }
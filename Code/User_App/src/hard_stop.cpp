@@ -0,0 +1,162 @@
+/*
+ * hard_stop.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "hard_stop.h"
+#include "app_hal_timestamp.h"
+#include "app_hal_trace.h"
+
+#define MODER_BITS_PER_PIN	2
+#define MODER_OUTPUT		1UL
+#define PUPDR_PULL_DOWN		2UL
+
+//======================= DEFINING CLASS VARIABLES ====================
+Hard_Stop *Hard_Stop::line_owners[NUM_EXTI_LINES] = {NULL};
+
+Hard_Stop::Hard_Stop(const DIO &_input, const bool _inverted, const uint32_t _rearm_bounce_time_ms):
+	tripped(false), latched_position(0), trip_time(0), trip_count(0), deasserted_samples(0),
+	step_timer(NULL), step_port(NULL), step_pin_num(0), position(NULL),
+	INPUT(_input), INVERTED(_inverted), REARM_SAMPLES(_rearm_bounce_time_ms > 0 ? _rearm_bounce_time_ms : 1),
+	rearm_debouncer(_input, _rearm_bounce_time_ms, _inverted)
+{}
+
+void Hard_Stop::attach_step_output(Timer &_step_timer, const DIO &_step_pin) {
+	step_timer = &_step_timer;
+	step_port = DIO::port_regs(_step_pin.get_pin().port);
+	step_pin_num = _step_pin.get_pin().pin;
+
+	//have the pin pull down whenever we take it off the output driver
+	//mask interrupts so a trip can't land between our read and write of the port
+	uint32_t shift = step_pin_num * MODER_BITS_PER_PIN;
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	step_port->PUPDR = (step_port->PUPDR & ~(3UL << shift)) | (PUPDR_PULL_DOWN << shift);
+
+	//if we've already tripped, this pin was never taken away--do it now
+	if(tripped) step_port->MODER &= ~(3UL << shift);
+	__set_PRIMASK(primask);
+}
+
+void Hard_Stop::attach_position(volatile int32_t *_position) {
+	position = _position;
+}
+
+void Hard_Stop::arm() {
+	uint32_t line = INPUT.get_pin().pin;
+	Hard_Stop::line_owners[line] = this;
+
+	//trip on the asserting edge only, as fast as the NVIC will let us
+	Ext_Int::attach(INPUT.get_pin(), INVERTED ? EDGE_FALLING : EDGE_RISING, Priorities::REALTIME, &Hard_Stop::trip_isr);
+
+	//if we're already asserted we'll never see the edge, so trip straight away
+	if(input_asserted()) trip();
+}
+
+bool Hard_Stop::rearm() {
+	if(!tripped) return true;
+
+	//the input has to have read deasserted (debounced and raw) for the whole re-arm time since the trip
+	if(deasserted_samples < REARM_SAMPLES) return false;
+	if(!release_step_pin()) return false;
+
+	//start listening again, and catch anything that happened while we were checking
+	Ext_Int::enable(INPUT.get_pin().pin);
+	if(input_asserted()) {
+		trip();
+		return false;
+	}
+	return true;
+}
+
+bool Hard_Stop::is_tripped() {
+	return tripped;
+}
+
+int32_t Hard_Stop::get_latched_position() {
+	return latched_position;
+}
+
+uint64_t Hard_Stop::get_trip_time() {
+	return trip_time;
+}
+
+void Hard_Stop::sample_and_update() {
+	uint32_t trips_seen = trip_count;
+	rearm_debouncer.sample_and_update();
+	bool deasserted = tripped && !rearm_debouncer.read_db() && !input_asserted();
+
+	//count up while the input stays deasserted, start over the moment it doesn't
+	//if a trip lands anywhere in here (it zeroes the count and breaks our reservation), this sample predates it--don't count it
+	uint32_t count;
+	do {
+		count = __LDREXW(&deasserted_samples);
+		if(trip_count != trips_seen) {
+			__CLREX();
+			return;
+		}
+		if(!deasserted) count = 0;
+		else if(count < REARM_SAMPLES) count++;
+	} while(__STREXW(count, &deasserted_samples));
+}
+
+//================================ TRIP HANDLING ===============================
+void RAMFUNC __attribute__((optimize("O3"))) Hard_Stop::trip_isr(uint32_t line) {
+	Hard_Stop *hs = Hard_Stop::line_owners[line];
+	if(hs != NULL) hs->trip();
+}
+
+void RAMFUNC __attribute__((optimize("O3"))) Hard_Stop::trip() {
+	//FIRST THING: take the step pin away from the output driver
+	//a step ISR we preempted can write BSRR all it wants once we return, the pin just stays pulled low
+	if(step_port != NULL) {
+		step_port->MODER &= ~(3UL << (step_pin_num * MODER_BITS_PER_PIN));
+	}
+
+	//then stop the step source entirely
+	if(step_timer != NULL) {
+		step_timer->disable_tim();
+		step_timer->disable_int();
+	}
+
+	//latch where we stopped, and when
+	if(position != NULL) latched_position = *position;
+	trip_time = Timestamp::now_ticks();
+	tripped = true;
+
+	//anything the re-arm logic saw before now doesn't count
+	trip_count++;
+	deasserted_samples = 0;
+	rearm_debouncer.force_state(true);
+	TRACE(TRACE_HARD_STOP_TRIP, (((uint32_t)INPUT.get_pin().port >> 10) << 4) | INPUT.get_pin().pin);
+
+	//we'll re-enable the line when we re-arm; no point taking more interrupts off a bouncing switch
+	Ext_Int::disable(INPUT.get_pin().pin);
+}
+
+//=============================== PRIVATE FUNCTION DEFS ==========================
+//clear the trip and hand the pin back to the output driver, all with interrupts masked
+//re-check everything inside the critical section, a trip could've come in since the caller looked
+bool Hard_Stop::release_step_pin() {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(!tripped || input_asserted()) {
+		__set_PRIMASK(primask);
+		return false;
+	}
+
+	if(step_port != NULL) {
+		//drive low first so we don't emit a step the moment the output driver comes back
+		step_port->BSRR = 1UL << (step_pin_num + 16);
+		uint32_t shift = step_pin_num * MODER_BITS_PER_PIN;
+		step_port->MODER = (step_port->MODER & ~(3UL << shift)) | (MODER_OUTPUT << shift);
+	}
+	tripped = false;
+	__set_PRIMASK(primask);
+	return true;
+}
+
+bool Hard_Stop::input_asserted() {
+	return INVERTED ? !(INPUT.read() > 0) : (INPUT.read() > 0);
+}
@@ -0,0 +1,95 @@
+/*
+ * input_events.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "input_events.h"
+#include "app_hal_timestamp.h"
+
+#define QUEUE_MASK (INPUT_EVENT_QUEUE_SIZE - 1)
+
+Input_Event_Queue::Input_Event_Queue() {
+	//slot N is ready to be written by the producer that claims position N
+	for(uint32_t i = 0; i < INPUT_EVENT_QUEUE_SIZE; i++)
+		slots[i].sequence = i;
+	enqueue_pos = 0;
+	dequeue_pos = 0;
+	dropped = 0;
+}
+
+//aggressively optimize here since this will be called from ISRs
+bool RAMFUNC __attribute__((optimize("O3"))) Input_Event_Queue::push(uint8_t pin_id, input_edge_t edge) {
+	uint64_t now;
+	uint32_t pos;
+	slot_t *slot;
+
+	//claim a slot
+	while(true) {
+		pos = __LDREXW(&enqueue_pos);
+		slot = &slots[pos & QUEUE_MASK];
+
+		//if the consumer hasn't freed this slot up yet, we're full
+		if((int32_t)(slot->sequence - pos) < 0) {
+			__CLREX();
+			uint32_t count;
+			do {
+				count = __LDREXW(&dropped);
+			} while(__STREXW(count + 1, &dropped));
+			return false;
+		}
+
+		//timestamp inside the claim, so anyone who preempts us gets both an earlier slot AND an earlier timestamp
+		//(their push breaks our reservation and we come back around for a fresh one--so does a wrap published by `now_ticks()`)
+		now = Timestamp::now_ticks();
+
+		//a failed STREX means another producer preempted us, go again
+		if(__STREXW(pos + 1, &enqueue_pos) == 0) break;
+	}
+
+	//fill the slot, then publish it
+	slot->event.timestamp = now;
+	slot->event.pin_id = pin_id;
+	slot->event.edge = (uint8_t)edge;
+	__DMB(); //make sure the event is written before the sequence says it's ready
+	slot->sequence = pos + 1;
+	return true;
+}
+
+bool Input_Event_Queue::pop(input_event_t &event) {
+	slot_t *slot = &slots[dequeue_pos & QUEUE_MASK];
+
+	//nothing published in the next slot yet
+	if(slot->sequence != dequeue_pos + 1) return false;
+
+	__DMB(); //don't read the event before we've seen the sequence
+	event = slot->event;
+	__DMB();
+
+	//hand the slot back to producers for one lap around the queue from now
+	slot->sequence = dequeue_pos + INPUT_EVENT_QUEUE_SIZE;
+	dequeue_pos++;
+	return true;
+}
+
+//pull out as many events as we can in one batch
+uint32_t Input_Event_Queue::drain(input_event_t events[], const uint32_t max_events) {
+	uint32_t count = 0;
+	while((count < max_events) && pop(events[count])) count++;
+	return count;
+}
+
+uint32_t Input_Event_Queue::get_dropped(bool clear) {
+	if(!clear) return dropped;
+
+	//producers count drops from ISRs, so clear with an atomic swap rather than a plain store
+	uint32_t retval;
+	do {
+		retval = __LDREXW(&dropped);
+		if(!retval) { //nothing to clear, don't bother with the store
+			__CLREX();
+			return 0;
+		}
+	} while(__STREXW(0, &dropped));
+	return retval;
+}
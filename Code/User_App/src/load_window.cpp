@@ -0,0 +1,58 @@
+/*
+ * load_window.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "load_window.h"
+
+Load_Window::Load_Window(uint32_t *_busy_slots, uint32_t *_total_slots, const uint32_t _num_slots):
+		busy_slots(_busy_slots), total_slots(_total_slots), NUM_SLOTS(_num_slots)
+{
+	clear();
+}
+
+bool Load_Window::push(const uint32_t busy, const uint32_t total) {
+	if(NUM_SLOTS == 0) return false;
+
+	//swap the oldest sample out of the running sums for the new one
+	if(filled == NUM_SLOTS) {
+		busy_sum -= busy_slots[index];
+		total_sum -= total_slots[index];
+	}
+	else filled++;
+
+	busy_slots[index] = busy;
+	total_slots[index] = total;
+	busy_sum += busy;
+	total_sum += total;
+
+	index++;
+	if(index < NUM_SLOTS) return false;
+	index = 0;
+	return true;
+}
+
+void Load_Window::clear() {
+	index = 0;
+	filled = 0;
+	busy_sum = 0;
+	total_sum = 0;
+}
+
+uint32_t Load_Window::get_load_centipercent() {
+	if(total_sum == 0) return 0;
+	return (uint32_t)((busy_sum * 10000) / total_sum);
+}
+
+uint64_t Load_Window::get_busy() {
+	return busy_sum;
+}
+
+uint64_t Load_Window::get_total() {
+	return total_sum;
+}
+
+bool Load_Window::is_full() {
+	return filled == NUM_SLOTS;
+}
@@ -0,0 +1,110 @@
+/*
+ * port_debouncer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "port_debouncer.h"
+
+#define VERTICAL_COUNTER_SAMPLES 4 //a 2-bit vertical counter rolls over after 4 samples
+
+PortDebouncer::PortDebouncer(const gpio_port_t _port, const uint16_t _pin_mask, const uint32_t _bounce_time_ms, const uint16_t _inverted_mask):
+	PORT(_port), PIN_MASK(_pin_mask), INVERTED_MASK(_inverted_mask),
+	SAMPLE_PERIOD((_bounce_time_ms + VERTICAL_COUNTER_SAMPLES - 1) / VERTICAL_COUNTER_SAMPLES) //round up so we never debounce for less than asked
+{
+	rising_db = 0;
+	falling_db = 0;
+	change_db = 0;
+	state_db = 0;
+	count_lo = 0;
+	count_hi = 0;
+	sample_countdown = 0;
+	event_queue = NULL;
+	first_pin_id = 0;
+}
+
+/*
+ * Getters that clear do an atomic fetch-and-clear with LDREXH/STREXH (same deal as `Debouncer`)
+ * so an edge landing mid-call is either returned now or left set for next time
+ */
+uint16_t PortDebouncer::get_rising_edges_db(bool clear_flags) {
+	if(!clear_flags) return rising_db;
+	return fetch_and_clear(&rising_db);
+}
+
+uint16_t PortDebouncer::get_falling_edges_db(bool clear_flags) {
+	if(!clear_flags) return falling_db;
+	return fetch_and_clear(&falling_db);
+}
+
+uint16_t PortDebouncer::get_changes_db(bool clear_flags) {
+	if(!clear_flags) return change_db;
+	return fetch_and_clear(&change_db);
+}
+
+uint16_t PortDebouncer::read_db() {
+	return state_db;
+}
+
+//call this function from ISR context
+void __attribute__((optimize("O3"))) PortDebouncer::sample_and_update() {
+	//only feed the counters every sample period
+	if(sample_countdown > 0) {
+		sample_countdown--;
+		return;
+	}
+	sample_countdown = SAMPLE_PERIOD > 0 ? SAMPLE_PERIOD - 1 : 0;
+
+	//read the whole port once, invert whatever needs inverting
+	uint16_t input = ((uint16_t)DIO::read_port(PORT) ^ INVERTED_MASK) & PIN_MASK;
+	uint16_t state = state_db;
+
+	//pins that disagree with their debounced state keep counting, everything else resets to 0
+	uint16_t delta = input ^ state;
+	count_hi = (count_hi ^ count_lo) & delta;
+	count_lo = ~count_lo & delta;
+
+	//pins whose counters just rolled over flip state
+	uint16_t toggle = delta & ~(count_hi | count_lo);
+	if(!toggle) return;
+
+	state ^= toggle;
+	state_db = state;
+	atomic_or(&rising_db, toggle & state);
+	atomic_or(&falling_db, toggle & ~state);
+	atomic_or(&change_db, toggle);
+
+	//queue up an event for every pin that flipped
+	if(event_queue == NULL) return;
+	while(toggle) {
+		uint32_t pin = __CLZ(__RBIT(toggle));
+		toggle &= toggle - 1;
+		event_queue->push(first_pin_id + pin, (state >> pin) & 1 ? INPUT_EDGE_RISING : INPUT_EDGE_FALLING);
+	}
+}
+
+void PortDebouncer::set_event_queue(Input_Event_Queue *_queue, uint8_t _first_pin_id) {
+	first_pin_id = _first_pin_id;
+	event_queue = _queue;
+}
+
+//=============================== PRIVATE FUNCTION DEFS ==========================
+uint16_t PortDebouncer::fetch_and_clear(volatile uint16_t *mask) {
+	uint16_t old_mask;
+	do {
+		old_mask = __LDREXH(mask);
+		if(!old_mask) { //nothing to clear, don't bother with the store
+			__CLREX();
+			return 0;
+		}
+	} while(__STREXH(0, mask));
+	return old_mask;
+}
+
+void PortDebouncer::atomic_or(volatile uint16_t *mask, uint16_t bits) {
+	if(!bits) return;
+	uint16_t old_mask;
+	do {
+		old_mask = __LDREXH(mask);
+	} while(__STREXH(old_mask | bits, mask));
+}
@@ -0,0 +1,131 @@
+/*
+ * priority_registry.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "priority_registry.h"
+
+#define CPU_F_CLK 180000000.0f //180MHz core clock
+#define ISR_OVERHEAD_CYCLES 24 //exception entry + exit stacking, charged to every ISR on top of its WCET
+
+//======================= DEFINING CLASS VARIABLES ====================
+uint32_t Priority_Registry::period_cycles[PRIORITY_REGISTRY_MAX_SOURCES] = {0};
+uint32_t Priority_Registry::deadline_cycles[PRIORITY_REGISTRY_MAX_SOURCES] = {0};
+uint32_t Priority_Registry::wcet_cycles[PRIORITY_REGISTRY_MAX_SOURCES] = {0};
+int_priority_t Priority_Registry::priorities[PRIORITY_REGISTRY_MAX_SOURCES];
+uint32_t Priority_Registry::responses[PRIORITY_REGISTRY_MAX_SOURCES] = {0};
+uint8_t Priority_Registry::num_sources = 0;
+uint32_t Priority_Registry::blocking_cycles = 0;
+
+isr_source_t Priority_Registry::add_source(const float rate_hz, const uint32_t wcet, const uint32_t deadline) {
+	if(Priority_Registry::num_sources >= PRIORITY_REGISTRY_MAX_SOURCES) return PRIORITY_REGISTRY_INVALID;
+	if(rate_hz <= 0) return PRIORITY_REGISTRY_INVALID;
+
+	uint32_t period = (uint32_t)(CPU_F_CLK / rate_hz);
+	if(period == 0) return PRIORITY_REGISTRY_INVALID;
+
+	isr_source_t source = Priority_Registry::num_sources++;
+	Priority_Registry::period_cycles[source] = period;
+	Priority_Registry::deadline_cycles[source] = (deadline == 0 || deadline > period) ? period : deadline;
+	Priority_Registry::wcet_cycles[source] = wcet + ISR_OVERHEAD_CYCLES;
+	Priority_Registry::priorities[source] = Priorities::LOW;
+	Priority_Registry::responses[source] = 0;
+	return source;
+}
+
+void Priority_Registry::set_blocking_cycles(const uint32_t cycles) {
+	Priority_Registry::blocking_cycles = cycles;
+}
+
+bool Priority_Registry::assign(const int_priority_t highest, const int_priority_t lowest) {
+	//sort the sources by deadline, shortest first (insertion sort, there's only a handful)
+	isr_source_t order[PRIORITY_REGISTRY_MAX_SOURCES];
+	for(isr_source_t i = 0; i < Priority_Registry::num_sources; i++) {
+		isr_source_t j = i;
+		while(j > 0 && Priority_Registry::deadline_cycles[order[j-1]] > Priority_Registry::deadline_cycles[i]) {
+			order[j] = order[j-1];
+			j--;
+		}
+		order[j] = i;
+	}
+
+	//walk down the levels, moving to the next one every time the deadline changes
+	uint32_t level = (uint32_t)highest;
+	for(isr_source_t i = 0; i < Priority_Registry::num_sources; i++) {
+		if(i > 0 && Priority_Registry::deadline_cycles[order[i]] != Priority_Registry::deadline_cycles[order[i-1]]
+				 && level < (uint32_t)lowest)
+			level++;
+		Priority_Registry::priorities[order[i]] = (int_priority_t)level;
+	}
+
+	//then check everyone can actually make their deadline
+	return Priority_Registry::check();
+}
+
+void Priority_Registry::set_wcet(const isr_source_t source, const uint32_t wcet) {
+	if(source >= Priority_Registry::num_sources) return;
+	Priority_Registry::wcet_cycles[source] = wcet + ISR_OVERHEAD_CYCLES;
+}
+
+bool Priority_Registry::check() {
+	bool schedulable = true;
+	for(isr_source_t i = 0; i < Priority_Registry::num_sources; i++) {
+		Priority_Registry::responses[i] = Priority_Registry::response_time(i);
+		if(Priority_Registry::responses[i] > Priority_Registry::deadline_cycles[i]) schedulable = false;
+	}
+	return schedulable;
+}
+
+int_priority_t Priority_Registry::get_priority(const isr_source_t source) {
+	if(source >= Priority_Registry::num_sources) return Priorities::LOW;
+	return Priority_Registry::priorities[source];
+}
+
+uint32_t Priority_Registry::get_response_cycles(const isr_source_t source) {
+	if(source >= Priority_Registry::num_sources) return 0;
+	return Priority_Registry::responses[source];
+}
+
+uint32_t Priority_Registry::get_wcet_cycles(const isr_source_t source) {
+	if(source >= Priority_Registry::num_sources) return 0;
+	return Priority_Registry::wcet_cycles[source];
+}
+
+uint32_t Priority_Registry::get_deadline_cycles(const isr_source_t source) {
+	if(source >= Priority_Registry::num_sources) return 0;
+	return Priority_Registry::deadline_cycles[source];
+}
+
+bool Priority_Registry::meets_deadline(const isr_source_t source) {
+	if(source >= Priority_Registry::num_sources) return false;
+	return Priority_Registry::responses[source] <= Priority_Registry::deadline_cycles[source];
+}
+
+void Priority_Registry::clear() {
+	Priority_Registry::num_sources = 0;
+	Priority_Registry::blocking_cycles = 0;
+}
+
+//================================== PRIVATE FUNCTIONS ===================================
+
+//iterate R = C + B + sum(ceil(R/Tj) * Cj) to a fixed point
+//R only ever grows, so bail as soon as it's past the deadline (returns the first value past it)
+uint32_t Priority_Registry::response_time(const isr_source_t source) {
+	uint64_t base = (uint64_t)Priority_Registry::wcet_cycles[source] + Priority_Registry::blocking_cycles;
+	uint64_t response = base;
+
+	while(response <= Priority_Registry::deadline_cycles[source]) {
+		uint64_t next = base;
+		for(isr_source_t j = 0; j < Priority_Registry::num_sources; j++) {
+			if(j == source) continue;
+			if(Priority_Registry::priorities[j] > Priority_Registry::priorities[source]) continue; //lower priority, can't get in our way
+			uint64_t period = Priority_Registry::period_cycles[j];
+			next += ((response + period - 1) / period) * Priority_Registry::wcet_cycles[j];
+		}
+		if(next == response) break;
+		response = next;
+	}
+
+	return (response > UINT32_MAX) ? UINT32_MAX : (uint32_t)response;
+}
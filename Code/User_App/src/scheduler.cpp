@@ -0,0 +1,77 @@
+/*
+ * scheduler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "scheduler.h"
+#include "cpu_load.h"
+#include "app_hal_timestamp.h"
+
+#define READY_BIT(priority) (0x80000000UL >> (priority)) //priority 0 in the MSB so CLZ returns the priority directly
+
+//======================= DEFINING CLASS VARIABLES ====================
+task_function_t Scheduler::tasks[SCHEDULER_MAX_TASKS] = {NULL};
+volatile uint32_t Scheduler::events[SCHEDULER_MAX_TASKS] = {0};
+volatile uint32_t Scheduler::ready = 0;
+
+bool Scheduler::add_task(const uint32_t priority, task_function_t func) {
+	if(priority >= SCHEDULER_MAX_TASKS) return false;
+	if(Scheduler::tasks[priority] != NULL) return false;
+	if(func == NULL) return false;
+
+	Scheduler::tasks[priority] = func;
+	return true;
+}
+
+void __attribute__((optimize("O3"))) Scheduler::post(const uint32_t priority, const uint32_t events) {
+	if(!events || (priority >= SCHEDULER_MAX_TASKS)) return;
+
+	//events first, then the ready bit, so the dispatcher never sees the task ready without its events
+	uint32_t old_val;
+	do {
+		old_val = __LDREXW(&Scheduler::events[priority]);
+	} while(__STREXW(old_val | events, &Scheduler::events[priority]));
+
+	do {
+		old_val = __LDREXW(&Scheduler::ready);
+	} while(__STREXW(old_val | READY_BIT(priority), &Scheduler::ready));
+}
+
+void __attribute__((optimize("O3"))) Scheduler::run_once() {
+	//check for work with interrupts masked so a post can't sneak in between the check and the WFI
+	//a pending interrupt still wakes WFI with PRIMASK set, and runs as soon as we unmask
+	//(put back whatever the caller had, so the benchmarks can time this with interrupts held off)
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(Scheduler::ready == 0) {
+		//everything between here and the wakeup counts as idle time
+		uint32_t sleep_start = Timestamp::now_ticks32();
+		__WFI();
+		CPU_Load::add_idle(Timestamp::now_ticks32() - sleep_start);
+		__set_PRIMASK(primask);
+		return;
+	}
+	__set_PRIMASK(primask);
+
+	//highest priority ready task
+	uint32_t priority = __CLZ(Scheduler::ready);
+
+	//clear the ready bit, then grab the events
+	//if something posts in between we'll see the ready bit again next time, possibly with no events left (which we skip)
+	uint32_t old_val;
+	do {
+		old_val = __LDREXW(&Scheduler::ready);
+	} while(__STREXW(old_val & ~READY_BIT(priority), &Scheduler::ready));
+
+	uint32_t task_events;
+	do {
+		task_events = __LDREXW(&Scheduler::events[priority]);
+	} while(__STREXW(0, &Scheduler::events[priority]));
+
+	if(task_events && Scheduler::tasks[priority] != NULL) {
+		uint32_t task_start = Timestamp::now_ticks32();
+		Scheduler::tasks[priority](task_events);
+		CPU_Load::add_task(priority, Timestamp::now_ticks32() - task_start);
+	}
+}
@@ -56,7 +56,7 @@ void Soft_PWM::force_deasserted() {
 
 //aggressively optimize here since this will likely be called from ISR
 //soft PWM frequency is frequency this function is called at divided by soft pwm resolution
-void __attribute__((optimize("O3"))) Soft_PWM::update() {
+void RAMFUNC __attribute__((optimize("O3"))) Soft_PWM::update() {
 	if(!Soft_PWM::__allow_updates__) return; //if our semaphore is set, don't run any PWM functions
 
 	//====================== manage the counter increment =======================
@@ -0,0 +1,158 @@
+/*
+ * soft_timer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "soft_timer.h"
+
+#define LEVEL_MASK (SOFT_TIMER_LEVEL_SLOTS - 1)
+
+//======================= DEFINING CLASS VARIABLES ====================
+uint32_t Soft_Timer::current_tick = 0;
+soft_timer_link_t Soft_Timer::wheel[SOFT_TIMER_NUM_LEVELS][SOFT_TIMER_LEVEL_SLOTS] = {}; //NULL `next` means the slot is empty
+
+/*
+ * NOTE ON ATOMICITY:
+ * list manipulations are only a handful of pointer writes, so rather than get clever with lock-free lists
+ * we just mask interrupts around them (saving PRIMASK so these can also be called from ISRs/callbacks)
+ * callbacks themselves always run with interrupts unmasked
+ */
+
+Soft_Timer::Soft_Timer(callback_function_t _cb): callback(_cb), expires(0), period(0) {
+	next = NULL;
+	prev = NULL; //NULL `prev` means we're not sitting in the wheel
+}
+
+//should never really be called, but writing this just in case
+Soft_Timer::~Soft_Timer() {
+	cancel();
+}
+
+void Soft_Timer::arm_oneshot(uint32_t delay_ticks) {
+	arm(delay_ticks, 0);
+}
+
+void Soft_Timer::arm_periodic(uint32_t period_ticks) {
+	//sanity check the period, clamp the same way as the delay
+	if(period_ticks == 0) period_ticks = 1;
+	if(period_ticks > SOFT_TIMER_MAX_TICKS) period_ticks = SOFT_TIMER_MAX_TICKS;
+	arm(period_ticks, period_ticks);
+}
+
+void Soft_Timer::cancel() {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(prev != NULL) unlink();
+	__set_PRIMASK(primask);
+}
+
+bool Soft_Timer::is_armed() {
+	return prev != NULL;
+}
+
+uint32_t Soft_Timer::get_ticks() {
+	return Soft_Timer::current_tick;
+}
+
+//aggressively optimize here since this will be called from a timer ISR
+void RAMFUNC __attribute__((optimize("O3"))) Soft_Timer::tick() {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	//when the bottom level wraps, pull the next group of timers down from the level above
+	//keep going up the levels as long as each one wraps too
+	uint32_t index = Soft_Timer::current_tick & LEVEL_MASK;
+	if(index == 0) {
+		for(uint32_t level = 1; level < SOFT_TIMER_NUM_LEVELS; level++) {
+			uint32_t level_index = (Soft_Timer::current_tick >> (SOFT_TIMER_LEVEL_BITS * level)) & LEVEL_MASK;
+			Soft_Timer::cascade(level, level_index);
+			if(level_index != 0) break;
+		}
+	}
+	Soft_Timer::current_tick++;
+
+	//move everything in the expiring slot onto a local list
+	//this way callbacks can freely arm/cancel timers (including ones still waiting on this list)
+	soft_timer_link_t expired;
+	expired.next = Soft_Timer::wheel[0][index].next;
+	expired.prev = NULL;
+	if(expired.next != NULL) expired.next->prev = &expired;
+	Soft_Timer::wheel[0][index].next = NULL;
+
+	while(expired.next != NULL) {
+		Soft_Timer *timer = static_cast<Soft_Timer*>(expired.next);
+		timer->unlink();
+
+		//re-arm periodic timers relative to when they should have expired, so they don't drift
+		if(timer->period != 0) {
+			timer->expires += timer->period;
+			timer->insert();
+		}
+
+		//run the callback with interrupts unmasked, then pick up where we left off
+		callback_function_t cb = timer->callback;
+		__set_PRIMASK(primask);
+		cb();
+		__disable_irq();
+	}
+
+	__set_PRIMASK(primask);
+}
+
+//=============================== PRIVATE FUNCTION DEFS ==========================
+void Soft_Timer::arm(uint32_t delay_ticks, uint32_t period_ticks) {
+	//sanity check the delay
+	if(delay_ticks == 0) delay_ticks = 1;
+	if(delay_ticks > SOFT_TIMER_MAX_TICKS) delay_ticks = SOFT_TIMER_MAX_TICKS;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(prev != NULL) unlink(); //re-arming just moves the timer
+
+	//`current_tick` is the next tick to be processed, so a delay of 1 expires on the very next `tick()`
+	period = period_ticks;
+	expires = Soft_Timer::current_tick + delay_ticks - 1;
+	insert();
+	__set_PRIMASK(primask);
+}
+
+//place the timer in the wheel based off of its expiry; call with interrupts masked
+void Soft_Timer::insert() {
+	uint32_t delta = expires - Soft_Timer::current_tick;
+
+	//if we're somehow already late, expire on the next tick
+	if((int32_t)delta < 0) {
+		expires = Soft_Timer::current_tick;
+		delta = 0;
+	}
+
+	//pick the lowest level whose span covers the delay, then index the slot by the expiry bits for that level
+	uint32_t level = 0;
+	while((level < SOFT_TIMER_NUM_LEVELS - 1) && (delta >> (SOFT_TIMER_LEVEL_BITS * (level + 1)))) level++;
+	soft_timer_link_t *head = &Soft_Timer::wheel[level][(expires >> (SOFT_TIMER_LEVEL_BITS * level)) & LEVEL_MASK];
+
+	//push onto the front of the slot
+	next = head->next;
+	prev = head;
+	if(next != NULL) next->prev = this;
+	head->next = this;
+}
+
+//remove the timer from whatever list it's sitting in; call with interrupts masked
+void Soft_Timer::unlink() {
+	prev->next = next;
+	if(next != NULL) next->prev = prev;
+	next = NULL;
+	prev = NULL;
+}
+
+//re-insert every timer in the given slot, which drops them down to the level below; call with interrupts masked
+void Soft_Timer::cascade(uint32_t level, uint32_t index) {
+	soft_timer_link_t *head = &Soft_Timer::wheel[level][index];
+	while(head->next != NULL) {
+		Soft_Timer *timer = static_cast<Soft_Timer*>(head->next);
+		timer->unlink();
+		timer->insert();
+	}
+}